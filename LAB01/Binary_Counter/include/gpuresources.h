@@ -0,0 +1,116 @@
+#ifndef _GPURESOURCES_H
+#define _GPURESOURCES_H
+
+// Registro central dos objetos OpenGL (buffers, VAOs, texturas, samplers e
+// programas de GPU) criados pelo programa. Veja "gpuresources.cpp".
+//
+// Todo objeto criado por GpuResources_Create() é contabilizado (quantidade
+// e bytes ocupados, por categoria) até ser liberado por
+// GpuResources_Release(). Buffers e VAOs liberados são guardados em um
+// "pool" e reutilizados pela próxima criação, evitando glGen*()/glDelete*()
+// a cada reconstrução. GpuResources_Shutdown() lista os objetos que nunca
+// foram liberados (vazamentos).
+//
+// Os tipos GpuBuffer, GpuVertexArray, GpuTexture, GpuSampler e
+// GpuProgramHandle abaixo liberam automaticamente o objeto quando destruídos
+// (RAII). Referências globais devem ser liberadas antes de
+// GpuResources_Shutdown(); liberações posteriores são ignoradas, já que o
+// contexto OpenGL pode não existir mais.
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+enum GpuResourceType
+{
+    GPU_BUFFER,
+    GPU_VERTEX_ARRAY,
+    GPU_TEXTURE,
+    GPU_SAMPLER,
+    GPU_PROGRAM,
+    GPU_NUM_RESOURCE_TYPES
+};
+
+// Estatísticas de uma categoria de objetos.
+struct GpuResourceStats
+{
+    size_t live;    // Objetos atualmente em uso
+    size_t bytes;   // Bytes ocupados pelos objetos em uso (veja GpuResources_SetSize())
+    size_t peak;    // Maior número de objetos em uso ao mesmo tempo
+    size_t created; // Total de criações (incluindo reutilizações)
+    size_t reused;  // Criações atendidas pelo pool
+    size_t pooled;  // Objetos liberados aguardando reutilização
+};
+
+// Cria (ou reutiliza do pool) um objeto do tipo "type". "label" identifica o
+// objeto no relatório de vazamentos, e deve ser uma string constante (ou
+// que exista até o objeto ser liberado). Um VAO reutilizado não possui
+// nenhum atributo habilitado; um buffer reutilizado não possui dados.
+GLuint GpuResources_Create(GpuResourceType type, const char* label);
+
+// Libera um objeto criado por GpuResources_Create(). Não faz nada se id == 0.
+void GpuResources_Release(GpuResourceType type, GLuint id);
+
+// Registra o número de bytes ocupados pelos dados de um objeto (ex.: após
+// glBufferData() ou glTexImage2D()).
+void GpuResources_SetSize(GpuResourceType type, GLuint id, size_t bytes);
+
+GpuResourceStats GpuResources_GetStats(GpuResourceType type);
+const char* GpuResources_TypeName(GpuResourceType type);
+
+// Função chamada sempre que um objeto é deletado de fato (e não guardado no
+// pool), por exemplo para que quem espelha o estado OpenGL saiba que o
+// objeto foi desligado. NULL desabilita.
+typedef void (*GpuResourceDeleteCallback)(GpuResourceType type, GLuint id);
+void GpuResources_SetDeleteCallback(GpuResourceDeleteCallback callback);
+
+// Imprime no terminal as estatísticas de cada categoria.
+void GpuResources_PrintStats();
+
+// Imprime os objetos ainda não liberados, retornando quantos são.
+int GpuResources_ReportLeaks();
+
+// Relata os vazamentos e deleta os objetos guardados nos pools. Deve ser
+// chamada com o contexto OpenGL ainda ativo (antes de glfwTerminate()).
+void GpuResources_Shutdown();
+
+// Referência única (RAII) a um objeto do registro: o objeto é liberado
+// quando a referência é destruída ou recebe outro objeto. Pode ser movida,
+// mas não copiada.
+template <GpuResourceType TYPE>
+struct GpuHandle
+{
+    GpuHandle() : id(0) {}
+    explicit GpuHandle(const char* label) : id(GpuResources_Create(TYPE, label)) {}
+    ~GpuHandle() { GpuResources_Release(TYPE, id); }
+
+    GpuHandle(GpuHandle&& other) noexcept : id(other.id) { other.id = 0; }
+    GpuHandle& operator=(GpuHandle&& other) noexcept
+    {
+        if ( this != &other )
+        {
+            GpuResources_Release(TYPE, id);
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+
+    GpuHandle(const GpuHandle&) = delete;
+    GpuHandle& operator=(const GpuHandle&) = delete;
+
+    // Libera o objeto atual e cria um novo.
+    void Create(const char* label) { GpuResources_Release(TYPE, id); id = GpuResources_Create(TYPE, label); }
+    void Reset() { GpuResources_Release(TYPE, id); id = 0; }
+    void SetSize(size_t bytes) { GpuResources_SetSize(TYPE, id, bytes); }
+
+    GLuint id;
+};
+
+typedef GpuHandle<GPU_BUFFER>       GpuBuffer;
+typedef GpuHandle<GPU_VERTEX_ARRAY> GpuVertexArray;
+typedef GpuHandle<GPU_TEXTURE>      GpuTexture;
+typedef GpuHandle<GPU_SAMPLER>      GpuSampler;
+typedef GpuHandle<GPU_PROGRAM>      GpuProgramHandle;
+
+#endif // _GPURESOURCES_H
@@ -31,20 +31,45 @@
 
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
+#include "gpuresources.h"
+#include "meshindices.h"
 
 // Estruturas relevantes para o programa
+
+// Geometria dos glifos dos dígitos 0 e 1, montada na CPU antes de ser
+// enviada à GPU. Os dois glifos ficam nos mesmos buffers; "glyphs" indica a
+// qual glifo cada vértice pertence (0.0 ou 1.0).
+typedef struct {
+    std::vector<GLfloat> coordinates;
+    std::vector<GLfloat> colors;
+    std::vector<GLfloat> glyphs;
+    std::vector<GLuint> topology;
+} GlyphMesh;
+
+// Mostrador do contador binário. A geometria dos glifos é construída uma
+// única vez (BuildDigitDisplay()), e cada dígito do contador é uma instância
+// desta geometria: o único dado por instância é o glifo do dígito (0 ou 1),
+// e a posição do dígito vem de gl_InstanceID. Todos os dígitos são desenhados
+// com uma única chamada instanciada. Veja "shader_vertex.glsl".
 typedef struct {
-    GLuint VAOid;
-    GLuint size;
-    GLenum draw_mode;
-} VAOParams;
+    GpuVertexArray vertex_array;
+    GpuBuffer NDC_coefficients;
+    GpuBuffer color_coefficients;
+    GpuBuffer glyph_coefficients;
+    GpuBuffer indices;
+    GpuBuffer instance_glyphs;  // Um GLubyte por dígito (bit do contador)
+    MeshIndexRange indices_range; // Índices de uma instância (veja "meshindices.h")
+    GLuint num_digits;
+} DigitDisplay;
 
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
-std::vector<VAOParams> BuildScene(GLuint count);
-std::vector<GLubyte> DecimalToBinary(GLuint decimal_number, GLuint range);
-GLuint BuildZero(GLuint vertex_array_object_id, std::vector<GLfloat> NDC_center, GLuint external_points_count);
-GLuint BuildOne(GLuint vertex_array_object_id, std::vector<GLfloat> NDC_center);
+void BuildDigitDisplay(DigitDisplay& display, GLuint num_digits);
+void UpdateDigitDisplay(DigitDisplay& display, const std::vector<GLubyte>& counter, GLuint num_changed);
+void DrawDigitDisplay(const DigitDisplay& display);
+GLuint IncrementBinaryCounter(std::vector<GLubyte>& counter);
+void BuildZero(GlyphMesh& mesh, std::vector<GLfloat> NDC_center, GLuint external_points_count);
+void BuildOne(GlyphMesh& mesh, std::vector<GLfloat> NDC_center);
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
@@ -59,9 +84,24 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
 
 // Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
 GLuint g_GpuProgramID = 0;
+GLint g_digit_layout_uniform = -1; // "uniform vec3 digit_layout" em "shader_vertex.glsl"
 
-int main()
+int main(int argc, char* argv[])
 {
+    // O número de dígitos (bits) do contador pode ser passado como argumento
+    // na linha de comando. Ex.: "./main 256".
+    GLuint num_digits = 4;
+    if (argc > 1)
+    {
+        int value = atoi(argv[1]);
+        if (value < 1 || value > 4096)
+        {
+            fprintf(stderr, "ERROR: Invalid number of digits \"%s\" (expected 1 to 4096).\n", argv[1]);
+            std::exit(EXIT_FAILURE);
+        }
+        num_digits = (GLuint)value;
+    }
+
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
     // sistema operacional, onde poderemos renderizar com OpenGL.
     int success = glfwInit();
@@ -129,19 +169,22 @@ int main()
     // Medimos o tempo de execução inicial da aplicação
     GLuint t0 = (GLuint)glfwGetTime();
 
+    // Construímos a geometria dos dígitos uma única vez. O contador é um
+    // vetor de bits (little endian), de modo que pode ter qualquer tamanho.
+    std::vector<GLubyte> counter(num_digits, 0);
+    DigitDisplay display;
+    BuildDigitDisplay(display, num_digits);
+
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
-    GLuint counter = 0;
-    std::vector<VAOParams> vao_params = BuildScene(counter);
     while (!glfwWindowShouldClose(window))
     {
-        // Calcula se houve mudança de tempo entre cada loop
+        // Calcula se houve mudança de tempo entre cada loop. A cada segundo
+        // incrementamos o contador e enviamos à GPU somente os dígitos que
+        // mudaram (em média, dois por incremento).
         GLuint t1 = (GLuint)glfwGetTime();
         if(t1 - t0 >= 1){
-            counter++;
-            if(counter > 15){
-                counter = 0;
-            }
-            vao_params = BuildScene(counter);
+            GLuint num_changed = IncrementBinaryCounter(counter);
+            UpdateDigitDisplay(display, counter, num_changed);
             t0 = t1;
         }
 
@@ -157,13 +200,8 @@ int main()
         // os shaders de vértice e fragmentos)
         glUseProgram(g_GpuProgramID);
 
-        // Pedimos para a GPU rasterizar os vértices apontados pelo VAO como
-        // triângulos
-        for(VAOParams i : vao_params){
-            glBindVertexArray(i.VAOid);
-            glDrawElements(i.draw_mode, i.size, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
-        }
+        // Pedimos para a GPU rasterizar todos os dígitos do contador
+        DrawDigitDisplay(display);
 
         glfwSwapBuffers(window);
 
@@ -172,6 +210,12 @@ int main()
         glfwPollEvents();
     }
 
+    // Liberamos os objetos OpenGL, relatando os que não foram liberados
+    display = DigitDisplay();
+    GpuResources_Release(GPU_PROGRAM, g_GpuProgramID);
+    GpuResources_PrintStats();
+    GpuResources_Shutdown();
+
     // Finalizamos o uso dos recursos do sistema operacional
     glfwTerminate();
 
@@ -179,91 +223,134 @@ int main()
     return 0;
 }
 
-// Montar os triângulos para um respectivo valor de contagem
-std::vector<VAOParams> BuildScene(GLuint count){
-    // Definir dados vetoriais
-    std::vector<VAOParams> params;
-
-    // Definir tamanhos e posições básicas dos dígitos
+// Montar a geometria dos dígitos 0 e 1 e o buffer de instâncias do mostrador
+void BuildDigitDisplay(DigitDisplay& display, GLuint num_digits){
+    // Definir tamanhos básicos dos dígitos. Os glifos são construídos
+    // centrados na origem; "shader_vertex.glsl" posiciona cada instância.
     GLuint zero_external_points = 16;
-    GLfloat center_step = 0.5f;
-    GLfloat x_first_center = 0.75f;
-    std::vector<GLfloat> NDC_center = {x_first_center, 0.0f, 0.0f, 1.0f};
-
-    // Alocar as coordenadas dos pontos
-    std::vector<GLfloat> NDC_coefficients;
-
-    // Alocar as cores dos pontos
-    std::vector<GLfloat> color_coefficients;
-
-    // Alocar o vetor de índices
-    std::vector<GLuint> indices;
-
-    // Converter decimal para binário (little endian)
-    std::vector<GLubyte> binary_count = DecimalToBinary(count, 4);
-
-    // Construir os triângulos de acordo com os valores binários
-    GLuint vertex_array_object_id;
-    GLuint size;
-    GLenum draw_mode;
-    for(GLuint i : binary_count){
-
-        // Atualizar estruturas do VAO
-        glGenVertexArrays(1, &vertex_array_object_id);
-        glBindVertexArray(vertex_array_object_id);
-
-        // Construir triângulos de acordo com o dígito correto
-        if(i == 0){
-            draw_mode = GL_TRIANGLE_STRIP;
-            size = BuildZero(vertex_array_object_id, NDC_center, zero_external_points);
-        }else{
-            draw_mode = GL_TRIANGLES;
-            size = BuildOne(vertex_array_object_id, NDC_center);
-        }
-        // Armazenar os parâmetros da VAO
-        params.push_back({vertex_array_object_id, size, draw_mode});
+    std::vector<GLfloat> NDC_center = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    GlyphMesh mesh;
+    BuildZero(mesh, NDC_center, zero_external_points);
+    BuildOne(mesh, NDC_center);
+
+    display.num_digits = num_digits;
+
+    display.vertex_array.Create("DigitDisplay VAO");
+    glBindVertexArray(display.vertex_array.id);
+
+    // Construir os VBOs para a posição geométrica
 
-        // Atualizar o centro do próximo dígito
-        NDC_center[0] -= center_step;
+    display.NDC_coefficients.Create("DigitDisplay NDC_coefficients");
+    glBindBuffer(GL_ARRAY_BUFFER, display.NDC_coefficients.id);
+    glBufferData(GL_ARRAY_BUFFER, mesh.coordinates.size() * sizeof(GLfloat), mesh.coordinates.data(), GL_STATIC_DRAW);
+    display.NDC_coefficients.SetSize(mesh.coordinates.size() * sizeof(GLfloat));
+    GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
+    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(location);
+
+    // Construir os VBOs para as informações de cores
 
-        // Bloquear o VAO
-        glBindVertexArray(0);
+    display.color_coefficients.Create("DigitDisplay color_coefficients");
+    glBindBuffer(GL_ARRAY_BUFFER, display.color_coefficients.id);
+    glBufferData(GL_ARRAY_BUFFER, mesh.colors.size() * sizeof(GLfloat), mesh.colors.data(), GL_STATIC_DRAW);
+    display.color_coefficients.SetSize(mesh.colors.size() * sizeof(GLfloat));
+    location = 1; // "(location = 1)" em "shader_vertex.glsl"
+    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(location);
+
+    // Construir o VBO com o glifo de cada vértice
+
+    display.glyph_coefficients.Create("DigitDisplay glyph_coefficients");
+    glBindBuffer(GL_ARRAY_BUFFER, display.glyph_coefficients.id);
+    glBufferData(GL_ARRAY_BUFFER, mesh.glyphs.size() * sizeof(GLfloat), mesh.glyphs.data(), GL_STATIC_DRAW);
+    display.glyph_coefficients.SetSize(mesh.glyphs.size() * sizeof(GLfloat));
+    location = 2; // "(location = 2)" em "shader_vertex.glsl"
+    glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(location);
+
+    // Construir o VBO de instâncias: um byte por dígito, avançando uma vez
+    // por instância (e não por vértice) graças a glVertexAttribDivisor().
+    // Todos os dígitos começam em zero.
+
+    std::vector<GLubyte> zeros(num_digits, 0);
+    display.instance_glyphs.Create("DigitDisplay instance_glyphs");
+    glBindBuffer(GL_ARRAY_BUFFER, display.instance_glyphs.id);
+    glBufferData(GL_ARRAY_BUFFER, zeros.size() * sizeof(GLubyte), zeros.data(), GL_DYNAMIC_DRAW);
+    display.instance_glyphs.SetSize(zeros.size() * sizeof(GLubyte));
+    location = 3; // "(location = 3)" em "shader_vertex.glsl"
+    glVertexAttribPointer(location, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, 0);
+    glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(location);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Construir o VBO para a topologia. Os dois glifos somam poucos
+    // vértices, então os índices cabem em GL_UNSIGNED_BYTE.
+
+    MeshIndexData index_data;
+    display.indices_range = MeshIndices_Append(index_data, mesh.topology.data(), mesh.topology.size());
+    display.indices.Create("DigitDisplay indices");
+    MeshIndices_Upload(index_data, display.indices.id);
+    display.indices.SetSize(index_data.bytes.size());
+
+    // Bloquear o VAO
+    glBindVertexArray(0);
+}
+
+// Enviar à GPU os "num_changed" primeiros dígitos do contador. Os demais não
+// mudaram desde a última atualização.
+void UpdateDigitDisplay(DigitDisplay& display, const std::vector<GLubyte>& counter, GLuint num_changed){
+    if(num_changed == 0){
+        return;
     }
 
-    return params;
+    glBindBuffer(GL_ARRAY_BUFFER, display.instance_glyphs.id);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, num_changed * sizeof(GLubyte), counter.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-// Converter decimal para um vetor binário (little endian)
-std::vector<GLubyte> DecimalToBinary(GLuint decimal_number, GLuint range){
-    std::vector<GLubyte> binary;
+// Desenhar todos os dígitos com uma única chamada instanciada
+void DrawDigitDisplay(const DigitDisplay& display){
+    // Distribuir os dígitos horizontalmente: com até quatro dígitos, os
+    // centros ficam a 0.5 de distância (0.75, 0.25, -0.25, -0.75); com mais
+    // dígitos, o espaçamento e a largura dos glifos diminuem para que todos
+    // caibam na janela. O dígito menos significativo fica à direita.
+    GLfloat center_step = fminf(0.5f, 2.0f / display.num_digits);
+    GLfloat x_first_center = 0.5f * center_step * (display.num_digits - 1);
+    GLfloat x_scale = center_step / 0.5f;
+    glUniform3f(g_digit_layout_uniform, x_first_center, center_step, x_scale);
+
+    glBindVertexArray(display.vertex_array.id);
+    MeshIndices_DrawInstanced(GL_TRIANGLES, display.indices_range, display.num_digits);
+    glBindVertexArray(0);
+}
 
-    for(GLuint i = 0; i < range; i++){
-        binary.push_back(GLubyte(decimal_number % 2));
-        decimal_number = decimal_number / 2;
+// Incrementar o contador binário (little endian), retornando quantos bits,
+// a partir do menos significativo, mudaram. Quando todos os bits são 1, o
+// contador volta a zero.
+GLuint IncrementBinaryCounter(std::vector<GLubyte>& counter){
+    GLuint i = 0;
+    while(i < counter.size() && counter[i] == 1){
+        counter[i] = 0;
+        i++;
     }
-
-    return binary;
+    if(i < counter.size()){
+        counter[i] = 1;
+        i++;
+    }
+    return i;
 }
 
-// Gerar pontos, cores e topologia do dígito zero
-GLuint BuildZero(GLuint vertex_array_object_id, std::vector<GLfloat> NDC_center, GLuint external_points_count){
-    // Definir informações dos vetores
-    GLuint point_coords = 4;
-    GLuint color_coding = 4;
-    
+// Gerar pontos, cores e topologia do dígito zero, adicionando-os a "mesh"
+void BuildZero(GlyphMesh& mesh, std::vector<GLfloat> NDC_center, GLuint external_points_count){
     // Definir tamanhos básicos do dígito
     GLfloat x_minor_focus = 0.1f;
     GLfloat x_major_focus = 0.2f;
     GLfloat y_minor_focus = 0.6f;
     GLfloat y_major_focus = 0.7f;
 
-    // Definir estruturas de VBOs
-    std::vector<GLfloat> coordinates;
-    std::vector<GLfloat> colors;
-    std::vector<GLuint> topology;
-    GLuint VBO_NDC_coefficients_id;
-    GLuint VBO_color_coefficients_id;
-    GLuint indices_id;
+    // Índice do primeiro vértice deste glifo dentro de "mesh"
+    GLuint first_vertex = (GLuint)mesh.glyphs.size();
 
     // Definir coordenadas dos pontos
     GLfloat step = 2.0f * M_PI / external_points_count;
@@ -272,157 +359,91 @@ GLuint BuildZero(GLuint vertex_array_object_id, std::vector<GLfloat> NDC_center,
         angle = step*i;
 
         // Calcular os pontos internos
-        coordinates.push_back(x_minor_focus * cosf(angle) + NDC_center[0]);
-        coordinates.push_back(y_minor_focus * sinf(angle) + NDC_center[1]);
-        coordinates.push_back(0.0f);
-        coordinates.push_back(1.0f);
+        mesh.coordinates.push_back(x_minor_focus * cosf(angle) + NDC_center[0]);
+        mesh.coordinates.push_back(y_minor_focus * sinf(angle) + NDC_center[1]);
+        mesh.coordinates.push_back(0.0f);
+        mesh.coordinates.push_back(1.0f);
 
         // Calcular os pontos externos
-        coordinates.push_back(x_major_focus * cosf(angle) + NDC_center[0]);
-        coordinates.push_back(y_major_focus * sinf(angle) + NDC_center[1]);
-        coordinates.push_back(0.0f);
-        coordinates.push_back(1.0f);
-
-        // Definir a cor vermelha para o dígito zero e os índices
-        colors.push_back(1.0f);
-        colors.push_back(0.0f);
-        colors.push_back(0.0f);
-        colors.push_back(1.0f);
-
-        colors.push_back(1.0f);
-        colors.push_back(0.0f);
-        colors.push_back(0.0f);
-        colors.push_back(1.0f);
-
-        topology.push_back(GLubyte(2 * i));
-        topology.push_back(GLubyte(2 * i + 1));
-    }
-    topology.push_back(0);
-    topology.push_back(1);
-
-    // Construir os VBOs para a posição geométrica
-
-    glGenBuffers(1, &VBO_NDC_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_NDC_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, coordinates.size() * sizeof(GLfloat), coordinates.data(), GL_STATIC_DRAW);
-    GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
-    glVertexAttribPointer(location, point_coords, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // Construir os VBOs para as informações de cores
-
-    glGenBuffers(1, &VBO_color_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_color_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GLfloat), colors.data(), GL_STATIC_DRAW);
-    location = 1; // "(location = 1)" em "shader_vertex.glsl"
-    glVertexAttribPointer(location, color_coding, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // Construir o VBO para a topologia
-
-    glGenBuffers(1, &indices_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, topology.size() * sizeof(GLuint), topology.data(), GL_STATIC_DRAW);
+        mesh.coordinates.push_back(x_major_focus * cosf(angle) + NDC_center[0]);
+        mesh.coordinates.push_back(y_major_focus * sinf(angle) + NDC_center[1]);
+        mesh.coordinates.push_back(0.0f);
+        mesh.coordinates.push_back(1.0f);
+
+        // Definir a cor vermelha para o dígito zero
+        for(GLuint j = 0; j < 2; j++){
+            mesh.colors.push_back(1.0f);
+            mesh.colors.push_back(0.0f);
+            mesh.colors.push_back(0.0f);
+            mesh.colors.push_back(1.0f);
+            mesh.glyphs.push_back(0.0f);
+        }
 
-    GLuint size = 2 * external_points_count + 2;
-    return size;
+        // Gerar o anel como dois triângulos por segmento (o equivalente ao
+        // GL_TRIANGLE_STRIP 0, 1, 2, 3, ..., 0, 1), já que os dois glifos
+        // são desenhados juntos com GL_TRIANGLES.
+        GLuint inner = first_vertex + 2 * i;
+        GLuint next_inner = first_vertex + 2 * ((i + 1) % external_points_count);
+        mesh.topology.push_back(inner);
+        mesh.topology.push_back(inner + 1);
+        mesh.topology.push_back(next_inner);
+        mesh.topology.push_back(inner + 1);
+        mesh.topology.push_back(next_inner + 1);
+        mesh.topology.push_back(next_inner);
+    }
 }
 
-// Gerar pontos, cores e topologia do dígito um
-GLuint BuildOne(GLuint vertex_array_object_id, std::vector<GLfloat> NDC_center){
-    // Definir informações dos vetores
-    GLuint point_coords = 4;
-    GLuint color_coding = 4;
-
+// Gerar pontos, cores e topologia do dígito um, adicionando-os a "mesh"
+void BuildOne(GlyphMesh& mesh, std::vector<GLfloat> NDC_center){
     // Definir tamanhos básicos do dígito
     GLfloat half_base = 0.05f;
     GLfloat half_height = 0.7f;
     GLfloat point_x = -0.1f + NDC_center[0];
     GLfloat point_y = 0.408f + NDC_center[1];
-    
-    // Definir estruturas de VBOs
-    std::vector<GLfloat> coordinates;
-    std::vector<GLfloat> colors;
-    std::vector<GLuint> topology;
-    GLuint VBO_NDC_coefficients_id;
-    GLuint VBO_color_coefficients_id;
-    GLuint indices_id;
+
+    // Índice do primeiro vértice deste glifo dentro de "mesh"
+    GLuint first_vertex = (GLuint)mesh.glyphs.size();
 
     // Definir coordenadas dos pontos
-    coordinates.push_back(NDC_center[0] - half_base);
-    coordinates.push_back(NDC_center[1] - half_height + 0.008f);
-    coordinates.push_back(0.0f);
-    coordinates.push_back(1.0f);
-
-    coordinates.push_back(NDC_center[0] + half_base);
-    coordinates.push_back(NDC_center[1] - half_height + 0.008f);
-    coordinates.push_back(0.0f);
-    coordinates.push_back(1.0f);
-
-    coordinates.push_back(NDC_center[0] - half_base);
-    coordinates.push_back(NDC_center[1] + half_height + 0.008f);
-    coordinates.push_back(0.0f);
-    coordinates.push_back(1.0f);
-
-    coordinates.push_back(NDC_center[0] + half_base);
-    coordinates.push_back(NDC_center[1] + half_height + 0.008f);
-    coordinates.push_back(0.0f);
-    coordinates.push_back(1.0f);
-
-    coordinates.push_back(point_x);
-    coordinates.push_back(point_y);
-    coordinates.push_back(0.0f);
-    coordinates.push_back(1.0f);
+    mesh.coordinates.push_back(NDC_center[0] - half_base);
+    mesh.coordinates.push_back(NDC_center[1] - half_height + 0.008f);
+    mesh.coordinates.push_back(0.0f);
+    mesh.coordinates.push_back(1.0f);
+
+    mesh.coordinates.push_back(NDC_center[0] + half_base);
+    mesh.coordinates.push_back(NDC_center[1] - half_height + 0.008f);
+    mesh.coordinates.push_back(0.0f);
+    mesh.coordinates.push_back(1.0f);
+
+    mesh.coordinates.push_back(NDC_center[0] - half_base);
+    mesh.coordinates.push_back(NDC_center[1] + half_height + 0.008f);
+    mesh.coordinates.push_back(0.0f);
+    mesh.coordinates.push_back(1.0f);
+
+    mesh.coordinates.push_back(NDC_center[0] + half_base);
+    mesh.coordinates.push_back(NDC_center[1] + half_height + 0.008f);
+    mesh.coordinates.push_back(0.0f);
+    mesh.coordinates.push_back(1.0f);
+
+    mesh.coordinates.push_back(point_x);
+    mesh.coordinates.push_back(point_y);
+    mesh.coordinates.push_back(0.0f);
+    mesh.coordinates.push_back(1.0f);
 
     // Definir a cor azul para o dígito um
     for(GLuint i = 0; i < 5; i++){
-        colors.push_back(0.0f);
-        colors.push_back(0.0f);
-        colors.push_back(1.0f);
-        colors.push_back(1.0f);
+        mesh.colors.push_back(0.0f);
+        mesh.colors.push_back(0.0f);
+        mesh.colors.push_back(1.0f);
+        mesh.colors.push_back(1.0f);
+        mesh.glyphs.push_back(1.0f);
     }
 
     // Gerar a topologia do dígito um
-    topology.push_back(0);
-    topology.push_back(1);
-    topology.push_back(2);
-    topology.push_back(3);
-    topology.push_back(2);
-    topology.push_back(1);
-    topology.push_back(3);
-    topology.push_back(2);
-    topology.push_back(4);
-
-    // Construir os VBOs para a posição geométrica
-
-    glGenBuffers(1, &VBO_NDC_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_NDC_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, coordinates.size() * sizeof(GLfloat), coordinates.data(), GL_STATIC_DRAW);
-    GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
-    glVertexAttribPointer(location, point_coords, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // Construir os VBOs para as informações de cores
-
-    glGenBuffers(1, &VBO_color_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_color_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GLfloat), colors.data(), GL_STATIC_DRAW);
-    location = 1; // "(location = 1)" em "shader_vertex.glsl"
-    glVertexAttribPointer(location, color_coding, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // Construir o VBO para a topologia
-
-    glGenBuffers(1, &indices_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, topology.size() * sizeof(GLuint), topology.data(), GL_STATIC_DRAW);
-
-    GLuint size = 9;
-    return size;
+    const GLuint topology[] = { 0, 1, 2, 3, 2, 1, 3, 2, 4 };
+    for(GLuint i = 0; i < 9; i++){
+        mesh.topology.push_back(first_vertex + topology[i]);
+    }
 }
 
 // Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
@@ -550,11 +571,13 @@ void LoadShadersFromFiles()
     GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment.glsl");
 
     // Deletamos o programa de GPU anterior, caso ele exista.
-    if ( g_GpuProgramID != 0 )
-        glDeleteProgram(g_GpuProgramID);
+    GpuResources_Release(GPU_PROGRAM, g_GpuProgramID);
 
     // Criamos um programa de GPU utilizando os shaders carregados acima.
     g_GpuProgramID = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+
+    // Buscamos a localização da variável "uniform" que posiciona os dígitos.
+    g_digit_layout_uniform = glGetUniformLocation(g_GpuProgramID, "digit_layout");
 }
 
 // Esta função cria um programa de GPU, o qual contém obrigatoriamente um
@@ -562,7 +585,7 @@ void LoadShadersFromFiles()
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
 {
     // Criamos um identificador (ID) para este programa de GPU
-    GLuint program_id = glCreateProgram();
+    GLuint program_id = GpuResources_Create(GPU_PROGRAM, "CreateGpuProgram");
 
     // Definição dos dois shaders GLSL que devem ser executados pelo programa
     glAttachShader(program_id, vertex_shader_id);
@@ -1,9 +1,18 @@
 #version 330 core
   
 // Atributos de vértice recebidos como entrada ("in") pelo Vertex Shader.
-// Veja a função BuildTriangle() em "main.cpp".
+// Veja a função BuildDigitDisplay() em "main.cpp".
 layout (location = 0) in vec4 NDC_coefficients;
 layout (location = 1) in vec4 color_coefficients;
+layout (location = 2) in float glyph_coefficients; // Glifo ao qual o vértice pertence (0 ou 1)
+
+// Atributo por instância (um valor por dígito do contador): o glifo que o
+// dígito deve mostrar (0 ou 1).
+layout (location = 3) in float instance_glyph;
+
+// Posicionamento dos dígitos: (centro x do dígito 0, distância entre
+// centros, escala horizontal dos glifos). Veja DrawDigitDisplay().
+uniform vec3 digit_layout;
 
 // Atributos de vértice que serão gerados como saída ("out") pelo Vertex Shader.
 // ** Estes serão interpolados pelo rasterizador! ** gerando, assim, valores
@@ -19,9 +28,16 @@ void main()
     // "Aula_03_Rendering_Pipeline_Grafico.pdf").
     // 
     // Como o código em "main.cpp" já define estes vértices em NDC (veja o
-    // array NDC_coefficients), simplesmente copiamos tais valores para a
-    // variável gl_Position.
+    // array NDC_coefficients), somente deslocamos o glifo até a posição do
+    // dígito desta instância (gl_InstanceID é o índice do bit no contador).
     gl_Position = NDC_coefficients;
+    gl_Position.x = NDC_coefficients.x * digit_layout.z + digit_layout.x - digit_layout.y * float(gl_InstanceID);
+
+    // Os dois glifos são desenhados em todas as instâncias. Os vértices do
+    // glifo que não corresponde ao dígito são levados para fora do volume de
+    // visualização, e seus triângulos são descartados pelo recorte.
+    if (glyph_coefficients != instance_glyph)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
 
     // Como as variáveis acima são vetores com 4 coeficientes (tipo vec4),
     // também é possível acessar e modificar cada coeficiente de maneira
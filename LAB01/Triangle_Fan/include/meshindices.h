@@ -0,0 +1,65 @@
+#ifndef _MESHINDICES_H
+#define _MESHINDICES_H
+
+// Escolha automática do tipo dos índices de uma malha. Veja "meshindices.cpp".
+//
+// Os construtores de malhas geram índices GLuint. Antes do envio para a GPU,
+// cada faixa de índices (ex.: um objeto de um modelo) é convertida para o
+// menor tipo capaz de representar seus vértices: GL_UNSIGNED_BYTE,
+// GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT. Os índices são guardados relativos
+// ao menor vértice da faixa, que é somado de volta na GPU através de
+// glDrawElementsBaseVertex(). Assim, o tipo depende somente do número de
+// vértices da faixa, e não da sua posição no buffer de vértices.
+//
+// Faixas de tipos diferentes podem ser guardadas no mesmo buffer de índices.
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Valor que, nos índices de entrada, indica o reinício da primitiva
+// (GL_PRIMITIVE_RESTART) em faixas de GL_TRIANGLE_STRIP e GL_TRIANGLE_FAN.
+// É convertido para o maior valor do tipo escolhido.
+#define MESH_PRIMITIVE_RESTART 0xFFFFFFFFu
+
+// Uma faixa de índices pronta para ser desenhada por MeshIndices_Draw().
+struct MeshIndexRange
+{
+    GLenum  type;              // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+    size_t  offset;            // Deslocamento (em bytes) dentro do buffer de índices
+    GLsizei count;             // Número de índices
+    GLint   base_vertex;       // Somado a cada índice pela GPU
+    bool    primitive_restart; // A faixa contém MESH_PRIMITIVE_RESTART
+};
+
+// Conteúdo de um buffer de índices em construção.
+struct MeshIndexData
+{
+    std::vector<unsigned char> bytes;
+};
+
+// Menor tipo capaz de indexar "num_vertices" vértices. Se primitive_restart
+// for true, o maior valor do tipo fica reservado para o reinício.
+GLenum MeshIndices_ChooseType(size_t num_vertices, bool primitive_restart);
+
+// Tamanho em bytes de um índice do tipo dado.
+size_t MeshIndices_TypeSize(GLenum type);
+
+// Índice de reinício (o maior valor) do tipo dado.
+GLuint MeshIndices_RestartIndex(GLenum type);
+
+// Converte "count" índices para o menor tipo possível e os adiciona a "data",
+// retornando a faixa correspondente. Os índices podem conter
+// MESH_PRIMITIVE_RESTART.
+MeshIndexRange MeshIndices_Append(MeshIndexData& data, const GLuint* indices, size_t count);
+
+// Envia "data" para o buffer "buffer_id", que é ligado como
+// GL_ELEMENT_ARRAY_BUFFER do VAO atualmente ligado.
+void MeshIndices_Upload(const MeshIndexData& data, GLuint buffer_id);
+
+// Desenha uma faixa do GL_ELEMENT_ARRAY_BUFFER do VAO atualmente ligado.
+void MeshIndices_Draw(GLenum mode, const MeshIndexRange& range);
+void MeshIndices_DrawInstanced(GLenum mode, const MeshIndexRange& range, GLsizei num_instances);
+
+#endif // _MESHINDICES_H
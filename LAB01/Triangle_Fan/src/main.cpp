@@ -31,10 +31,11 @@
 
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
+#include "meshindices.h"
 
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
-GLuint BuildTriangles(GLfloat radius, GLuint points_count); // Constrói triângulos para renderização
+GLuint BuildTriangles(GLfloat radius, GLuint points_count, MeshIndexRange& indices_range); // Constrói triângulos para renderização
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
@@ -119,7 +120,8 @@ int main()
     // Construímos a representação de um triângulo
     GLfloat radius = 0.7f;
     GLuint points_count = 17;
-    GLuint vertex_array_object_id = BuildTriangles(radius, points_count);
+    MeshIndexRange indices_range;
+    GLuint vertex_array_object_id = BuildTriangles(radius, points_count, indices_range);
 
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
@@ -143,7 +145,7 @@ int main()
 
         // Pedimos para a GPU rasterizar os vértices apontados pelo VAO como
         // triângulos
-        glDrawElements(GL_TRIANGLE_FAN, points_count + 1, GL_UNSIGNED_BYTE, 0);
+        MeshIndices_Draw(GL_TRIANGLE_FAN, indices_range);
 
         // "Desligamos" o VAO, evitando assim que operações posteriores venham a
         // alterar o mesmo. Isso evita bugs
@@ -164,7 +166,7 @@ int main()
 }
 
 // Constrói triângulos para futura renderização
-GLuint BuildTriangles(GLfloat radius, GLuint points_count)
+GLuint BuildTriangles(GLfloat radius, GLuint points_count, MeshIndexRange& indices_range)
 {
     // Definir dados vetoriais
     GLuint point_coords = 4;
@@ -185,7 +187,7 @@ GLuint BuildTriangles(GLfloat radius, GLuint points_count)
     color_coefficients.push_back(1.0f);
 
     // Inicializar o vetor de índices
-    std::vector<GLubyte> indices;
+    std::vector<GLuint> indices;
     indices.push_back(0);
 
     // Calcular e colocar todos os dados dos pontos (posição, cor e topologia)
@@ -204,7 +206,7 @@ GLuint BuildTriangles(GLfloat radius, GLuint points_count)
         color_coefficients.push_back(1.0f);
 
         // Construir topologia de TRIANGLE_FAN
-        indices.push_back(GLubyte(i));
+        indices.push_back(i);
     }
     indices.push_back(1);
 
@@ -231,11 +233,13 @@ GLuint BuildTriangles(GLfloat radius, GLuint points_count)
     glEnableVertexAttribArray(location);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    // Construir o VBO para a topologia
+    // Construir o VBO para a topologia, com o menor tipo de índice capaz de
+    // representar todos os pontos (veja "meshindices.h")
+    MeshIndexData index_data;
+    indices_range = MeshIndices_Append(index_data, indices.data(), indices.size());
     GLuint indices_id;
     glGenBuffers(1, &indices_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLubyte), indices.data(), GL_STATIC_DRAW);
+    MeshIndices_Upload(index_data, indices_id);
     glBindVertexArray(0);
 
     return vertex_array_object_id;
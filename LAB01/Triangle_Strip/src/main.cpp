@@ -31,10 +31,11 @@
 
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
+#include "meshindices.h"
 
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
-GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint external_points_count); // Constrói triângulos para renderização
+GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint external_points_count, MeshIndexRange& indices_range); // Constrói triângulos para renderização
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
@@ -120,7 +121,8 @@ int main()
     GLfloat external_radius = 0.7f;
     GLfloat internal_radius = 0.5f;
     GLuint external_points_count = 16;
-    GLuint vertex_array_object_id = BuildTriangles(external_radius, internal_radius, external_points_count);
+    MeshIndexRange indices_range;
+    GLuint vertex_array_object_id = BuildTriangles(external_radius, internal_radius, external_points_count, indices_range);
 
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
@@ -144,7 +146,7 @@ int main()
 
         // Pedimos para a GPU rasterizar os vértices apontados pelo VAO como
         // triângulos
-        glDrawElements(GL_TRIANGLE_STRIP, 2 * external_points_count + 2, GL_UNSIGNED_BYTE, 0);
+        MeshIndices_Draw(GL_TRIANGLE_STRIP, indices_range);
 
         // "Desligamos" o VAO, evitando assim que operações posteriores venham a
         // alterar o mesmo. Isso evita bugs
@@ -165,7 +167,7 @@ int main()
 }
 
 // Constrói triângulos para futura renderização
-GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint external_points_count)
+GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint external_points_count, MeshIndexRange& indices_range)
 {
     // Definir dados vetoriais
     GLuint point_coords = 4;
@@ -178,7 +180,7 @@ GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint e
     std::vector<GLfloat> color_coefficients;
 
     // Alocar o vetor de índices
-    std::vector<GLubyte> indices;
+    std::vector<GLuint> indices;
 
     // Calcular e colocar todos os dados dos pontos (posição, cor e topologia)
     GLfloat step = 2.0f * M_PI / external_points_count;
@@ -206,8 +208,8 @@ GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint e
         color_coefficients.push_back(1.0f);
 
         // Construir topologia de TRIANGLE_STRIP
-        indices.push_back(GLubyte(2 * i));
-        indices.push_back(GLubyte(2 * i + 1));
+        indices.push_back(2 * i);
+        indices.push_back(2 * i + 1);
     }
     indices.push_back(0);
     indices.push_back(1);
@@ -235,11 +237,13 @@ GLuint BuildTriangles(GLfloat external_radius, GLfloat internal_radius, GLuint e
     glEnableVertexAttribArray(location);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    // Construir o VBO para a topologia
+    // Construir o VBO para a topologia, com o menor tipo de índice capaz de
+    // representar todos os pontos (veja "meshindices.h")
+    MeshIndexData index_data;
+    indices_range = MeshIndices_Append(index_data, indices.data(), indices.size());
     GLuint indices_id;
     glGenBuffers(1, &indices_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLubyte), indices.data(), GL_STATIC_DRAW);
+    MeshIndices_Upload(index_data, indices_id);
     glBindVertexArray(0);
 
     return vertex_array_object_id;
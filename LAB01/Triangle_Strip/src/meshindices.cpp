@@ -0,0 +1,141 @@
+// Escolha automática do tipo dos índices de uma malha.
+//
+// A maior parte das malhas pequenas (planos, cubos, glifos) cabe em
+// GL_UNSIGNED_BYTE, e quase todas as demais em GL_UNSIGNED_SHORT, ocupando
+// respectivamente 1/4 e 1/2 da memória (e da banda de leitura de índices)
+// de GL_UNSIGNED_INT. Como os índices são relativos ao primeiro vértice de
+// cada faixa, um objeto pequeno dentro de um modelo grande também se
+// beneficia. Note que algumas GPUs convertem índices GL_UNSIGNED_BYTE
+// internamente; mesmo assim, a escolha nunca é pior que GL_UNSIGNED_INT.
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "meshindices.h"
+
+GLenum MeshIndices_ChooseType(size_t num_vertices, bool primitive_restart)
+{
+    // Com reinício de primitiva, o maior valor do tipo não pode ser um vértice.
+    const size_t reserved = primitive_restart ? 1 : 0;
+
+    if ( num_vertices + reserved <= 256 )
+        return GL_UNSIGNED_BYTE;
+    if ( num_vertices + reserved <= 65536 )
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+size_t MeshIndices_TypeSize(GLenum type)
+{
+    switch ( type )
+    {
+        case GL_UNSIGNED_BYTE:  return sizeof(GLubyte);
+        case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+        default:                return sizeof(GLuint);
+    }
+}
+
+GLuint MeshIndices_RestartIndex(GLenum type)
+{
+    switch ( type )
+    {
+        case GL_UNSIGNED_BYTE:  return std::numeric_limits<GLubyte>::max();
+        case GL_UNSIGNED_SHORT: return std::numeric_limits<GLushort>::max();
+        default:                return std::numeric_limits<GLuint>::max();
+    }
+}
+
+// Escreve os índices, relativos a "base_vertex", no formato T.
+template <typename T>
+static void MeshIndices_Write(unsigned char* output, const GLuint* indices, size_t count, GLuint base_vertex)
+{
+    const T restart = std::numeric_limits<T>::max();
+    T* typed_output = (T*)output;
+    for (size_t i = 0; i < count; ++i)
+        typed_output[i] = (indices[i] == MESH_PRIMITIVE_RESTART) ? restart : (T)(indices[i] - base_vertex);
+}
+
+MeshIndexRange MeshIndices_Append(MeshIndexData& data, const GLuint* indices, size_t count)
+{
+    // Intervalo de vértices utilizados pela faixa.
+    GLuint min_vertex = std::numeric_limits<GLuint>::max();
+    GLuint max_vertex = 0;
+    bool primitive_restart = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ( indices[i] == MESH_PRIMITIVE_RESTART )
+        {
+            primitive_restart = true;
+            continue;
+        }
+        if ( indices[i] < min_vertex ) min_vertex = indices[i];
+        if ( indices[i] > max_vertex ) max_vertex = indices[i];
+    }
+    if ( min_vertex > max_vertex )
+        min_vertex = max_vertex = 0; // Nenhum vértice
+
+    if ( min_vertex > (GLuint)std::numeric_limits<GLint>::max() )
+    {
+        fprintf(stderr, "ERROR: Mesh base vertex %u does not fit in a GLint.\n", min_vertex);
+        std::exit(EXIT_FAILURE);
+    }
+
+    MeshIndexRange range;
+    range.type = MeshIndices_ChooseType((size_t)(max_vertex - min_vertex) + 1, primitive_restart);
+    range.count = (GLsizei)count;
+    range.base_vertex = (GLint)min_vertex;
+    range.primitive_restart = primitive_restart;
+
+    // O deslocamento de cada faixa deve ser múltiplo do tamanho do seu tipo.
+    const size_t type_size = MeshIndices_TypeSize(range.type);
+    range.offset = (data.bytes.size() + type_size - 1) / type_size * type_size;
+    data.bytes.resize(range.offset + count * type_size);
+
+    unsigned char* output = data.bytes.data() + range.offset;
+    switch ( range.type )
+    {
+        case GL_UNSIGNED_BYTE:  MeshIndices_Write<GLubyte>(output, indices, count, min_vertex); break;
+        case GL_UNSIGNED_SHORT: MeshIndices_Write<GLushort>(output, indices, count, min_vertex); break;
+        default:                MeshIndices_Write<GLuint>(output, indices, count, min_vertex); break;
+    }
+
+    return range;
+}
+
+void MeshIndices_Upload(const MeshIndexData& data, GLuint buffer_id)
+{
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.bytes.size(), data.bytes.data(), GL_STATIC_DRAW);
+}
+
+// Habilita o reinício de primitiva, caso a faixa o utilize. O índice de
+// reinício é comparado com o valor lido do buffer, antes da soma de
+// base_vertex.
+static void MeshIndices_BeginRestart(const MeshIndexRange& range)
+{
+    if ( !range.primitive_restart )
+        return;
+
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(MeshIndices_RestartIndex(range.type));
+}
+
+static void MeshIndices_EndRestart(const MeshIndexRange& range)
+{
+    if ( range.primitive_restart )
+        glDisable(GL_PRIMITIVE_RESTART);
+}
+
+void MeshIndices_Draw(GLenum mode, const MeshIndexRange& range)
+{
+    MeshIndices_BeginRestart(range);
+    glDrawElementsBaseVertex(mode, range.count, range.type, (void*)range.offset, range.base_vertex);
+    MeshIndices_EndRestart(range);
+}
+
+void MeshIndices_DrawInstanced(GLenum mode, const MeshIndexRange& range, GLsizei num_instances)
+{
+    MeshIndices_BeginRestart(range);
+    glDrawElementsInstancedBaseVertex(mode, range.count, range.type, (void*)range.offset, num_instances, range.base_vertex);
+    MeshIndices_EndRestart(range);
+}
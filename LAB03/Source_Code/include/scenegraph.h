@@ -0,0 +1,74 @@
+#ifndef _SCENEGRAPH_H
+#define _SCENEGRAPH_H
+
+// Grafo de cena hierárquico com cache das matrizes de modelagem. Veja
+// "scenegraph.cpp".
+//
+// Cada nó guarda sua transformação local (translação, rotação e escala) em
+// relação ao nó pai, e a matriz de modelagem resultante (em coordenadas
+// globais) fica guardada entre quadros. Somente os nós cuja transformação
+// local mudou, e seus descendentes, são recomputados por SceneGraph_Update().
+//
+// Os nós são armazenados em vetores contíguos (um vetor por atributo), com
+// todo pai aparecendo antes de seus filhos. Assim a atualização é um único
+// laço sequencial, sem recursão e sem pilha de matrizes.
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+// Índice de um nó dentro de SceneGraph. -1 indica "nenhum nó" (ex.: o pai de
+// um nó raiz).
+typedef int SceneNodeHandle;
+
+// Transformação local de um nó. A matriz correspondente é
+//
+//   T(translation) * Rz(rotation.z) * Ry(rotation.y) * Rx(rotation.x) * S(scale)
+//
+// isto é, primeiro a escala, depois as rotações de Euler X, Y e Z, e por fim
+// a translação.
+struct SceneTransform
+{
+    glm::vec3 translation;
+    glm::vec3 rotation; // Ângulos de Euler (em radianos)
+    glm::vec3 scale;
+
+    SceneTransform()
+        : translation(0.0f), rotation(0.0f), scale(1.0f) {}
+    SceneTransform(const glm::vec3& t, const glm::vec3& r = glm::vec3(0.0f), const glm::vec3& s = glm::vec3(1.0f))
+        : translation(t), rotation(r), scale(s) {}
+};
+
+struct SceneGraph
+{
+    std::vector<SceneNodeHandle> parent;    // Pai de cada nó (sempre com índice menor)
+    std::vector<SceneTransform>  transform; // Transformação local
+    std::vector<glm::mat4>       local;     // Matriz da transformação local (cache)
+    std::vector<glm::mat4>       world;     // Matriz de modelagem (cache)
+    std::vector<uint8_t>         flags;     // SCENE_NODE_* abaixo
+};
+
+#define SCENE_NODE_LOCAL_DIRTY   0x1 // Transformação local mudou desde a última atualização
+#define SCENE_NODE_WORLD_UPDATED 0x2 // Matriz de modelagem recomputada na última atualização
+
+// Adiciona um nó filho de "parent" (ou um nó raiz, se parent == -1),
+// retornando seu índice.
+SceneNodeHandle SceneGraph_AddNode(SceneGraph& graph, SceneNodeHandle parent, const SceneTransform& transform = SceneTransform());
+
+// Altera a transformação local de um nó. O nó só é marcado para atualização
+// se a transformação for diferente da atual.
+void SceneGraph_SetTransform(SceneGraph& graph, SceneNodeHandle node, const SceneTransform& transform);
+
+// Recomputa as matrizes de modelagem dos nós alterados e de seus
+// descendentes. Retorna o número de nós recomputados.
+int SceneGraph_Update(SceneGraph& graph);
+
+// Matriz de modelagem de um nó, válida após SceneGraph_Update().
+inline const glm::mat4& SceneGraph_World(const SceneGraph& graph, SceneNodeHandle node)
+{
+    return graph.world[node];
+}
+
+#endif // _SCENEGRAPH_H
@@ -21,8 +21,8 @@
 
 // Headers abaixo são específicos de C++
 #include <map>
-#include <stack>
 #include <string>
+#include <vector>
 #include <limits>
 #include <fstream>
 #include <sstream>
@@ -39,10 +39,11 @@
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
 #include "matrices.h"
+#include "scenegraph.h"
 
-// Declaração de funções utilizadas para pilha de matrizes de modelagem.
-void PushMatrix(glm::mat4 M);
-void PopMatrix(glm::mat4& M);
+// Declaração de funções que constroem e animam o robô no grafo de cena.
+void BuildRobot(); // Cria os nós do robô em g_SceneGraph
+void UpdateRobot(); // Atualiza as articulações do robô a partir da entrada do usuário
 
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
@@ -72,6 +73,7 @@ void TextRendering_ShowModelViewProjection(GLFWwindow* window, glm::mat4 project
 void TextRendering_ShowEulerAngles(GLFWwindow* window);
 void TextRendering_ShowProjection(GLFWwindow* window);
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window);
+void TextRendering_ShowSceneGraphStats(GLFWwindow* window);
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -100,8 +102,25 @@ struct SceneObject
 // estes são acessados.
 std::map<const char*, SceneObject> g_VirtualScene;
 
-// Pilha que guardará as matrizes de modelagem.
-std::stack<glm::mat4>  g_MatrixStack;
+// Grafo de cena com as partes do robô. Veja BuildRobot() e "scenegraph.cpp".
+SceneGraph g_SceneGraph;
+
+// Nós de g_SceneGraph que formam o robô: as articulações animadas pelo
+// usuário e os cubos desenhados (um para cada parte do corpo).
+struct RobotNodes
+{
+    SceneNodeHandle torso;
+    SceneNodeHandle right_arm;
+    SceneNodeHandle right_forearm;
+    SceneNodeHandle left_arm;
+    SceneNodeHandle left_forearm;
+    SceneNodeHandle head;
+    std::vector<SceneNodeHandle> cubes;
+};
+RobotNodes g_Robot;
+
+// Número de nós recomputados na última atualização do grafo de cena.
+int g_NumUpdatedNodes = 0;
 
 // Razão de proporção da janela (largura/altura). Veja função FramebufferSizeCallback().
 float g_ScreenRatio = 1.0f;
@@ -218,6 +237,9 @@ int main()
     // Construímos a representação de um triângulo
     GLuint vertex_array_object_id = BuildTriangles();
 
+    // Construímos a hierarquia de partes do robô
+    BuildRobot();
+
     // Inicializamos o código para renderização de texto.
     TextRendering_Init();
 
@@ -326,181 +348,32 @@ int main()
         // slides 2-14 e 184-190 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
         //
         // Entretanto, neste laboratório as matrizes de modelagem dos cubos
-        // serão construídas de maneira hierárquica, tal que operações em
+        // são construídas de maneira hierárquica, tal que operações em
         // alguns objetos influenciem outros objetos. Por exemplo: ao
         // transladar o torso, a cabeça deve se movimentar junto.
         // Veja slides 243-273 do documento Aula_08_Sistemas_de_Coordenadas.pdf
         //
-        glm::mat4 model = Matrix_Identity(); // Transformação inicial = identidade.
-
-        // Translação inicial do torso
-        model = model * Matrix_Translate(g_TorsoPositionX - 1.0f, g_TorsoPositionY + 1.0f, 0.0f);
-        // Guardamos matriz model atual na pilha
-        PushMatrix(model);
-            // Atualizamos a matriz model (multiplicação à direita) para fazer um escalamento do torso
-            model = model * Matrix_Scale(0.8f, 1.0f, 0.2f);
-            // Enviamos a matriz "model" para a placa de vídeo (GPU). Veja o
-            // arquivo "shader_vertex.glsl", onde esta é efetivamente
-            // aplicada em todos os pontos.
-            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-            // Desenhamos um cubo. Esta renderização irá executar o Vertex
-            // Shader definido no arquivo "shader_vertex.glsl", e o mesmo irá
-            // utilizar as matrizes "model", "view" e "projection" definidas
-            // acima e já enviadas para a placa de vídeo (GPU).
-            DrawCube(render_as_black_uniform); // #### TORSO
-        // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model);
-
-        // Braço direito
-        PushMatrix(model); // Guardamos matriz model atual na pilha
-            model = model * Matrix_Translate(-0.55f, 0.0f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com uma translação para o braço direito
-            PushMatrix(model); // Guardamos matriz model atual na pilha
-                model = model // Atualizamos matriz model (multiplicação à direita) com a rotação do braço direito
-                      * Matrix_Rotate_Z(g_AngleZ)  // TERCEIRO rotação Z de Euler
-                      * Matrix_Rotate_Y(g_AngleY)  // SEGUNDO rotação Y de Euler
-                      * Matrix_Rotate_X(g_AngleX); // PRIMEIRO rotação X de Euler
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Scale(0.2f, 0.6f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do braço direito
-                    glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                    DrawCube(render_as_black_uniform); // #### BRAÇO DIREITO // Desenhamos o braço direito
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Translate(0.0f, -0.65f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação do antebraço direito
-                    model = model // Atualizamos matriz model (multiplicação à direita) com a rotação do antebraço direito
-                          * Matrix_Rotate_Z(g_ForearmAngleZ)  // SEGUNDO rotação Z de Euler
-                          * Matrix_Rotate_X(g_ForearmAngleX); // PRIMEIRO rotação X de Euler
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Scale(0.2f, 0.6f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do antebraço direito
-                        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                        DrawCube(render_as_black_uniform); // #### ANTEBRAÇO DIREITO // Desenhamos o antebraço direito
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Translate(0.0f, -0.65f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação da mão direita
-                        PushMatrix(model); // Guardamos matriz model atual na pilha
-                            model = model * Matrix_Scale(0.2f, 0.1f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da mão direita
-                            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                            DrawCube(render_as_black_uniform); // #### MÃO DIREITA // Desenhamos a mão direita
-                        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-            PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-
-        // Braço esquerdo
-        PushMatrix(model); // Guardamos matriz model atual na pilha
-            model = model * Matrix_Translate(0.55f, 0.0f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com uma translação para o braço esquerdo
-            PushMatrix(model); // Guardamos matriz model atual na pilha
-                model = model // Atualizamos matriz model (multiplicação à direita) com a rotação do braço esquerdo
-                      * Matrix_Rotate_Z(-g_AngleZ)  // TERCEIRO rotação Z de Euler
-                      * Matrix_Rotate_Y(g_AngleY)  // SEGUNDO rotação Y de Euler
-                      * Matrix_Rotate_X(g_AngleX); // PRIMEIRO rotação X de Euler
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Scale(0.2f, 0.6f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do braço esquerdo
-                    glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                    DrawCube(render_as_black_uniform); // #### BRAÇO ESQUERDO // Desenhamos o braço esquerdo
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Translate(0.0f, -0.65f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação do antebraço esquerdo
-                    model = model // Atualizamos matriz model (multiplicação à direita) com a rotação do antebraço esquerdo
-                          * Matrix_Rotate_Z(-g_ForearmAngleZ)  // SEGUNDO rotação Z de Euler
-                          * Matrix_Rotate_X(g_ForearmAngleX); // PRIMEIRO rotação X de Euler
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Scale(0.2f, 0.6f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do antebraço esquerdo
-                        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                        DrawCube(render_as_black_uniform); // #### ANTEBRAÇO ESQUERDO // Desenhamos o antebraço esquerdo
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Translate(0.0f, -0.65f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação da mão esquerda
-                        PushMatrix(model); // Guardamos matriz model atual na pilha
-                            model = model * Matrix_Scale(0.2f, 0.1f, 0.2f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da mão esquerda
-                            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                            DrawCube(render_as_black_uniform); // #### MÃO ESQUERDA // Desenhamos a mão esquerda
-                        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-            PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-
-        // Cabeça
-        PushMatrix(model); // Guardamos matriz model atual na pilha
-            model = model * Matrix_Translate(0.0f, 0.05f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação da cabeça
-            PushMatrix(model); // Guardamos matriz model atual na pilha
-                model = model // Atualizamos matriz model (multiplicação à direita) com a rotação da cabeça
-                        * Matrix_Rotate_Z(g_AngleZ)  // TERCEIRO rotação Z de Euler
-                        * Matrix_Rotate_Y(-g_AngleY)  // SEGUNDO rotação Y de Euler
-                        * Matrix_Rotate_X(-g_AngleX); // PRIMEIRO rotação X de Euler
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Scale(-0.31f, -0.31f, 0.31f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da cabeça
-                    glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                    DrawCube(render_as_black_uniform); // #### CABEÇA // Desenhamos a cabeça
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-            PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-
-        // Perna direita
-        PushMatrix(model); // Guardamos matriz model atual na pilha
-            model = model * Matrix_Translate(-0.2f, -1.05f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com uma translação para a coxa direita
-            PushMatrix(model); // Guardamos matriz model atual na pilha
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Scale(0.3f, 0.7f, 0.3f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da coxa direita
-                    glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                    DrawCube(render_as_black_uniform); // #### COXA DIREITA // Desenhamos a coxa direita
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Translate(0.0f, -0.75f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação da sobrecoxa direita
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Scale(0.25f, 0.75f, 0.25f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da sobrecoxa direita
-                        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                        DrawCube(render_as_black_uniform); // #### SOBRECOXA DIREITA // Desenhamos a sobrecoxa direita
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Translate(0.0f, -0.8f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação do pé direito
-                        PushMatrix(model); // Guardamos matriz model atual na pilha
-                            model = model * Matrix_Scale(0.2f, 0.1f, 0.5f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do pé direito
-                            model = model * Matrix_Translate(0.0f, 0.0f, 0.175f); // Atualizamos matriz model (multiplicação à direita) com a translação do pé direito
-                            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                            DrawCube(render_as_black_uniform); // #### PÉ DIREITO // Desenhamos o pé direito
-                        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-            PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-
-        // Perna esquerda
-        PushMatrix(model); // Guardamos matriz model atual na pilha
-            model = model * Matrix_Translate(0.2f, -1.05f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com uma translação para a coxa esquerda
-            PushMatrix(model); // Guardamos matriz model atual na pilha
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Scale(0.3f, 0.7f, 0.3f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da coxa esquerda
-                    glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                    DrawCube(render_as_black_uniform); // #### COXA ESQUERDA // Desenhamos a coxa esquerda
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PushMatrix(model); // Guardamos matriz model atual na pilha
-                    model = model * Matrix_Translate(0.0f, -0.75f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação da sobrecoxa esquerda
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Scale(0.25f, 0.75f, 0.25f); // Atualizamos matriz model (multiplicação à direita) com um escalamento da sobrecoxa esquerda
-                        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                        DrawCube(render_as_black_uniform); // #### SOBRECOXA ESQUERDA // Desenhamos a sobrecoxa esquerda
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PushMatrix(model); // Guardamos matriz model atual na pilha
-                        model = model * Matrix_Translate(0.0f, -0.8f, 0.0f); // Atualizamos matriz model (multiplicação à direita) com a translação do pé esquerdo
-                        PushMatrix(model); // Guardamos matriz model atual na pilha
-                            model = model * Matrix_Scale(0.2f, 0.1f, 0.5f); // Atualizamos matriz model (multiplicação à direita) com um escalamento do pé esquerdo
-                            model = model * Matrix_Translate(0.0f, 0.0f, 0.175f); // Atualizamos matriz model (multiplicação à direita) com a translação do pé esquerdo
-                            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model)); // Enviamos matriz model atual para a GPU
-                            DrawCube(render_as_black_uniform); // #### PÉ ESQUERDO // Desenhamos o pé esquerdo
-                        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                    PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-                PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-            PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-        PopMatrix(model); // Tiramos da pilha a matriz model guardada anteriormente
-
-        // Neste ponto a matriz model recuperada é a matriz inicial (translação do torso)
+        // A hierarquia é guardada em g_SceneGraph (veja BuildRobot()), que
+        // mantém as matrizes de modelagem entre quadros: atualizamos as
+        // articulações a partir das variáveis controladas pelo usuário, e
+        // somente as partes que se moveram (e as partes presas a elas) têm
+        // suas matrizes recomputadas.
+        UpdateRobot();
+        g_NumUpdatedNodes = SceneGraph_Update(g_SceneGraph);
+
+        for (size_t i = 0; i < g_Robot.cubes.size(); ++i)
+        {
+            // Enviamos a matriz "model" de cada parte para a placa de vídeo
+            // (GPU). Veja o arquivo "shader_vertex.glsl", onde esta é
+            // efetivamente aplicada em todos os pontos.
+            glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(SceneGraph_World(g_SceneGraph, g_Robot.cubes[i])));
+            DrawCube(render_as_black_uniform);
+        }
 
         // Agora queremos desenhar os eixos XYZ de coordenadas GLOBAIS.
         // Para tanto, colocamos a matriz de modelagem igual à identidade.
         // Veja slides 2-14 e 184-190 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
-        model = Matrix_Identity();
+        glm::mat4 model = Matrix_Identity();
 
         // Enviamos a nova matriz "model" para a placa de vídeo (GPU). Veja o
         // arquivo "shader_vertex.glsl".
@@ -541,6 +414,9 @@ int main()
         // por segundo (frames per second).
         TextRendering_ShowFramesPerSecond(window);
 
+        // Imprimimos na tela quantas partes do robô foram recomputadas.
+        TextRendering_ShowSceneGraphStats(window);
+
         // O framebuffer onde OpenGL executa as operações de renderização não
         // é o mesmo que está sendo mostrado para o usuário, caso contrário
         // seria possível ver artefatos conhecidos como "screen tearing". A
@@ -563,26 +439,77 @@ int main()
     return 0;
 }
 
-// Função que pega a matriz M e guarda a mesma no topo da pilha
-void PushMatrix(glm::mat4 M)
+// Função que cria os nós do robô em g_SceneGraph. Cada articulação é um nó
+// com a translação (e rotação) em relação à parte à qual está presa; cada
+// parte do corpo é um nó filho da sua articulação, com a escala do cubo
+// desenhado. Assim a escala de uma parte não afeta as partes presas a ela.
+void BuildRobot()
 {
-    g_MatrixStack.push(M);
-}
+    SceneGraph& graph = g_SceneGraph;
+    const glm::vec3 zero(0.0f);
 
-// Função que remove a matriz atualmente no topo da pilha e armazena a mesma na variável M
-void PopMatrix(glm::mat4& M)
-{
-    if ( g_MatrixStack.empty() )
+    // Torso (translação atualizada em UpdateRobot())
+    g_Robot.torso = SceneGraph_AddNode(graph, -1);
+    g_Robot.cubes.push_back(SceneGraph_AddNode(graph, g_Robot.torso, SceneTransform(zero, zero, glm::vec3(0.8f, 1.0f, 0.2f)))); // #### TORSO
+
+    // Braços direito (sinal -1) e esquerdo (sinal +1)
+    for (int side = -1; side <= 1; side += 2)
     {
-        M = Matrix_Identity();
+        SceneNodeHandle arm = SceneGraph_AddNode(graph, g_Robot.torso, SceneTransform(glm::vec3(side * 0.55f, 0.0f, 0.0f)));
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, arm, SceneTransform(zero, zero, glm::vec3(0.2f, 0.6f, 0.2f)))); // #### BRAÇO
+        SceneNodeHandle forearm = SceneGraph_AddNode(graph, arm, SceneTransform(glm::vec3(0.0f, -0.65f, 0.0f)));
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, forearm, SceneTransform(zero, zero, glm::vec3(0.2f, 0.6f, 0.2f)))); // #### ANTEBRAÇO
+        SceneNodeHandle hand = SceneGraph_AddNode(graph, forearm, SceneTransform(glm::vec3(0.0f, -0.65f, 0.0f)));
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, hand, SceneTransform(zero, zero, glm::vec3(0.2f, 0.1f, 0.2f)))); // #### MÃO
+
+        if ( side < 0 )
+        {
+            g_Robot.right_arm = arm;
+            g_Robot.right_forearm = forearm;
+        }
+        else
+        {
+            g_Robot.left_arm = arm;
+            g_Robot.left_forearm = forearm;
+        }
     }
-    else
+
+    // Cabeça
+    g_Robot.head = SceneGraph_AddNode(graph, g_Robot.torso, SceneTransform(glm::vec3(0.0f, 0.05f, 0.0f)));
+    g_Robot.cubes.push_back(SceneGraph_AddNode(graph, g_Robot.head, SceneTransform(zero, zero, glm::vec3(-0.31f, -0.31f, 0.31f)))); // #### CABEÇA
+
+    // Pernas direita (sinal -1) e esquerda (sinal +1)
+    for (int side = -1; side <= 1; side += 2)
     {
-        M = g_MatrixStack.top();
-        g_MatrixStack.pop();
+        SceneNodeHandle thigh = SceneGraph_AddNode(graph, g_Robot.torso, SceneTransform(glm::vec3(side * 0.2f, -1.05f, 0.0f)));
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, thigh, SceneTransform(zero, zero, glm::vec3(0.3f, 0.7f, 0.3f)))); // #### COXA
+        SceneNodeHandle shin = SceneGraph_AddNode(graph, thigh, SceneTransform(glm::vec3(0.0f, -0.75f, 0.0f)));
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, shin, SceneTransform(zero, zero, glm::vec3(0.25f, 0.75f, 0.25f)))); // #### SOBRECOXA
+        SceneNodeHandle foot = SceneGraph_AddNode(graph, shin, SceneTransform(glm::vec3(0.0f, -0.8f, 0.0f)));
+        // O cubo do pé é deslocado para frente: Scale(0.2,0.1,0.5)*Translate(0,0,0.175)
+        // é igual a Translate(0,0,0.175*0.5)*Scale(0.2,0.1,0.5).
+        g_Robot.cubes.push_back(SceneGraph_AddNode(graph, foot, SceneTransform(glm::vec3(0.0f, 0.0f, 0.175f * 0.5f), zero, glm::vec3(0.2f, 0.1f, 0.5f)))); // #### PÉ
     }
 }
 
+// Função que atualiza as articulações do robô a partir das variáveis
+// controladas pelo usuário. Somente os nós cujos valores realmente mudaram
+// são marcados para atualização. Veja SceneGraph_SetTransform().
+void UpdateRobot()
+{
+    SceneGraph& graph = g_SceneGraph;
+
+    SceneGraph_SetTransform(graph, g_Robot.torso, SceneTransform(glm::vec3(g_TorsoPositionX - 1.0f, g_TorsoPositionY + 1.0f, 0.0f)));
+
+    SceneGraph_SetTransform(graph, g_Robot.right_arm, SceneTransform(glm::vec3(-0.55f, 0.0f, 0.0f), glm::vec3(g_AngleX, g_AngleY, g_AngleZ)));
+    SceneGraph_SetTransform(graph, g_Robot.right_forearm, SceneTransform(glm::vec3(0.0f, -0.65f, 0.0f), glm::vec3(g_ForearmAngleX, 0.0f, g_ForearmAngleZ)));
+
+    SceneGraph_SetTransform(graph, g_Robot.left_arm, SceneTransform(glm::vec3(0.55f, 0.0f, 0.0f), glm::vec3(g_AngleX, g_AngleY, -g_AngleZ)));
+    SceneGraph_SetTransform(graph, g_Robot.left_forearm, SceneTransform(glm::vec3(0.0f, -0.65f, 0.0f), glm::vec3(g_ForearmAngleX, 0.0f, -g_ForearmAngleZ)));
+
+    SceneGraph_SetTransform(graph, g_Robot.head, SceneTransform(glm::vec3(0.0f, 0.05f, 0.0f), glm::vec3(-g_AngleX, -g_AngleY, g_AngleZ)));
+}
+
 // Função que desenha um cubo com arestas em preto, definido dentro da função BuildTriangles().
 void DrawCube(GLint render_as_black_uniform)
 {
@@ -1443,6 +1370,21 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-lineheight, 1.0f);
 }
 
+// Escrevemos na tela quantos nós do grafo de cena foram recomputados no
+// último quadro. Veja SceneGraph_Update().
+void TextRendering_ShowSceneGraphStats(GLFWwindow* window)
+{
+    if ( !g_ShowInfoText )
+        return;
+
+    float lineheight = TextRendering_LineHeight(window);
+
+    char buffer[64];
+    snprintf(buffer, 64, "Scene graph: %d/%d nodes updated", g_NumUpdatedNodes, (int)g_SceneGraph.parent.size());
+
+    TextRendering_PrintString(window, buffer, -1.0f+lineheight/10, 1.0f-lineheight, 1.0f);
+}
+
 // set makeprg=cd\ ..\ &&\ make\ run\ >/dev/null
 // vim: set spell spelllang=pt_br :
 
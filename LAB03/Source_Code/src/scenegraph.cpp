@@ -0,0 +1,87 @@
+// Grafo de cena hierárquico com cache das matrizes de modelagem.
+//
+// Compare com a pilha de matrizes (PushMatrix()/PopMatrix()) utilizada
+// anteriormente em main(): lá, todas as matrizes de todos os objetos eram
+// reconstruídas a cada quadro, mesmo quando nada havia se movido. Aqui cada
+// nó guarda sua matriz de modelagem, e SceneGraph_Update() percorre os
+// vetores uma única vez, em ordem, recomputando somente os nós cuja
+// transformação local mudou e os descendentes destes. Como todo pai aparece
+// antes de seus filhos, quando um nó é visitado a matriz do pai já está
+// atualizada.
+#include <cmath>
+#include <cassert>
+
+#include "scenegraph.h"
+
+// Matriz da transformação local T*Rz*Ry*Rx*S, montada diretamente (sem os
+// quatro produtos de matrizes 4x4). As colunas da parte 3x3 são as colunas
+// de Rz*Ry*Rx multiplicadas pela escala, e a quarta coluna é a translação.
+static glm::mat4 SceneGraph_LocalMatrix(const SceneTransform& t)
+{
+    const float cx = cosf(t.rotation.x), sx = sinf(t.rotation.x);
+    const float cy = cosf(t.rotation.y), sy = sinf(t.rotation.y);
+    const float cz = cosf(t.rotation.z), sz = sinf(t.rotation.z);
+
+    glm::mat4 M;
+    M[0] = glm::vec4( cz*cy              ,  sz*cy              , -sy   , 0.0f) * t.scale.x;
+    M[1] = glm::vec4(-sz*cx + cz*sy*sx   ,  cz*cx + sz*sy*sx   ,  cy*sx, 0.0f) * t.scale.y;
+    M[2] = glm::vec4( sz*sx + cz*sy*cx   , -cz*sx + sz*sy*cx   ,  cy*cx, 0.0f) * t.scale.z;
+    M[3] = glm::vec4(t.translation, 1.0f);
+    return M;
+}
+
+static bool SceneGraph_SameTransform(const SceneTransform& a, const SceneTransform& b)
+{
+    return a.translation == b.translation && a.rotation == b.rotation && a.scale == b.scale;
+}
+
+SceneNodeHandle SceneGraph_AddNode(SceneGraph& graph, SceneNodeHandle parent, const SceneTransform& transform)
+{
+    // O pai deve já existir: isto garante que pais aparecem antes dos
+    // filhos nos vetores.
+    assert(parent >= -1 && parent < (SceneNodeHandle)graph.parent.size());
+
+    graph.parent.push_back(parent);
+    graph.transform.push_back(transform);
+    graph.local.push_back(glm::mat4(1.0f));
+    graph.world.push_back(glm::mat4(1.0f));
+    graph.flags.push_back(SCENE_NODE_LOCAL_DIRTY);
+
+    return (SceneNodeHandle)graph.parent.size() - 1;
+}
+
+void SceneGraph_SetTransform(SceneGraph& graph, SceneNodeHandle node, const SceneTransform& transform)
+{
+    if ( SceneGraph_SameTransform(graph.transform[node], transform) )
+        return;
+
+    graph.transform[node] = transform;
+    graph.flags[node] |= SCENE_NODE_LOCAL_DIRTY;
+}
+
+int SceneGraph_Update(SceneGraph& graph)
+{
+    const size_t num_nodes = graph.parent.size();
+    int num_updated = 0;
+
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        const SceneNodeHandle parent = graph.parent[i];
+        const bool parent_updated = parent >= 0 && (graph.flags[parent] & SCENE_NODE_WORLD_UPDATED);
+
+        uint8_t flags = graph.flags[i] & ~SCENE_NODE_WORLD_UPDATED;
+        if ( flags & SCENE_NODE_LOCAL_DIRTY )
+            graph.local[i] = SceneGraph_LocalMatrix(graph.transform[i]);
+
+        if ( (flags & SCENE_NODE_LOCAL_DIRTY) || parent_updated )
+        {
+            graph.world[i] = (parent >= 0) ? graph.world[parent] * graph.local[i] : graph.local[i];
+            flags = SCENE_NODE_WORLD_UPDATED;
+            ++num_updated;
+        }
+
+        graph.flags[i] = flags;
+    }
+
+    return num_updated;
+}
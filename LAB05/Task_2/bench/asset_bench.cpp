@@ -0,0 +1,438 @@
+// Benchmark das etapas de importação de modelos ".obj".
+//
+// Mede separadamente cada etapa executada por main() ao carregar um modelo
+// (veja "objmodel.cpp"):
+//
+//    load     leitura do arquivo pela tinyobjloader (construtor de ObjModel)
+//    normals  ComputeNormals() (nada a fazer se o arquivo já possui normais)
+//    flatten  ObjModel_Flatten(): montagem dos atributos dos vértices
+//    upload   ObjModel_Upload(): envio dos buffers para a GPU (+ glFinish())
+//
+// Para cada etapa são reportados o tempo, a vazão em triângulos/s e em MB/s,
+// o número e o total de bytes de alocações feitas com "new" (o que inclui
+// todos os std::vector da tinyobjloader e do nosso código), e o pico de
+// memória residente (RSS) do processo ao final da etapa. Os bytes da vazão
+// são, para cada etapa: o tamanho do arquivo (load), as posições lidas
+// (normals), e os atributos produzidos (flatten) ou enviados (upload).
+//
+// As entradas são modelos existentes ou malhas sintéticas (grades de
+// triângulos) com o número de triângulos pedido, geradas em arquivos
+// temporários antes das medições:
+//
+//    ./asset_bench [--obj=arquivo.obj]... [--synthetic=triângulos]...
+//                  [--repeat=N] [--no-gl] [--csv]
+//
+// O número de triângulos aceita os sufixos k e M (ex.: --synthetic=50M). Sem
+// nenhuma entrada, são utilizados "../../data/bunny.obj" e malhas sintéticas
+// de 100k e 1M triângulos. O contexto OpenGL é criado com uma janela
+// invisível (como no modo --headless de main()); --no-gl pula a etapa de
+// upload e não utiliza a GLFW, para máquinas sem servidor gráfico.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "objmodel.h"
+
+// ---------------------------------------------------------------------------
+// Contagem de alocações: substituímos os operadores new e delete globais.
+
+static std::atomic<size_t> g_NumAllocations(0);
+static std::atomic<size_t> g_AllocatedBytes(0);
+
+void* operator new(size_t size)
+{
+    g_NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if ( p == NULL )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+// Pico de memória residente do processo, em bytes (zero se desconhecido).
+static size_t PeakResidentBytes()
+{
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss; // Bytes no macOS
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss * 1024; // Kilobytes no Linux
+#else
+    return 0;
+#endif
+}
+
+static double Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+
+enum AssetStage
+{
+    STAGE_LOAD,
+    STAGE_NORMALS,
+    STAGE_FLATTEN,
+    STAGE_UPLOAD,
+    NUM_STAGES
+};
+
+static const char* const g_StageNames[NUM_STAGES] = { "load", "normals", "flatten", "upload" };
+
+struct StageResult
+{
+    double seconds;
+    size_t bytes;           // Bytes processados (veja o início do arquivo)
+    size_t num_allocations;
+    size_t allocated_bytes;
+    size_t peak_rss;
+};
+
+// Mede uma etapa: instantes e contadores de alocação no início e no fim.
+struct StageTimer
+{
+    double start;
+    size_t allocations;
+    size_t allocated;
+
+    StageTimer()
+        : start(Now())
+        , allocations(g_NumAllocations.load())
+        , allocated(g_AllocatedBytes.load())
+    {
+    }
+
+    void Stop(StageResult& result, size_t bytes)
+    {
+        result.seconds = Now() - start;
+        result.bytes = bytes;
+        result.num_allocations = g_NumAllocations.load() - allocations;
+        result.allocated_bytes = g_AllocatedBytes.load() - allocated;
+        result.peak_rss = PeakResidentBytes();
+    }
+};
+
+// Lê o número de triângulos de --synthetic, com sufixos k e M opcionais.
+static size_t ParseTriangleCount(const char* arg, const char* value)
+{
+    char* end = NULL;
+    double count = strtod(value, &end);
+    if ( end != NULL && (*end == 'k' || *end == 'K') )
+    {
+        count *= 1e3;
+        ++end;
+    }
+    else if ( end != NULL && *end == 'M' )
+    {
+        count *= 1e6;
+        ++end;
+    }
+
+    if ( end == value || *end != '\0' || count < 2.0 )
+    {
+        fprintf(stderr, "ERROR: Invalid number of triangles in \"%s\".\n", arg);
+        std::exit(EXIT_FAILURE);
+    }
+    return (size_t)count;
+}
+
+// Escreve uma malha sintética com pelo menos "num_triangles" triângulos: uma
+// grade quadrada ondulada com coordenadas de textura e sem normais (como os
+// modelos da cena, que têm suas normais computadas por ComputeNormals()).
+// Retorna o número de triângulos escritos.
+static size_t WriteSyntheticMesh(const char* filename, size_t num_triangles)
+{
+    size_t side = (size_t)ceil(sqrt(num_triangles / 2.0));
+    FILE* file = fopen(filename, "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write synthetic mesh \"%s\".\n", filename);
+        std::exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "# Malha sintética gerada por asset_bench\no synthetic\n");
+    for (size_t j = 0; j <= side; ++j)
+    {
+        for (size_t i = 0; i <= side; ++i)
+        {
+            float u = (float)i / side;
+            float v = (float)j / side;
+            fprintf(file, "v %.6f %.6f %.6f\n", 2.0f*u - 1.0f, 0.05f * sinf(20.0f*u) * cosf(20.0f*v), 2.0f*v - 1.0f);
+        }
+    }
+    for (size_t j = 0; j <= side; ++j)
+        for (size_t i = 0; i <= side; ++i)
+            fprintf(file, "vt %.6f %.6f\n", (float)i / side, (float)j / side);
+
+    // Índices de OBJ começam em 1. Vértices e coordenadas de textura têm os
+    // mesmos índices.
+    for (size_t j = 0; j < side; ++j)
+    {
+        for (size_t i = 0; i < side; ++i)
+        {
+            unsigned long a = (unsigned long)(j * (side + 1) + i + 1);
+            unsigned long b = a + 1;
+            unsigned long c = a + (unsigned long)(side + 1);
+            unsigned long d = c + 1;
+            fprintf(file, "f %lu/%lu %lu/%lu %lu/%lu\n", a, a, c, c, b, b);
+            fprintf(file, "f %lu/%lu %lu/%lu %lu/%lu\n", b, b, c, c, d, d);
+        }
+    }
+
+    fclose(file);
+    return 2 * side * side;
+}
+
+static size_t FileSize(const char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if ( file == NULL )
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return (size > 0) ? (size_t)size : 0;
+}
+
+// Executa todas as etapas para um arquivo.
+static void RunStages(const char* filename, bool use_gl, StageResult results[NUM_STAGES], size_t& num_triangles)
+{
+    StageTimer timer;
+    ObjModel model(filename);
+    timer.Stop(results[STAGE_LOAD], FileSize(filename));
+
+    num_triangles = 0;
+    for (size_t shape = 0; shape < model.shapes.size(); ++shape)
+        num_triangles += model.shapes[shape].mesh.num_face_vertices.size();
+
+    timer = StageTimer();
+    ComputeNormals(&model);
+    timer.Stop(results[STAGE_NORMALS], model.attrib.vertices.size() * sizeof(float));
+
+    ObjMeshData data;
+    timer = StageTimer();
+    ObjModel_Flatten(&model, data);
+    const size_t mesh_bytes = data.indices.size() * sizeof(GLuint)
+                            + (data.model_coefficients.size() + data.normal_coefficients.size() + data.texture_coefficients.size()) * sizeof(float);
+    timer.Stop(results[STAGE_FLATTEN], mesh_bytes);
+
+    if ( use_gl )
+    {
+        timer = StageTimer();
+        ObjMeshGpu gpu; // Liberado ao sair do escopo
+        ObjModel_Upload(data, gpu);
+        glFinish();
+        timer.Stop(results[STAGE_UPLOAD], mesh_bytes);
+    }
+}
+
+static bool CompareSeconds(const StageResult& a, const StageResult& b)
+{
+    return a.seconds < b.seconds;
+}
+
+struct AssetInput
+{
+    std::string filename;
+    size_t      synthetic_triangles; // Zero para arquivos existentes
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<AssetInput> inputs;
+    int  repeat = 1;
+    bool use_gl = true;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ( strncmp(argv[i], "--obj=", 6) == 0 )
+        {
+            AssetInput input = { argv[i] + 6, 0 };
+            inputs.push_back(input);
+        }
+        else if ( strncmp(argv[i], "--synthetic=", 12) == 0 )
+        {
+            AssetInput input = { "", ParseTriangleCount(argv[i], argv[i] + 12) };
+            inputs.push_back(input);
+        }
+        else if ( strncmp(argv[i], "--repeat=", 9) == 0 )
+        {
+            repeat = atoi(argv[i] + 9);
+            if ( repeat <= 0 )
+            {
+                fprintf(stderr, "ERROR: Invalid number of repetitions \"%s\".\n", argv[i] + 9);
+                return EXIT_FAILURE;
+            }
+        }
+        else if ( strcmp(argv[i], "--no-gl") == 0 )
+            use_gl = false;
+        else if ( strcmp(argv[i], "--csv") == 0 )
+            csv = true;
+        else
+        {
+            fprintf(stderr, "ERROR: Unknown option \"%s\".\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--obj=file.obj]... [--synthetic=triangles]... [--repeat=N] [--no-gl] [--csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ( inputs.empty() )
+    {
+        AssetInput bunny = { "../../data/bunny.obj", 0 };
+        AssetInput small = { "", 100000 };
+        AssetInput large = { "", 1000000 };
+        inputs.push_back(bunny);
+        inputs.push_back(small);
+        inputs.push_back(large);
+    }
+
+    // Contexto OpenGL 3.3 core com uma janela invisível, somente para a
+    // etapa de upload.
+    GLFWwindow* window = NULL;
+    if ( use_gl )
+    {
+        if ( !glfwInit() )
+        {
+            fprintf(stderr, "ERROR: glfwInit() failed (use --no-gl to skip the upload stage).\n");
+            return EXIT_FAILURE;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        #endif
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        window = glfwCreateWindow(64, 64, "asset_bench", NULL, NULL);
+        if ( window == NULL )
+        {
+            glfwTerminate();
+            fprintf(stderr, "ERROR: glfwCreateWindow() failed (use --no-gl to skip the upload stage).\n");
+            return EXIT_FAILURE;
+        }
+        glfwMakeContextCurrent(window);
+        gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+        printf("GPU: %s, %s, OpenGL %s\n", glGetString(GL_VENDOR), glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    }
+
+    std::vector<std::string> report;
+    const int num_stages = use_gl ? NUM_STAGES : STAGE_UPLOAD;
+
+    for (size_t input = 0; input < inputs.size(); ++input)
+    {
+        std::string filename = inputs[input].filename;
+        char name[64];
+        if ( inputs[input].synthetic_triangles > 0 )
+        {
+            snprintf(name, sizeof(name), "asset_bench_synthetic_%lu.obj", (unsigned long)inputs[input].synthetic_triangles);
+            filename = name;
+            printf("Gerando malha sintética \"%s\"... ", name);
+            fflush(stdout);
+            size_t written = WriteSyntheticMesh(name, inputs[input].synthetic_triangles);
+            printf("OK (%lu triângulos).\n", (unsigned long)written);
+            snprintf(name, sizeof(name), "synthetic-%lu", (unsigned long)written);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "%s", filename.c_str());
+        }
+
+        // Cada etapa é repetida "repeat" vezes, e reportamos a repetição com
+        // o tempo mediano.
+        std::vector<StageResult> stage_runs[NUM_STAGES];
+        size_t num_triangles = 0;
+        for (int r = 0; r < repeat; ++r)
+        {
+            StageResult results[NUM_STAGES];
+            memset(results, 0, sizeof(results));
+            RunStages(filename.c_str(), use_gl, results, num_triangles);
+            for (int stage = 0; stage < num_stages; ++stage)
+                stage_runs[stage].push_back(results[stage]);
+        }
+
+        if ( inputs[input].synthetic_triangles > 0 )
+            remove(filename.c_str());
+
+        for (int stage = 0; stage < num_stages; ++stage)
+        {
+            std::vector<StageResult>& runs = stage_runs[stage];
+            std::sort(runs.begin(), runs.end(), CompareSeconds);
+            StageResult result = runs[runs.size() / 2];
+
+            // O pico de memória é do processo inteiro, e só pode crescer:
+            // reportamos o maior valor observado.
+            for (size_t r = 0; r < runs.size(); ++r)
+                result.peak_rss = std::max(result.peak_rss, runs[r].peak_rss);
+
+            const double seconds = std::max(result.seconds, 1e-9);
+            char line[512];
+            if ( csv )
+                snprintf(line, sizeof(line), "%s,%s,%lu,%.6f,%.0f,%.2f,%lu,%lu,%.2f",
+                         name, g_StageNames[stage], (unsigned long)num_triangles, result.seconds,
+                         num_triangles / seconds, result.bytes / seconds / 1e6,
+                         (unsigned long)result.num_allocations, (unsigned long)result.allocated_bytes,
+                         result.peak_rss / 1e6);
+            else
+                snprintf(line, sizeof(line), "%-30s %-8s %12lu %10.2f %12.3f %10.1f %10lu %10.1f %10.1f",
+                         name, g_StageNames[stage], (unsigned long)num_triangles, result.seconds * 1e3,
+                         num_triangles / seconds / 1e6, result.bytes / seconds / 1e6,
+                         (unsigned long)result.num_allocations, result.allocated_bytes / 1e6,
+                         result.peak_rss / 1e6);
+            report.push_back(line);
+        }
+    }
+
+    // A tabela é impressa somente no final, para não se misturar com as
+    // mensagens do carregamento dos modelos.
+    printf("\n");
+    if ( csv )
+        printf("input,stage,triangles,seconds,triangles_per_second,mb_per_second,allocations,allocated_bytes,peak_rss_mb\n");
+    else
+        printf("%-30s %-8s %12s %10s %12s %10s %10s %10s %10s\n",
+               "Input", "Stage", "Triangles", "ms", "Mtri/s", "MB/s", "Allocs", "Alloc MB", "Peak MB");
+    for (size_t i = 0; i < report.size(); ++i)
+        printf("%s\n", report[i].c_str());
+
+    if ( window != NULL )
+    {
+        GpuResources_Shutdown();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,774 @@
+// Microbenchmarks das funções de "matrices.h" e da matemática de câmera e
+// projeção.
+//
+// As funções de "matrices.h" executam para todos os objetos em todos os
+// quadros. Aqui medimos cada uma delas lado a lado com a equivalente da GLM
+// e, onde faz sentido, com uma variante SIMD (SSE) escrita à mão e com os
+// núcleos de "matrixkernels.h", para que a escolha da implementação seja
+// feita com números.
+//
+// O programa não depende da GLFW nem de OpenGL. Execute com:
+//
+//    ./matrices_bench [--filter=texto] [--min-time=segundos] [--csv]
+//
+// Cada benchmark é repetido (BENCH_REPETITIONS vezes) com um número de
+// iterações calibrado para durar pelo menos --min-time segundos (padrão: 0.1),
+// e é reportada a mediana do tempo por operação. Compile com otimizações
+// (ex.: -O2, ou -DCMAKE_BUILD_TYPE=Release): em modo Debug os números não
+// dizem nada sobre o programa final.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "matrices.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BENCH_HAS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define BENCH_REPETITIONS 5
+#define BENCH_NUM_POINTS  4096 // Pontos transformados por iteração nos benchmarks em lote
+#define BENCH_NUM_OBJECTS 1024 // Matrizes/AABBs por iteração nos benchmarks em lote
+#define BENCH_NUM_INPUTS  256  // Tamanho (potência de 2) dos vetores de entrada
+
+// Impede que o compilador elimine o cálculo de "value" por não ser
+// utilizado, sem adicionar nenhuma instrução ao laço medido.
+template <typename T>
+static inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+// Entradas dos benchmarks, preenchidas durante a execução (e não como
+// constantes) para que o compilador não possa pré-calcular os resultados.
+static float     g_Angles[BENCH_NUM_INPUTS];
+static glm::vec4 g_Positions[BENCH_NUM_INPUTS];
+static glm::vec4 g_Points[BENCH_NUM_POINTS];
+static glm::vec4 g_TransformedPoints[BENCH_NUM_POINTS];
+static glm::mat4 g_Models[BENCH_NUM_OBJECTS];
+static glm::mat4 g_ModelViewProjections[BENCH_NUM_OBJECTS];
+static glm::vec3 g_BBoxMin[BENCH_NUM_OBJECTS];
+static glm::vec3 g_BBoxMax[BENCH_NUM_OBJECTS];
+static glm::vec3 g_TransformedBBoxMin[BENCH_NUM_OBJECTS];
+static glm::vec3 g_TransformedBBoxMax[BENCH_NUM_OBJECTS];
+
+static void InitInputs()
+{
+    srand(1);
+    for (int i = 0; i < BENCH_NUM_INPUTS; ++i)
+    {
+        g_Angles[i] = 6.2831853f * rand() / RAND_MAX;
+        g_Positions[i] = glm::vec4(4.0f * rand() / RAND_MAX - 2.0f, 4.0f * rand() / RAND_MAX - 2.0f, 4.0f * rand() / RAND_MAX + 1.0f, 1.0f);
+    }
+    for (int i = 0; i < BENCH_NUM_POINTS; ++i)
+        g_Points[i] = glm::vec4(2.0f * rand() / RAND_MAX - 1.0f, 2.0f * rand() / RAND_MAX - 1.0f, 2.0f * rand() / RAND_MAX - 1.0f, 1.0f);
+    for (int i = 0; i < BENCH_NUM_OBJECTS; ++i)
+    {
+        const glm::vec4& p = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        g_Models[i] = Matrix_Translate(p.x, p.y, p.z) * Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Scale(1.0f, 0.5f + p.z, 2.0f);
+        g_BBoxMin[i] = glm::vec3(p) - glm::vec3(1.0f, 0.5f, 0.25f);
+        g_BBoxMax[i] = glm::vec3(p) + glm::vec3(0.5f, 1.0f, 2.0f);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Variantes SIMD
+
+#ifdef BENCH_HAS_SSE
+// Produto de matrizes r = a*b (column-major): cada coluna do resultado é uma
+// combinação linear das colunas de "a", com os coeficientes da coluna
+// correspondente de "b".
+static inline glm::mat4 MultiplySSE(const glm::mat4& a, const glm::mat4& b)
+{
+    const float* pa = glm::value_ptr(a);
+    const float* pb = glm::value_ptr(b);
+
+    __m128 a0 = _mm_loadu_ps(pa + 0);
+    __m128 a1 = _mm_loadu_ps(pa + 4);
+    __m128 a2 = _mm_loadu_ps(pa + 8);
+    __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    glm::mat4 r;
+    float* pr = glm::value_ptr(r);
+    for (int j = 0; j < 4; ++j)
+    {
+        __m128 c = _mm_mul_ps(a0, _mm_set1_ps(pb[4*j + 0]));
+        c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_set1_ps(pb[4*j + 1])));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_set1_ps(pb[4*j + 2])));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_set1_ps(pb[4*j + 3])));
+        _mm_storeu_ps(pr + 4*j, c);
+    }
+    return r;
+}
+
+// Transforma "count" pontos pela matriz M, com as colunas de M mantidas em
+// registradores durante todo o laço.
+static void TransformPointsSSE(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, int count)
+{
+    const float* pm = glm::value_ptr(M);
+    __m128 c0 = _mm_loadu_ps(pm + 0);
+    __m128 c1 = _mm_loadu_ps(pm + 4);
+    __m128 c2 = _mm_loadu_ps(pm + 8);
+    __m128 c3 = _mm_loadu_ps(pm + 12);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const float* p = glm::value_ptr(in[i]);
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(p[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(p[3])));
+        _mm_storeu_ps(glm::value_ptr(out[i]), r);
+    }
+}
+#endif // BENCH_HAS_SSE
+
+// Matrizes de rotação construídas diretamente em column-major, sem passar
+// pela transposição de Matrix().
+static inline glm::mat4 RotateXDirect(float angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    return glm::mat4(1.0f, 0.0f, 0.0f, 0.0f,
+                     0.0f,    c,    s, 0.0f,
+                     0.0f,   -s,    c, 0.0f,
+                     0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+static inline glm::mat4 RotateYDirect(float angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    return glm::mat4(   c, 0.0f,   -s, 0.0f,
+                     0.0f, 1.0f, 0.0f, 0.0f,
+                        s, 0.0f,    c, 0.0f,
+                     0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+static inline glm::mat4 RotateZDirect(float angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    return glm::mat4(   c,    s, 0.0f, 0.0f,
+                       -s,    c, 0.0f, 0.0f,
+                     0.0f, 0.0f, 1.0f, 0.0f,
+                     0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// Matriz normal de uma matriz afim: a inversa da transposta do bloco 3x3
+// superior. Não inverte a matriz 4x4 inteira como Matrix_Normal(); a última
+// linha e a última coluna, que não afetam vetores normais, ficam como na
+// identidade.
+static inline glm::mat4 NormalMatrixAffine(const glm::mat4& model)
+{
+    return glm::mat4(glm::inverseTranspose(glm::mat3(model)));
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks. Cada função executa "iterations" iterações da operação medida.
+
+// Composição de matrizes de modelagem como a da esfera em BuildFrameSnapshot()
+// ("main.cpp"): translação e três rotações.
+static void Bench_Compose_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float a = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = Matrix_Translate(-1.0f, 0.0f, 0.0f) * Matrix_Rotate_Z(0.6f) * Matrix_Rotate_X(0.2f) * Matrix_Rotate_Y(a);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Compose_Glm(size_t iterations)
+{
+    const glm::mat4 I(1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float a = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = glm::translate(I, glm::vec3(-1.0f, 0.0f, 0.0f));
+        M = glm::rotate(M, 0.6f, glm::vec3(0.0f, 0.0f, 1.0f));
+        M = glm::rotate(M, 0.2f, glm::vec3(1.0f, 0.0f, 0.0f));
+        M = glm::rotate(M, a, glm::vec3(0.0f, 1.0f, 0.0f));
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Compose_Direct(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float a = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 T(1.0f);
+        T[3] = glm::vec4(-1.0f, 0.0f, 0.0f, 1.0f);
+        glm::mat4 M = T * RotateZDirect(0.6f) * RotateXDirect(0.2f) * RotateYDirect(a);
+        DoNotOptimize(M);
+    }
+}
+
+#ifdef BENCH_HAS_SSE
+static void Bench_Compose_SSE(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float a = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 T(1.0f);
+        T[3] = glm::vec4(-1.0f, 0.0f, 0.0f, 1.0f);
+        glm::mat4 M = MultiplySSE(MultiplySSE(MultiplySSE(T, RotateZDirect(0.6f)), RotateXDirect(0.2f)), RotateYDirect(a));
+        DoNotOptimize(M);
+    }
+}
+#endif
+
+static void Bench_Translate_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4& p = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = Matrix_Translate(p.x, p.y, p.z);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Translate_Glm(size_t iterations)
+{
+    const glm::mat4 I(1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4& p = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = glm::translate(I, glm::vec3(p));
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Scale_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4& p = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = Matrix_Scale(p.x, p.y, p.z);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Scale_Glm(size_t iterations)
+{
+    const glm::mat4 I(1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4& p = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = glm::scale(I, glm::vec3(p));
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_RotateY_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_RotateY_Glm(size_t iterations)
+{
+    const glm::mat4 I(1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 M = glm::rotate(I, g_Angles[i & (BENCH_NUM_INPUTS - 1)], glm::vec3(0.0f, 1.0f, 0.0f));
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_RotateY_Direct(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 M = RotateYDirect(g_Angles[i & (BENCH_NUM_INPUTS - 1)]);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Rotate_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4 axis(g_Positions[i & (BENCH_NUM_INPUTS - 1)].x, 1.0f, 0.5f, 0.0f);
+        glm::mat4 M = Matrix_Rotate(g_Angles[i & (BENCH_NUM_INPUTS - 1)], axis);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Rotate_Glm(size_t iterations)
+{
+    const glm::mat4 I(1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec3 axis(g_Positions[i & (BENCH_NUM_INPUTS - 1)].x, 1.0f, 0.5f);
+        glm::mat4 M = glm::rotate(I, g_Angles[i & (BENCH_NUM_INPUTS - 1)], axis);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Multiply_Glm(size_t iterations)
+{
+    glm::mat4 A = Matrix_Rotate_Z(0.6f) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 B = Matrix_Translate(-1.0f, 0.0f, 0.0f);
+        B[0][0] = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = A * B;
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Multiply_Kernels(size_t iterations)
+{
+    glm::mat4 A = Matrix_Rotate_Z(0.6f) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 B = Matrix_Translate(-1.0f, 0.0f, 0.0f);
+        B[0][0] = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = MatrixKernels_Multiply(A, B);
+        DoNotOptimize(M);
+    }
+}
+
+#ifdef BENCH_HAS_SSE
+static void Bench_Multiply_SSE(size_t iterations)
+{
+    glm::mat4 A = Matrix_Rotate_Z(0.6f) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 B = Matrix_Translate(-1.0f, 0.0f, 0.0f);
+        B[0][0] = g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = MultiplySSE(A, B);
+        DoNotOptimize(M);
+    }
+}
+#endif
+
+// Câmera "look-at" como a de main(): a câmera olha para a origem.
+static void Bench_CameraView_Matrices(size_t iterations)
+{
+    const glm::vec4 up(0.0f, 1.0f, 0.0f, 0.0f);
+    const glm::vec4 origin(0.0f, 0.0f, 0.0f, 1.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec4& position = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = Matrix_Camera_View(position, origin - position, up);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_CameraView_Glm(size_t iterations)
+{
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    const glm::vec3 origin(0.0f, 0.0f, 0.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::vec3 position(g_Positions[i & (BENCH_NUM_INPUTS - 1)]);
+        glm::mat4 M = glm::lookAt(position, origin, up);
+        DoNotOptimize(M);
+    }
+}
+
+// Projeção perspectiva com os parâmetros de main(). Note que "matrices.h"
+// recebe os planos near e far como coordenadas z (negativas), enquanto a
+// GLM recebe distâncias (positivas).
+static void Bench_Perspective_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float aspect = 1.0f + g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = Matrix_Perspective(3.141592f / 3.0f, aspect, -0.1f, -10.0f);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_Perspective_Glm(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        float aspect = 1.0f + g_Angles[i & (BENCH_NUM_INPUTS - 1)];
+        glm::mat4 M = glm::perspective(3.141592f / 3.0f, aspect, 0.1f, 10.0f);
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_NormalMatrix_Matrices(size_t iterations)
+{
+    glm::mat4 model = Matrix_Translate(1.0f, 0.0f, 0.0f) * Matrix_Scale(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 M = Matrix_Normal(model * Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]));
+        DoNotOptimize(M);
+    }
+}
+
+static void Bench_NormalMatrix_Affine(size_t iterations)
+{
+    glm::mat4 model = Matrix_Translate(1.0f, 0.0f, 0.0f) * Matrix_Scale(1.0f, 2.0f, 3.0f);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::mat4 M = NormalMatrixAffine(model * Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]));
+        DoNotOptimize(M);
+    }
+}
+
+// dotproduct() testa a coordenada w de ambos os vetores (e encerra o
+// programa se algum deles for um ponto) a cada chamada.
+static void Bench_Dot_Matrices(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::vec4 u = g_Positions[i & (BENCH_NUM_INPUTS - 1)];
+        glm::vec4 v = g_Positions[(i + 1) & (BENCH_NUM_INPUTS - 1)];
+        u.w = 0.0f;
+        v.w = 0.0f;
+        float d = dotproduct(u, v);
+        DoNotOptimize(d);
+    }
+}
+
+static void Bench_Dot_Glm(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        glm::vec3 u(g_Positions[i & (BENCH_NUM_INPUTS - 1)]);
+        glm::vec3 v(g_Positions[(i + 1) & (BENCH_NUM_INPUTS - 1)]);
+        float d = glm::dot(u, v);
+        DoNotOptimize(d);
+    }
+}
+
+// Transformação de BENCH_NUM_POINTS pontos pela mesma matriz.
+static void Bench_TransformPoints_Glm(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+        for (int j = 0; j < BENCH_NUM_POINTS; ++j)
+            g_TransformedPoints[j] = M * g_Points[j];
+        DoNotOptimize(g_TransformedPoints);
+    }
+}
+
+#ifdef BENCH_HAS_SSE
+static void Bench_TransformPoints_SSE(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+        TransformPointsSSE(M, g_Points, g_TransformedPoints, BENCH_NUM_POINTS);
+        DoNotOptimize(g_TransformedPoints);
+    }
+}
+#endif
+
+static void Bench_TransformPoints_Kernels(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+        MatrixKernels_TransformPoints(M, g_Points, g_TransformedPoints, BENCH_NUM_POINTS);
+        DoNotOptimize(g_TransformedPoints);
+    }
+}
+
+// Matrizes "model_view_projection" de BENCH_NUM_OBJECTS objetos, como em
+// DrawScene().
+static void Bench_MultiplyArray_Glm(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 VP = Matrix_Perspective(1.0f, 1.5f, -0.1f, -g_Positions[i & (BENCH_NUM_INPUTS - 1)].x - 10.0f);
+        for (int j = 0; j < BENCH_NUM_OBJECTS; ++j)
+            g_ModelViewProjections[j] = VP * g_Models[j];
+        DoNotOptimize(g_ModelViewProjections);
+    }
+}
+
+static void Bench_MultiplyArray_Kernels(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 VP = Matrix_Perspective(1.0f, 1.5f, -0.1f, -g_Positions[i & (BENCH_NUM_INPUTS - 1)].x - 10.0f);
+        MatrixKernels_MultiplyArray(VP, g_Models, g_ModelViewProjections, BENCH_NUM_OBJECTS);
+        DoNotOptimize(g_ModelViewProjections);
+    }
+}
+
+// AABB que contém os oito vértices transformados de uma AABB.
+static void TransformAABBCorners(const glm::mat4& M, const glm::vec3& bbox_min, const glm::vec3& bbox_max, glm::vec3& out_min, glm::vec3& out_max)
+{
+    for (int k = 0; k < 8; ++k)
+    {
+        const glm::vec4 corner((k & 1) ? bbox_max.x : bbox_min.x, (k & 2) ? bbox_max.y : bbox_min.y, (k & 4) ? bbox_max.z : bbox_min.z, 1.0f);
+        const glm::vec3 p = glm::vec3(M * corner);
+        out_min = (k == 0) ? p : glm::min(out_min, p);
+        out_max = (k == 0) ? p : glm::max(out_max, p);
+    }
+}
+
+static void Bench_TransformAABBs_Glm(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+        for (int j = 0; j < BENCH_NUM_OBJECTS; ++j)
+            TransformAABBCorners(M, g_BBoxMin[j], g_BBoxMax[j], g_TransformedBBoxMin[j], g_TransformedBBoxMax[j]);
+        DoNotOptimize(g_TransformedBBoxMin);
+        DoNotOptimize(g_TransformedBBoxMax);
+    }
+}
+
+static void Bench_TransformAABBs_Kernels(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const glm::mat4 M = Matrix_Rotate_Y(g_Angles[i & (BENCH_NUM_INPUTS - 1)]) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+        MatrixKernels_TransformAABBs(M, g_BBoxMin, g_BBoxMax, g_TransformedBBoxMin, g_TransformedBBoxMax, BENCH_NUM_OBJECTS);
+        DoNotOptimize(g_TransformedBBoxMin);
+        DoNotOptimize(g_TransformedBBoxMax);
+    }
+}
+
+struct Benchmark
+{
+    const char* name;
+    void      (*run)(size_t iterations);
+    int         items; // Itens processados por iteração (para o tempo por item)
+};
+
+static const Benchmark g_Benchmarks[] = {
+    { "Compose/matrices.h",         Bench_Compose_Matrices,      1 },
+    { "Compose/glm",                Bench_Compose_Glm,           1 },
+    { "Compose/direct",             Bench_Compose_Direct,        1 },
+#ifdef BENCH_HAS_SSE
+    { "Compose/sse",                Bench_Compose_SSE,           1 },
+#endif
+    { "Translate/matrices.h",       Bench_Translate_Matrices,    1 },
+    { "Translate/glm",              Bench_Translate_Glm,         1 },
+    { "Scale/matrices.h",           Bench_Scale_Matrices,        1 },
+    { "Scale/glm",                  Bench_Scale_Glm,             1 },
+    { "RotateY/matrices.h",         Bench_RotateY_Matrices,      1 },
+    { "RotateY/glm",                Bench_RotateY_Glm,           1 },
+    { "RotateY/direct",             Bench_RotateY_Direct,        1 },
+    { "RotateAxis/matrices.h",      Bench_Rotate_Matrices,       1 },
+    { "RotateAxis/glm",             Bench_Rotate_Glm,            1 },
+    { "Multiply/glm",               Bench_Multiply_Glm,          1 },
+    { "Multiply/kernels",           Bench_Multiply_Kernels,      1 },
+#ifdef BENCH_HAS_SSE
+    { "Multiply/sse",               Bench_Multiply_SSE,          1 },
+#endif
+    { "CameraView/matrices.h",      Bench_CameraView_Matrices,   1 },
+    { "CameraView/glm",             Bench_CameraView_Glm,        1 },
+    { "Perspective/matrices.h",     Bench_Perspective_Matrices,  1 },
+    { "Perspective/glm",            Bench_Perspective_Glm,       1 },
+    { "NormalMatrix/matrices.h",    Bench_NormalMatrix_Matrices, 1 },
+    { "NormalMatrix/affine",        Bench_NormalMatrix_Affine,   1 },
+    { "Dot/matrices.h",             Bench_Dot_Matrices,          1 },
+    { "Dot/glm",                    Bench_Dot_Glm,               1 },
+    { "TransformPoints/glm",        Bench_TransformPoints_Glm,   BENCH_NUM_POINTS },
+#ifdef BENCH_HAS_SSE
+    { "TransformPoints/sse",        Bench_TransformPoints_SSE,   BENCH_NUM_POINTS },
+#endif
+    { "TransformPoints/kernels",    Bench_TransformPoints_Kernels, BENCH_NUM_POINTS },
+    { "MultiplyArray/glm",          Bench_MultiplyArray_Glm,     BENCH_NUM_OBJECTS },
+    { "MultiplyArray/kernels",      Bench_MultiplyArray_Kernels, BENCH_NUM_OBJECTS },
+    { "TransformAABBs/glm",         Bench_TransformAABBs_Glm,    BENCH_NUM_OBJECTS },
+    { "TransformAABBs/kernels",     Bench_TransformAABBs_Kernels, BENCH_NUM_OBJECTS },
+};
+
+// ---------------------------------------------------------------------------
+// Verificação: as variantes comparadas devem calcular o mesmo resultado.
+
+static bool MatricesMatch(const char* name, const glm::mat4& a, const glm::mat4& b)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            if ( fabsf(a[c][r] - b[c][r]) > 1e-4f * (1.0f + fabsf(a[c][r])) )
+            {
+                fprintf(stderr, "WARNING: %s differs at [%d][%d]: %f != %f.\n", name, c, r, a[c][r], b[c][r]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool CheckEquivalence()
+{
+    bool ok = true;
+    const glm::mat4 I(1.0f);
+    const float a = 0.7f;
+    const glm::vec4 position(1.0f, 2.0f, 3.0f, 1.0f);
+
+    glm::mat4 compose = Matrix_Translate(-1.0f, 0.0f, 0.0f) * Matrix_Rotate_Z(0.6f) * Matrix_Rotate_X(0.2f) * Matrix_Rotate_Y(a);
+    glm::mat4 T(1.0f);
+    T[3] = glm::vec4(-1.0f, 0.0f, 0.0f, 1.0f);
+    ok &= MatricesMatch("Compose/glm", compose,
+        glm::rotate(glm::rotate(glm::rotate(glm::translate(I, glm::vec3(-1.0f, 0.0f, 0.0f)), 0.6f, glm::vec3(0,0,1)), 0.2f, glm::vec3(1,0,0)), a, glm::vec3(0,1,0)));
+    ok &= MatricesMatch("Compose/direct", compose, T * RotateZDirect(0.6f) * RotateXDirect(0.2f) * RotateYDirect(a));
+#ifdef BENCH_HAS_SSE
+    ok &= MatricesMatch("Compose/sse", compose, MultiplySSE(MultiplySSE(MultiplySSE(T, RotateZDirect(0.6f)), RotateXDirect(0.2f)), RotateYDirect(a)));
+#endif
+    ok &= MatricesMatch("RotateAxis/glm", Matrix_Rotate(a, glm::vec4(0.3f, 1.0f, 0.5f, 0.0f)), glm::rotate(I, a, glm::vec3(0.3f, 1.0f, 0.5f)));
+    ok &= MatricesMatch("CameraView/glm",
+        Matrix_Camera_View(position, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) - position, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f)),
+        glm::lookAt(glm::vec3(position), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    ok &= MatricesMatch("Perspective/glm", Matrix_Perspective(3.141592f / 3.0f, 1.5f, -0.1f, -10.0f), glm::perspective(3.141592f / 3.0f, 1.5f, 0.1f, 10.0f));
+
+    glm::mat4 model = Matrix_Translate(1.0f, 0.0f, 0.0f) * Matrix_Scale(1.0f, 2.0f, 3.0f) * Matrix_Rotate_Y(a);
+    // Somente o bloco 3x3 importa: "shader_vertex.glsl" descarta a
+    // coordenada w da normal transformada.
+    ok &= MatricesMatch("NormalMatrix/affine", glm::mat4(glm::mat3(Matrix_Normal(model))), NormalMatrixAffine(model));
+
+    std::vector<glm::vec4> points(g_Points, g_Points + 4);
+    glm::mat4 M = Matrix_Rotate_Y(a) * Matrix_Translate(1.0f, 2.0f, 3.0f);
+#ifdef BENCH_HAS_SSE
+    ok &= MatricesMatch("Multiply/sse", compose * M, MultiplySSE(compose, M));
+
+    glm::vec4 transformed[4];
+    TransformPointsSSE(M, &points[0], transformed, 4);
+    ok &= MatricesMatch("TransformPoints/sse",
+        glm::mat4(M * points[0], M * points[1], M * points[2], M * points[3]),
+        glm::mat4(transformed[0], transformed[1], transformed[2], transformed[3]));
+#endif
+
+    ok &= MatricesMatch("Multiply/kernels", compose * M, MatrixKernels_Multiply(compose, M));
+
+    glm::vec4 kernel_points[4];
+    MatrixKernels_TransformPoints(M, &points[0], kernel_points, 4);
+    ok &= MatricesMatch("TransformPoints/kernels",
+        glm::mat4(M * points[0], M * points[1], M * points[2], M * points[3]),
+        glm::mat4(kernel_points[0], kernel_points[1], kernel_points[2], kernel_points[3]));
+
+    // Número ímpar de matrizes, para exercitar também o final do laço AVX.
+    glm::mat4 products[3];
+    MatrixKernels_MultiplyArray(compose, g_Models, products, 3);
+    for (int j = 0; j < 3; ++j)
+        ok &= MatricesMatch("MultiplyArray/kernels", compose * g_Models[j], products[j]);
+    MatrixKernels_MultiplyArrays(g_Models, g_Models + 1, products, 2);
+    for (int j = 0; j < 2; ++j)
+        ok &= MatricesMatch("MultiplyArrays/kernels", g_Models[j] * g_Models[j + 1], products[j]);
+
+    for (int j = 0; j < 4; ++j)
+    {
+        glm::vec3 expected_min, expected_max, bbox_min, bbox_max;
+        TransformAABBCorners(compose, g_BBoxMin[j], g_BBoxMax[j], expected_min, expected_max);
+        MatrixKernels_TransformAABBs(compose, &g_BBoxMin[j], &g_BBoxMax[j], &bbox_min, &bbox_max, 1);
+        ok &= MatricesMatch("TransformAABBs/kernels",
+            glm::mat4(glm::vec4(expected_min, 0.0f), glm::vec4(expected_max, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f)),
+            glm::mat4(glm::vec4(bbox_min, 0.0f), glm::vec4(bbox_max, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f)));
+    }
+
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+
+static double Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double RunOnce(const Benchmark& benchmark, size_t iterations)
+{
+    double start = Now();
+    benchmark.run(iterations);
+    return Now() - start;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filter = NULL;
+    double      min_time = 0.1;
+    bool        csv = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ( strncmp(argv[i], "--filter=", 9) == 0 )
+            filter = argv[i] + 9;
+        else if ( strncmp(argv[i], "--min-time=", 11) == 0 )
+            min_time = atof(argv[i] + 11);
+        else if ( strcmp(argv[i], "--csv") == 0 )
+            csv = true;
+        else
+        {
+            fprintf(stderr, "ERROR: Unknown option \"%s\".\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--filter=text] [--min-time=seconds] [--csv]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    InitInputs();
+
+    if ( !CheckEquivalence() )
+        fprintf(stderr, "WARNING: Some variants do not compute the same result as matrices.h.\n");
+
+#ifndef BENCH_HAS_SSE
+    fprintf(stderr, "WARNING: SSE not available, SIMD variants skipped.\n");
+#endif
+    if ( !csv )
+        printf("matrixkernels: %s\n", MatrixKernels_InstructionSet());
+
+    if ( csv )
+        printf("name,iterations,ns_per_op,ns_per_item,min_ns_per_op\n");
+    else
+        printf("%-28s %14s %14s %14s\n", "Benchmark", "ns/op", "ns/item", "Iterations");
+
+    const int num_benchmarks = (int)(sizeof(g_Benchmarks) / sizeof(g_Benchmarks[0]));
+    for (int b = 0; b < num_benchmarks; ++b)
+    {
+        const Benchmark& benchmark = g_Benchmarks[b];
+        if ( filter != NULL && strstr(benchmark.name, filter) == NULL )
+            continue;
+
+        // Calibração: dobramos o número de iterações até que uma execução
+        // dure pelo menos min_time, e então estimamos o número de
+        // iterações necessário.
+        size_t iterations = 1;
+        double elapsed = RunOnce(benchmark, iterations);
+        while ( elapsed < min_time / 8.0 && iterations < ((size_t)1 << 40) )
+        {
+            iterations *= 2;
+            elapsed = RunOnce(benchmark, iterations);
+        }
+        if ( elapsed < min_time )
+            iterations = (size_t)(iterations * min_time / std::max(elapsed, 1e-9)) + 1;
+
+        double times[BENCH_REPETITIONS];
+        for (int r = 0; r < BENCH_REPETITIONS; ++r)
+            times[r] = RunOnce(benchmark, iterations) / iterations * 1e9;
+        std::sort(times, times + BENCH_REPETITIONS);
+
+        const double median = times[BENCH_REPETITIONS / 2];
+        if ( csv )
+            printf("%s,%lu,%.3f,%.4f,%.3f\n", benchmark.name, (unsigned long)iterations, median, median / benchmark.items, times[0]);
+        else
+            printf("%-28s %14.2f %14.3f %14lu\n", benchmark.name, median, median / benchmark.items, (unsigned long)iterations);
+        fflush(stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
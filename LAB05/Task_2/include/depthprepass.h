@@ -0,0 +1,55 @@
+#ifndef _DEPTHPREPASS_H
+#define _DEPTHPREPASS_H
+
+// Decisão de quando utilizar uma passada de profundidade ("depth pre-pass")
+// antes da passada de cor. Veja "depthprepass.cpp".
+//
+// Na passada de profundidade a cena é desenhada somente com um programa que
+// calcula a posição dos vértices, sem escrever cor. Em seguida a passada de
+// cor utiliza glDepthFunc(GL_EQUAL), sem escrever profundidade: o fragment
+// shader completo roda uma única vez por pixel, somente para a superfície
+// visível. Em troca, os vértices são processados duas vezes; só vale a pena
+// quando muitos fragmentos são sobrescritos ("overdraw").
+//
+// O overdraw é medido a cada quadro com uma query GL_SAMPLES_PASSED em volta
+// da primeira passada com teste de profundidade (a de profundidade, se
+// utilizada, ou a de cor): o número de amostras que passaram no teste,
+// dividido pelo número de pixels da tela.
+//
+// Uso, a cada quadro:
+//
+//     bool prepass = DepthPrePass_BeginFrame();
+//     DepthPrePass_BeginMeasure();
+//     ... primeira passada com teste de profundidade ...
+//     DepthPrePass_EndMeasure(width, height);
+
+enum DepthPrePassMode
+{
+    DEPTH_PREPASS_AUTO, // Decidida pelo overdraw medido
+    DEPTH_PREPASS_ON,
+    DEPTH_PREPASS_OFF,
+    DEPTH_PREPASS_NUM_MODES
+};
+
+const char* DepthPrePass_ModeName(DepthPrePassMode mode); // "auto", "on" ou "off"
+
+void DepthPrePass_SetMode(DepthPrePassMode mode);
+DepthPrePassMode DepthPrePass_GetMode();
+
+// Lê as medições já disponíveis (sem bloquear) e retorna se o quadro atual
+// deve utilizar a passada de profundidade.
+bool DepthPrePass_BeginFrame();
+
+// Início e fim da medição do overdraw do quadro. "width" e "height" são as
+// dimensões do framebuffer, em pixels.
+void DepthPrePass_BeginMeasure();
+void DepthPrePass_EndMeasure(int width, int height);
+
+// Amostras por pixel que passaram no teste de profundidade (média dos
+// últimos quadros). Zero antes da primeira medição.
+float DepthPrePass_GetOverdraw();
+
+// Deleta as queries. Deve ser chamada com o contexto OpenGL ainda ativo.
+void DepthPrePass_Shutdown();
+
+#endif // _DEPTHPREPASS_H
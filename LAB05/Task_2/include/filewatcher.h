@@ -0,0 +1,14 @@
+#ifndef _FILEWATCHER_H
+#define _FILEWATCHER_H
+
+// Monitoramento de modificações em arquivos, utilizado para recarregar os
+// shaders automaticamente quando estes são editados. Veja "filewatcher.cpp".
+
+// Passa a monitorar o arquivo "filename".
+void FileWatcher_AddFile(const char* filename);
+
+// Retorna true se algum dos arquivos monitorados foi modificado desde a
+// última chamada. Nunca bloqueia; deve ser chamada uma vez por quadro.
+bool FileWatcher_Poll();
+
+#endif // _FILEWATCHER_H
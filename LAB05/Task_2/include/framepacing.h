@@ -0,0 +1,43 @@
+#ifndef _FRAMEPACING_H
+#define _FRAMEPACING_H
+
+// Controle do ritmo de apresentação dos quadros ("frame pacing"): vsync
+// (intervalo de troca de buffers) e limite de quadros por segundo. Veja
+// "framepacing.cpp".
+
+#include <GLFW/glfw3.h>
+
+// Estatísticas dos intervalos entre apresentações de quadros, em
+// milissegundos, sobre os últimos quadros apresentados.
+struct FramePacingStats
+{
+    double average_ms;
+    double min_ms;
+    double max_ms;
+    int    num_samples;
+};
+
+// Define o intervalo de troca de buffers: 0 desliga o vsync, 1 sincroniza
+// cada quadro com o refresh do monitor. Deve ser chamada na thread que
+// possui o contexto OpenGL.
+void FramePacing_SetSwapInterval(int interval);
+int  FramePacing_GetSwapInterval();
+
+// Define o limite de quadros por segundo. Zero remove o limite.
+void FramePacing_SetFrameCap(double max_fps);
+double FramePacing_GetFrameCap();
+
+// Substitui glfwSwapBuffers(): espera até o instante do próximo quadro
+// (caso exista um limite de FPS), troca os buffers e mede o intervalo
+// desde a apresentação anterior.
+void FramePacing_Present(GLFWwindow* window);
+
+// Deve ser chamada quando o loop de renderização deixa de apresentar quadros
+// por um tempo (ex.: esperando por eventos), para que esta pausa não seja
+// contada como um intervalo entre quadros.
+void FramePacing_Idle();
+
+// Retorna as estatísticas dos intervalos medidos por FramePacing_Present().
+FramePacingStats FramePacing_GetStats();
+
+#endif // _FRAMEPACING_H
@@ -0,0 +1,104 @@
+#ifndef _FRAMESYNC_H
+#define _FRAMESYNC_H
+
+// Estruturas de comunicação entre a thread de renderização (thread principal,
+// dona do contexto OpenGL e da janela GLFW) e a thread de simulação. Veja
+// SimulationThread() em "main.cpp".
+//
+// Nenhuma das duas utiliza mutex: cada estrutura tem exatamente um produtor
+// e um consumidor, e a sincronização é feita somente com operações atômicas.
+// Veja https://en.cppreference.com/w/cpp/atomic/memory_order
+
+#include <atomic>
+#include <cstddef>
+
+// Fila circular "single producer, single consumer" (SPSC) de capacidade fixa
+// N (uma potência de dois). Push() só pode ser chamada pela thread produtora,
+// e Pop() só pela thread consumidora.
+template <typename T, size_t N>
+class SpscQueue
+{
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Insere "value" no final da fila. Retorna false (descartando o valor)
+    // se a fila estiver cheia.
+    bool Push(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if ( t - head.load(std::memory_order_acquire) == N )
+            return false;
+
+        items[t & (N - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Remove o primeiro elemento da fila para "value". Retorna false se a
+    // fila estiver vazia.
+    bool Pop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if ( h == tail.load(std::memory_order_acquire) )
+            return false;
+
+        value = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static_assert((N & (N - 1)) == 0, "SpscQueue: N deve ser uma potencia de dois");
+
+    T items[N];
+    std::atomic<size_t> head; // Próximo elemento a ser lido (consumidor)
+    std::atomic<size_t> tail; // Próxima posição a ser escrita (produtor)
+};
+
+// "Triple buffering" de um valor do tipo T entre uma thread escritora e uma
+// leitora. A escritora sempre possui um buffer livre para escrever, e a
+// leitora sempre possui um buffer estável para ler: nenhuma das duas
+// espera pela outra. O terceiro buffer guarda o valor mais recente
+// publicado e ainda não lido; valores intermediários que a leitora não
+// chegou a pegar são simplesmente sobrescritos.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : write_index(0), read_index(1), middle(2) {}
+
+    // Buffer onde a thread escritora monta o próximo valor.
+    T& WriteBuffer() { return buffers[write_index]; }
+
+    // Publica o buffer de escrita, trocando-o pelo buffer do meio.
+    void Publish()
+    {
+        unsigned int previous = middle.exchange(write_index | NEW_DATA, std::memory_order_acq_rel);
+        write_index = previous & ~NEW_DATA;
+    }
+
+    // Se houver um valor publicado ainda não lido, passa a ler dele e
+    // retorna true. Caso contrário, ReadBuffer() continua igual.
+    bool Update()
+    {
+        if ( (middle.load(std::memory_order_relaxed) & NEW_DATA) == 0 )
+            return false;
+
+        unsigned int previous = middle.exchange(read_index, std::memory_order_acq_rel);
+        read_index = previous & ~NEW_DATA;
+        return true;
+    }
+
+    // Buffer com o último valor obtido por Update().
+    const T& ReadBuffer() const { return buffers[read_index]; }
+
+private:
+    static const unsigned int NEW_DATA = 4;
+
+    T buffers[3];
+    unsigned int write_index; // Acessado somente pela escritora
+    unsigned int read_index;  // Acessado somente pela leitora
+    std::atomic<unsigned int> middle; // Índice do buffer do meio, mais o bit NEW_DATA
+};
+
+#endif // _FRAMESYNC_H
@@ -0,0 +1,68 @@
+#ifndef _GLSTATE_H
+#define _GLSTATE_H
+
+// Cópia ("sombra") do estado OpenGL na CPU, para eliminar chamadas
+// redundantes ao driver. Veja "glstate.cpp".
+//
+// As funções GlState_*() abaixo substituem as chamadas OpenGL de mesmo
+// nome: se o valor pedido já é o atual, a chamada não é repassada ao driver.
+// São espelhados o programa em uso, o VAO, os buffers ligados (exceto
+// GL_ELEMENT_ARRAY_BUFFER, que faz parte do estado do VAO), a textura 2D e o
+// sampler de cada unidade de textura, a máscara de cor, e os estados de
+// blending, de profundidade e de culling.
+//
+// Para que a cópia continue correta, o estado espelhado só pode ser
+// alterado através destas funções. Código que o altere diretamente deve
+// restaurá-lo (como GpuResources_Create()) ou chamar GlState_Invalidate().
+// Como não há mais "desligamentos" (ex.: glBindVertexArray(0)) após cada
+// uso, quem depende de um estado deve defini-lo, em vez de supor o padrão.
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "gpuresources.h"
+
+// Número de unidades de textura espelhadas. Unidades acima deste limite são
+// repassadas sempre ao driver.
+#define GL_STATE_MAX_TEXTURE_UNITS 32
+
+// Contadores de chamadas de um quadro.
+struct GlStateStats
+{
+    size_t issued;   // Chamadas repassadas ao driver
+    size_t filtered; // Chamadas eliminadas (o estado já era o pedido)
+};
+
+void GlState_UseProgram(GLuint program);
+void GlState_BindVertexArray(GLuint vertex_array);
+void GlState_BindBuffer(GLenum target, GLuint buffer);
+void GlState_BindTexture(GLuint unit, GLenum target, GLuint texture); // Também seleciona a unidade (glActiveTexture())
+void GlState_BindSampler(GLuint unit, GLuint sampler);
+
+// glEnable()/glDisable(). Espelha GL_BLEND, GL_DEPTH_TEST e GL_CULL_FACE;
+// as demais são sempre repassadas.
+void GlState_SetEnabled(GLenum capability, bool enabled);
+
+void GlState_BlendFunc(GLenum source, GLenum destination);
+void GlState_DepthFunc(GLenum function);
+void GlState_DepthMask(GLboolean mask);
+void GlState_CullFace(GLenum mode);
+void GlState_FrontFace(GLenum mode);
+void GlState_PolygonMode(GLenum mode); // Para GL_FRONT_AND_BACK
+void GlState_ColorMask(bool enabled);  // Os quatro canais juntos
+
+// Esquece todo o estado espelhado: a próxima chamada de cada função é
+// sempre repassada ao driver.
+void GlState_Invalidate();
+
+// Deve ser chamada quando um objeto OpenGL é deletado, já que o OpenGL o
+// desliga automaticamente (e outro objeto pode receber o mesmo nome).
+// Pode ser passada para GpuResources_SetDeleteCallback().
+void GlState_ObjectDeleted(GpuResourceType type, GLuint id);
+
+// Fecha os contadores do quadro atual.
+void GlState_EndFrame();
+GlStateStats GlState_GetFrameStats(); // Contadores do último quadro completo
+
+#endif // _GLSTATE_H
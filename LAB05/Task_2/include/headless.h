@@ -0,0 +1,44 @@
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+
+// Modo de benchmark sem janela visível (opção --headless): a cena é
+// desenhada em um framebuffer offscreen, seguindo um caminho de câmera fixo,
+// e os tempos de cada quadro são escritos em um arquivo JSON. Veja
+// "headless.cpp".
+
+#include <glad/glad.h>
+
+// Framebuffer offscreen onde a cena é desenhada.
+struct HeadlessTarget
+{
+    GLuint framebuffer;
+    GLuint color_renderbuffer;
+    GLuint depth_renderbuffer;
+    int    width;
+    int    height;
+};
+
+// Número de quadros desenhados antes do início das medições, para que a
+// primeira utilização de cada recurso (compilação tardia de shaders pelo
+// driver, upload de texturas, ...) não apareça nos resultados.
+#define HEADLESS_WARMUP_FRAMES 10
+
+// Cria o framebuffer offscreen e o deixa ligado (glBindFramebuffer()).
+// Retorna false em caso de erro.
+bool Headless_CreateTarget(HeadlessTarget& target, int width, int height);
+void Headless_DestroyTarget(HeadlessTarget& target);
+
+// Posição da câmera (em coordenadas esféricas, veja g_CameraTheta em
+// "main.cpp") no quadro "frame" do caminho de "num_frames" quadros.
+void Headless_CameraPath(int frame, int num_frames, float& theta, float& phi, float& distance);
+
+// Escreve em "filename" o resultado do benchmark: os tempos de CPU e GPU de
+// cada quadro registrado pelo profiler (Profiler_StartFrameLog()) e os seus
+// percentis.
+bool Headless_WriteResults(const char* filename, const HeadlessTarget& target);
+
+// Escreve em "filename" a imagem atual do framebuffer offscreen, no formato
+// PPM binário.
+bool Headless_WriteImage(const char* filename, const HeadlessTarget& target);
+
+#endif // _HEADLESS_H
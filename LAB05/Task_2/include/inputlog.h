@@ -0,0 +1,47 @@
+#ifndef _INPUTLOG_H
+#define _INPUTLOG_H
+
+// Gravação e reprodução dos eventos de entrada do usuário e dos instantes de
+// cada quadro desenhado (opções --record e --replay), para que uma execução
+// possa ser repetida exatamente. Veja "inputlog.cpp".
+
+#include <vector>
+
+enum InputLogRecordType
+{
+    INPUT_LOG_FRAME, // Início de um quadro desenhado
+    INPUT_LOG_EVENT  // Evento de entrada (InputEvent, em "main.cpp")
+};
+
+struct InputLogRecord
+{
+    InputLogRecordType type;
+    double time;       // Segundos desde o início da gravação
+    int    event_type; // Campos de InputEvent (somente para INPUT_LOG_EVENT)
+    int    key;
+    int    action;
+    int    mods;
+    double x;
+    double y;
+};
+
+// Inicia a gravação no arquivo "filename". "simulation_start" é o instante
+// inicial do relógio da simulação, em segundos desde o início da gravação,
+// e é guardado no cabeçalho: a reprodução parte dele, de forma que os passos
+// de simulação acontecem nos mesmos instantes da execução gravada. Retorna
+// false em caso de erro.
+bool InputLog_StartRecording(const char* filename, double simulation_start);
+bool InputLog_IsRecording();
+
+// Acrescenta um registro à gravação, se ela estiver ativa. Os registros
+// devem ser gravados em ordem cronológica, sempre pela mesma thread.
+void InputLog_Record(const InputLogRecord& record);
+
+// Termina a gravação, fechando o arquivo.
+void InputLog_StopRecording();
+
+// Lê todos os registros de uma gravação, e o instante inicial da simulação
+// guardado no cabeçalho. Retorna false em caso de erro.
+bool InputLog_Load(const char* filename, std::vector<InputLogRecord>& records, double& simulation_start);
+
+#endif // _INPUTLOG_H
@@ -7,6 +7,10 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+// Produtos de matrizes e transformações em lote (SIMD): veja "matrixkernels.h".
+#include "matrixkernels.h"
 
 // Esta função Matrix() auxilia na criação de matrizes usando a biblioteca GLM.
 // Note que em OpenGL (e GLM) as matrizes são definidas como "column-major",
@@ -26,8 +30,10 @@
 //           coluna 1  coluna 2  coluna 3
 //
 // Para conseguirmos definir matrizes através de suas LINHAS, a função Matrix()
-// computa a transposta usando os elementos passados por parâmetros.
-glm::mat4 Matrix(
+// computa a transposta usando os elementos passados por parâmetros. Note que
+// esta transposta é somente a ordem dos argumentos do construtor de
+// glm::mat4: nenhuma instrução é executada para transpor a matriz.
+inline glm::mat4 Matrix(
     float m00, float m01, float m02, float m03, // LINHA 1
     float m10, float m11, float m12, float m13, // LINHA 2
     float m20, float m21, float m22, float m23, // LINHA 3
@@ -43,7 +49,7 @@ glm::mat4 Matrix(
 }
 
 // Matriz identidade.
-glm::mat4 Matrix_Identity()
+inline glm::mat4 Matrix_Identity()
 {
     return Matrix(
         1.0f , 0.0f , 0.0f , 0.0f , // LINHA 1
@@ -59,7 +65,7 @@ glm::mat4 Matrix_Identity()
 //
 //     T*p = p+t.
 //
-glm::mat4 Matrix_Translate(float tx, float ty, float tz)
+inline glm::mat4 Matrix_Translate(float tx, float ty, float tz)
 {
     return Matrix(
         1.0f , 0.0f , 0.0f , tx ,
@@ -75,7 +81,7 @@ glm::mat4 Matrix_Translate(float tx, float ty, float tz)
 //
 //     S*p = [sx*px, sy*py, sz*pz, pw].
 //
-glm::mat4 Matrix_Scale(float sx, float sy, float sz)
+inline glm::mat4 Matrix_Scale(float sx, float sy, float sz)
 {
     return Matrix(
         sx   , 0.0f , 0.0f , 0.0f ,
@@ -93,7 +99,7 @@ glm::mat4 Matrix_Scale(float sx, float sy, float sz)
 //   R*p = [ px, c*py-s*pz, s*py+c*pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_X(float angle)
+inline glm::mat4 Matrix_Rotate_X(float angle)
 {
     float c = cos(angle);
     float s = sin(angle);
@@ -113,7 +119,7 @@ glm::mat4 Matrix_Rotate_X(float angle)
 //   R*p = [ c*px+s*pz, py, -s*px+c*pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_Y(float angle)
+inline glm::mat4 Matrix_Rotate_Y(float angle)
 {
     float c = cos(angle);
     float s = sin(angle);
@@ -133,7 +139,7 @@ glm::mat4 Matrix_Rotate_Y(float angle)
 //   R*p = [ c*px-s*py, s*px+c*py, pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_Z(float angle)
+inline glm::mat4 Matrix_Rotate_Z(float angle)
 {
     float c = cos(angle);
     float s = sin(angle);
@@ -147,81 +153,62 @@ glm::mat4 Matrix_Rotate_Z(float angle)
 
 // Função que calcula a norma Euclidiana de um vetor cujos coeficientes são
 // definidos em uma base ortonormal qualquer.
-float norm(glm::vec4 v)
+inline float norm(const glm::vec4& v)
 {
-    float vx = v.x;
-    float vy = v.y;
-    float vz = v.z;
-
-    return sqrt( vx*vx + vy*vy + vz*vz );
+    return sqrtf( MatrixKernels_Dot3(v, v) );
 }
 
 // Matriz R de "rotação de um ponto" em relação à origem do sistema de
 // coordenadas e em torno do eixo definido pelo vetor 'axis'. Esta matriz pode
 // ser definida pela fórmula de Rodrigues. Lembre-se que o vetor que define o
 // eixo de rotação deve ser normalizado!
-glm::mat4 Matrix_Rotate(float angle, glm::vec4 axis)
+inline glm::mat4 Matrix_Rotate(float angle, const glm::vec4& axis)
 {
-    float c = cos(angle);
-    float s = sin(angle);
+    float c = cosf(angle);
+    float s = sinf(angle);
 
     glm::vec4 v = axis / norm(axis);
 
-    float vx = v.x;
-    float vy = v.y;
-    float vz = v.z;
-
-    return Matrix(
-        vx*vx*(1.0f-c)+c    , vx*vy*(1.0f-c)-vz*s , vx*vz*(1-c)+vy*s , 0.0f ,
-        vx*vy*(1.0f-c)+vz*s , vy*vy*(1.0f-c)+c    , vy*vz*(1-c)-vx*s , 0.0f ,
-        vx*vz*(1-c)-vy*s    , vy*vz*(1-c)+vx*s    , vz*vz*(1.0f-c)+c , 0.0f ,
-        0.0f                , 0.0f                , 0.0f             , 1.0f
-    );
+    // A matriz é
+    //
+    //   [ vx*vx*(1-c)+c    , vx*vy*(1-c)-vz*s , vx*vz*(1-c)+vy*s , 0 ]
+    //   [ vx*vy*(1-c)+vz*s , vy*vy*(1-c)+c    , vy*vz*(1-c)-vx*s , 0 ]
+    //   [ vx*vz*(1-c)-vy*s , vy*vz*(1-c)+vx*s , vz*vz*(1-c)+c    , 0 ]
+    //   [ 0                , 0                , 0                , 1 ]
+    //
+    // calculada coluna a coluna (veja "matrixkernels.h").
+    return MatrixKernels_Rotate(c, s, v);
 }
 
 // Produto vetorial entre dois vetores u e v definidos em um sistema de
-// coordenadas ortonormal.
-glm::vec4 crossproduct(glm::vec4 u, glm::vec4 v)
+// coordenadas ortonormal. O resultado tem w = 0, já que é um vetor.
+inline glm::vec4 crossproduct(const glm::vec4& u, const glm::vec4& v)
 {
-    float u1 = u.x;
-    float u2 = u.y;
-    float u3 = u.z;
-    float v1 = v.x;
-    float v2 = v.y;
-    float v3 = v.z;
-
-    return glm::vec4(
-        u2*v3 - u3*v2, // Primeiro coeficiente
-        u3*v1 - u1*v3, // Segundo coeficiente
-        u1*v2 - u2*v1, // Terceiro coeficiente
-        0.0f // w = 0 para vetores.
-    );
+    return MatrixKernels_Cross(u, v);
 }
 
-// Produto escalar entre dois vetores u e v definidos em um sistema de
-// coordenadas ortonormal.
-float dotproduct(glm::vec4 u, glm::vec4 v)
+// Encerra o programa se "v" for um ponto (w != 0), para o qual o produto
+// escalar não é definido.
+inline void Matrices_RequireVector(const glm::vec4& v)
 {
-    float u1 = u.x;
-    float u2 = u.y;
-    float u3 = u.z;
-    float u4 = u.w;
-    float v1 = v.x;
-    float v2 = v.y;
-    float v3 = v.z;
-    float v4 = v.w;
-
-    if ( u4 != 0.0f || v4 != 0.0f )
+    if ( v.w != 0.0f )
     {
         fprintf(stderr, "ERROR: Produto escalar não definido para pontos.\n");
         std::exit(EXIT_FAILURE);
     }
+}
 
-    return u1*v1 + u2*v2 + u3*v3;
+// Produto escalar entre dois vetores u e v definidos em um sistema de
+// coordenadas ortonormal.
+inline float dotproduct(const glm::vec4& u, const glm::vec4& v)
+{
+    Matrices_RequireVector(u);
+    Matrices_RequireVector(v);
+    return MatrixKernels_Dot3(u, v);
 }
 
 // Matriz de mudança de coordenadas para o sistema de coordenadas da Câmera.
-glm::mat4 Matrix_Camera_View(glm::vec4 position_c, glm::vec4 view_vector, glm::vec4 up_vector)
+inline glm::mat4 Matrix_Camera_View(const glm::vec4& position_c, const glm::vec4& view_vector, const glm::vec4& up_vector)
 {
     glm::vec4 w = -view_vector;
     glm::vec4 u = crossproduct(up_vector, w);
@@ -233,27 +220,21 @@ glm::mat4 Matrix_Camera_View(glm::vec4 position_c, glm::vec4 view_vector, glm::v
     glm::vec4 v = crossproduct(w,u);
 
     glm::vec4 origin_o = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    Matrices_RequireVector(position_c - origin_o);
 
-    float ux = u.x;
-    float uy = u.y;
-    float uz = u.z;
-    float vx = v.x;
-    float vy = v.y;
-    float vz = v.z;
-    float wx = w.x;
-    float wy = w.y;
-    float wz = w.z;
-
-    return Matrix(
-        ux   , uy   , uz   , -dotproduct(u , position_c - origin_o) ,
-        vx   , vy   , vz   , -dotproduct(v , position_c - origin_o) ,
-        wx   , wy   , wz   , -dotproduct(w , position_c - origin_o) ,
-        0.0f , 0.0f , 0.0f , 1.0f
-    );
+    // A matriz é
+    //
+    //   [ ux , uy , uz , -dotproduct(u , position_c - origin_o) ]
+    //   [ vx , vy , vz , -dotproduct(v , position_c - origin_o) ]
+    //   [ wx , wy , wz , -dotproduct(w , position_c - origin_o) ]
+    //   [ 0  , 0  , 0  , 1                                      ]
+    //
+    // calculada por colunas (veja "matrixkernels.h").
+    return MatrixKernels_ChangeOfBasis(u, v, w, position_c - origin_o);
 }
 
 // Matriz de projeção paralela ortográfica
-glm::mat4 Matrix_Orthographic(float l, float r, float b, float t, float n, float f)
+inline glm::mat4 Matrix_Orthographic(float l, float r, float b, float t, float n, float f)
 {
     glm::mat4 M = Matrix(
         2.0f/(r-l) , 0.0f       , 0.0f       , -(r+l)/(r-l) ,
@@ -266,23 +247,22 @@ glm::mat4 Matrix_Orthographic(float l, float r, float b, float t, float n, float
 }
 
 // Matriz de projeção perspectiva
-glm::mat4 Matrix_Perspective(float field_of_view, float aspect, float n, float f)
+inline glm::mat4 Matrix_Perspective(float field_of_view, float aspect, float n, float f)
 {
     float t = fabs(n) * tanf(field_of_view / 2.0f);
-    float b = -t;
     float r = t * aspect;
-    float l = -r;
-
-    glm::mat4 P = Matrix(
-        n    , 0.0f , 0.0f , 0.0f,
-        0.0f , n    , 0.0f , 0.0f,
-        0.0f , 0.0f , n+f  , -f*n,
-        0.0f , 0.0f , 1.0f , 0.0f
-    );
-
-    // A matriz M é a mesma computada acima em Matrix_Orthographic().
-    glm::mat4 M = Matrix_Orthographic(l, r, b, t, n, f);
 
+    // A matriz abaixo é o produto -M*P, onde
+    //
+    //       [ n 0  0   0  ]
+    //   P = [ 0 n  0   0  ]
+    //       [ 0 0 n+f -f*n]
+    //       [ 0 0  1   0  ]
+    //
+    // e M é a matriz computada em Matrix_Orthographic(l=-r, r, b=-t, t, n, f).
+    // O produto foi expandido simbolicamente para evitar construir as duas
+    // matrizes e multiplicá-las a cada chamada.
+    //
     // Note que as matrizes M*P e -M*P fazem exatamente a mesma projeção
     // perspectiva, já que o sinal de negativo não irá afetar o resultado
     // devido à divisão por w. Por exemplo, seja q = [qx,qy,qz,1] um ponto:
@@ -317,11 +297,24 @@ glm::mat4 Matrix_Perspective(float field_of_view, float aspect, float n, float f
     // precisamos utilizar a matriz -M*P para projeção perspectiva, de forma que
     // w seja positivo.
     //
-    return -M*P;
+    return Matrix(
+        -n/r , 0.0f , 0.0f             , 0.0f            ,
+        0.0f , -n/t , 0.0f             , 0.0f            ,
+        0.0f , 0.0f , -(n+f)/(f-n)     , 2.0f*f*n/(f-n)  ,
+        0.0f , 0.0f , -1.0f            , 0.0f
+    );
+}
+
+// Matriz utilizada para transformar vetores normais de coordenadas locais do
+// modelo para coordenadas globais: a inversa da transposta da matriz de
+// modelagem. Veja slides 123-151 do documento Aula_07_Transformacoes_Geometricas_3D.pdf.
+inline glm::mat4 Matrix_Normal(glm::mat4 model)
+{
+    return glm::inverseTranspose(model);
 }
 
 // Função que imprime uma matriz M no terminal
-void PrintMatrix(glm::mat4 M)
+inline void PrintMatrix(glm::mat4 M)
 {
     printf("\n");
     printf("[ %+0.2f  %+0.2f  %+0.2f  %+0.2f ]\n", M[0][0], M[1][0], M[2][0], M[3][0]);
@@ -331,7 +324,7 @@ void PrintMatrix(glm::mat4 M)
 }
 
 // Função que imprime um vetor v no terminal
-void PrintVector(glm::vec4 v)
+inline void PrintVector(glm::vec4 v)
 {
     printf("\n");
     printf("[ %+0.2f ]\n", v[0]);
@@ -341,7 +334,7 @@ void PrintVector(glm::vec4 v)
 }
 
 // Função que imprime o produto de uma matriz por um vetor no terminal
-void PrintMatrixVectorProduct(glm::mat4 M, glm::vec4 v)
+inline void PrintMatrixVectorProduct(glm::mat4 M, glm::vec4 v)
 {
     auto r = M*v;
     printf("\n");
@@ -353,7 +346,7 @@ void PrintMatrixVectorProduct(glm::mat4 M, glm::vec4 v)
 
 // Função que imprime o produto de uma matriz por um vetor, junto com divisão
 // por w, no terminal.
-void PrintMatrixVectorProductDivW(glm::mat4 M, glm::vec4 v)
+inline void PrintMatrixVectorProductDivW(glm::mat4 M, glm::vec4 v)
 {
     auto r = M*v;
     auto w = r[3];
@@ -0,0 +1,152 @@
+#ifndef _MATRIXKERNELS_H
+#define _MATRIXKERNELS_H
+
+// Núcleos vetorizados (SIMD) de álgebra linear utilizados por "matrices.h":
+// produto de matrizes, produto matriz-vetor e versões em lote destes, que
+// processam vetores inteiros de pontos, bounding boxes ou matrizes em um
+// único laço. Veja "matrixkernels.cpp".
+//
+// O conjunto de instruções é escolhido em tempo de compilação: AVX (com FMA,
+// se disponível) quando o compilador o habilita (ex.: -mavx2 -mfma, passados
+// pela opção MATRIX_KERNELS_AVX2 do CMakeLists.txt e dos Makefiles, ou
+// -march=native), SSE em qualquer processador x86-64, e código escalar nos
+// demais casos. Defina MATRIX_KERNELS_SCALAR para forçar o código escalar.
+
+#include <cstddef>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#if !defined(MATRIX_KERNELS_SCALAR)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATRIX_KERNELS_SSE 1
+#include <xmmintrin.h>
+#endif
+#if defined(MATRIX_KERNELS_SSE) && defined(__AVX__)
+#define MATRIX_KERNELS_AVX 1
+#include <immintrin.h>
+#endif
+#endif
+
+// Produto de matrizes a*b. As matrizes são column-major (como em OpenGL e
+// GLM): cada coluna do resultado é a combinação linear das colunas de "a"
+// com os coeficientes da coluna correspondente de "b".
+inline glm::mat4 MatrixKernels_Multiply(const glm::mat4& a, const glm::mat4& b)
+{
+    glm::mat4 r;
+#ifdef MATRIX_KERNELS_SSE
+    const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+    for (int j = 0; j < 4; ++j)
+    {
+        __m128 c = _mm_mul_ps(a0, _mm_set1_ps(b[j][0]));
+        c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_set1_ps(b[j][1])));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_set1_ps(b[j][2])));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_set1_ps(b[j][3])));
+        _mm_storeu_ps(&r[j][0], c);
+    }
+#else
+    for (int j = 0; j < 4; ++j)
+        r[j] = a[0] * b[j][0] + a[1] * b[j][1] + a[2] * b[j][2] + a[3] * b[j][3];
+#endif
+    return r;
+}
+
+// Produto matriz-vetor m*v.
+inline glm::vec4 MatrixKernels_Transform(const glm::mat4& m, const glm::vec4& v)
+{
+#ifdef MATRIX_KERNELS_SSE
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0][0]), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[1][0]), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[2][0]), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[3][0]), _mm_set1_ps(v.w)));
+    glm::vec4 result;
+    _mm_storeu_ps(&result[0], r);
+    return result;
+#else
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+#endif
+}
+
+// Produto escalar e produto vetorial das coordenadas x, y e z de "u" e "v"
+// (a coordenada w é ignorada; o produto vetorial tem w = 0). Estes, e
+// MatrixKernels_ChangeOfBasis() abaixo, ficam em código escalar: os vetores
+// de entrada vêm de operações escalares da GLM, e carregá-los em
+// registradores SSE (e somar na horizontal) custa mais que as poucas
+// multiplicações. Medido em bench/matrices_bench.cpp (Dot e CameraView): o
+// SSE deixava CameraView duas vezes mais lento.
+inline float MatrixKernels_Dot3(const glm::vec4& u, const glm::vec4& v)
+{
+    return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+inline glm::vec4 MatrixKernels_Cross(const glm::vec4& u, const glm::vec4& v)
+{
+    return glm::vec4(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x, 0.0f);
+}
+
+// Matriz de rotação em torno do eixo "axis" (normalizado), dados o cosseno
+// "c" e o seno "s" do ângulo, pela fórmula de Rodrigues escrita por colunas:
+//
+//   R*e_j = c*e_j + s*(axis x e_j) + (1-c)*axis_j*axis
+//
+inline glm::mat4 MatrixKernels_Rotate(float c, float s, const glm::vec4& axis)
+{
+    glm::mat4 r;
+#ifdef MATRIX_KERNELS_SSE
+    const __m128 k = _mm_mul_ps(_mm_setr_ps(axis.x, axis.y, axis.z, 0.0f), _mm_set1_ps(1.0f - c));
+    const float x = axis.x * s;
+    const float y = axis.y * s;
+    const float z = axis.z * s;
+    _mm_storeu_ps(&r[0][0], _mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(axis.x)), _mm_setr_ps(c, z, -y, 0.0f)));
+    _mm_storeu_ps(&r[1][0], _mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(axis.y)), _mm_setr_ps(-z, c, x, 0.0f)));
+    _mm_storeu_ps(&r[2][0], _mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(axis.z)), _mm_setr_ps(y, -x, c, 0.0f)));
+#else
+    const glm::vec4 k = glm::vec4(axis.x, axis.y, axis.z, 0.0f) * (1.0f - c);
+    r[0] = k * axis.x + glm::vec4(c, axis.z * s, -axis.y * s, 0.0f);
+    r[1] = k * axis.y + glm::vec4(-axis.z * s, c, axis.x * s, 0.0f);
+    r[2] = k * axis.z + glm::vec4(axis.y * s, -axis.x * s, c, 0.0f);
+#endif
+    r[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return r;
+}
+
+// Matriz de mudança de coordenadas para o sistema com base ortonormal
+// {u, v, w} e origem "origin": as linhas do bloco 3x3 são u, v e w, e a
+// translação é -[u.o, v.o, w.o], onde o = origin - [0,0,0,1]. As bases são
+// vetores (w = 0).
+inline glm::mat4 MatrixKernels_ChangeOfBasis(const glm::vec4& u, const glm::vec4& v, const glm::vec4& w, const glm::vec4& origin)
+{
+    // As colunas do bloco 3x3 são a transposta de [u v w], e a translação é
+    // a combinação delas pelas coordenadas da origem.
+    glm::mat4 r;
+    r[0] = glm::vec4(u.x, v.x, w.x, 0.0f);
+    r[1] = glm::vec4(u.y, v.y, w.y, 0.0f);
+    r[2] = glm::vec4(u.z, v.z, w.z, 0.0f);
+    r[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) - (r[0] * origin.x + r[1] * origin.y + r[2] * origin.z);
+    return r;
+}
+
+// Transforma "count" pontos (ou vetores) pela matriz "m": out[i] = m*points[i].
+// "out" pode ser igual a "points".
+void MatrixKernels_TransformPoints(const glm::mat4& m, const glm::vec4* points, glm::vec4* out, size_t count);
+
+// Transforma "count" axis-aligned bounding boxes pela matriz afim "m",
+// retornando as AABBs (em coordenadas transformadas) que as contêm.
+void MatrixKernels_TransformAABBs(const glm::mat4& m, const glm::vec3* bbox_min, const glm::vec3* bbox_max, glm::vec3* out_min, glm::vec3* out_max, size_t count);
+
+// Produto de uma matriz por um vetor de matrizes: out[i] = a*b[i]. Ex.: as
+// matrizes "model_view_projection" de todos os objetos de um quadro.
+void MatrixKernels_MultiplyArray(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, size_t count);
+
+// Produtos par a par de dois vetores de matrizes: out[i] = a[i]*b[i].
+void MatrixKernels_MultiplyArrays(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count);
+
+// Nome do conjunto de instruções utilizado ("avx", "avx+fma", "sse" ou
+// "scalar").
+const char* MatrixKernels_InstructionSet();
+
+#endif // _MATRIXKERNELS_H
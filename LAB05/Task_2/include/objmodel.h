@@ -0,0 +1,76 @@
+#ifndef _OBJMODEL_H
+#define _OBJMODEL_H
+
+// Carregamento de modelos geométricos a partir de arquivos ".obj" e
+// conversão para os buffers de vértices utilizados na renderização. Veja
+// "objmodel.cpp".
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+#include <tiny_obj_loader.h>
+
+#include "gpuresources.h"
+#include "meshindices.h"
+
+// Estrutura que representa um modelo geométrico carregado a partir de um
+// arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
+struct ObjModel
+{
+    tinyobj::attrib_t                 attrib;
+    std::vector<tinyobj::shape_t>     shapes;
+    std::vector<tinyobj::material_t>  materials;
+    std::string                       basepath; // Diretório de onde são carregados arquivos MTL e texturas
+
+    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
+    // Veja: https://github.com/syoyo/tinyobjloader
+    ObjModel(const char* filename, const char* basepath = NULL, bool triangulate = true);
+};
+
+// Intervalo de índices e bounding box de cada objeto ("shape") de um modelo.
+struct ObjShapeRange
+{
+    size_t    first_index;
+    size_t    num_indices;
+    glm::vec3 bbox_min;
+    glm::vec3 bbox_max;
+};
+
+// Atributos dos vértices de um ObjModel em vetores contíguos, prontos para
+// serem enviados à GPU. Cada vértice de cada triângulo aparece uma vez (não
+// há compartilhamento de vértices entre triângulos).
+struct ObjMeshData
+{
+    std::vector<GLuint>        indices;
+    std::vector<float>         model_coefficients;   // vec4 por vértice
+    std::vector<float>         normal_coefficients;  // vec4 por vértice (vazio se o modelo não possuir normais)
+    std::vector<float>         texture_coefficients; // vec2 por vértice (vazio se o modelo não possuir coordenadas de textura)
+    std::vector<ObjShapeRange> shapes;               // Um para cada shape do modelo, na mesma ordem
+};
+
+// Computa normais de um ObjModel, caso não existam.
+void ComputeNormals(ObjModel* model);
+
+// Monta os atributos dos vértices de todos os objetos do modelo.
+void ObjModel_Flatten(const ObjModel* model, ObjMeshData& data);
+
+// Objetos OpenGL de um modelo enviado à GPU. Os buffers de normais e de
+// coordenadas de textura ficam vazios (id == 0) se ObjMeshData não os
+// possuir. Todos são liberados quando a estrutura é destruída.
+struct ObjMeshGpu
+{
+    GpuVertexArray vertex_array;
+    GpuBuffer      model_coefficients;
+    GpuBuffer      normal_coefficients;
+    GpuBuffer      texture_coefficients;
+    GpuBuffer      indices;
+    std::vector<MeshIndexRange> shape_indices; // Índices de cada shape, no menor tipo possível (veja "meshindices.h")
+};
+
+// Cria um VAO com os buffers de "data", nas localizações de atributos
+// utilizadas por "shader_vertex.glsl", guardando-os em "gpu".
+void ObjModel_Upload(const ObjMeshData& data, ObjMeshGpu& gpu);
+
+#endif // _OBJMODEL_H
@@ -0,0 +1,70 @@
+#ifndef _PROCEDURALMESH_H
+#define _PROCEDURALMESH_H
+
+// Malhas geradas proceduralmente (disco, anel, cubo, esferas, grade e
+// cilindro) em vários níveis de detalhe ("level of detail", LOD). Veja
+// "proceduralmesh.cpp".
+//
+// Cada malha é escrita no mesmo formato de vértices dos modelos ".obj"
+// (ObjMeshData), e portanto é enviada à GPU por ObjModel_Upload() e
+// desenhada pelos mesmos shaders. As malhas geradas são guardadas em um
+// cache indexado por (forma, nível): pedir a mesma malha novamente não a
+// reconstrói.
+//
+// Todas as formas cabem no cubo [-1,1]^3, centradas na origem. O disco, o
+// anel e a grade ficam no plano XZ, virados para +Y; o eixo do cilindro é o
+// eixo Y.
+//
+// Os programas do LAB01 (círculos, leques, faixas e dígitos) continuam
+// construindo suas malhas à mão: são executáveis independentes, sem GLM nem
+// ObjMeshData, com vértices 2D em NDC e uma cor por vértice. Além disso, o
+// objetivo daqueles exercícios é justamente montar GL_TRIANGLE_FAN e
+// GL_TRIANGLE_STRIP, enquanto este gerador só produz listas indexadas de
+// triângulos (GL_TRIANGLES), e os dígitos são glifos, e não formas
+// geométricas deste gerador.
+
+#include "objmodel.h"
+
+enum ProceduralShape
+{
+    PROCEDURAL_DISK,
+    PROCEDURAL_RING,
+    PROCEDURAL_BOX,
+    PROCEDURAL_UV_SPHERE,
+    PROCEDURAL_ICOSPHERE,
+    PROCEDURAL_PLANE_GRID,
+    PROCEDURAL_CYLINDER,
+    PROCEDURAL_NUM_SHAPES
+};
+
+// Os níveis vão de 0 (mais grosseiro) até PROCEDURAL_NUM_LEVELS-1 (mais
+// fino). Formas curvas utilizam 8<<nível segmentos ao redor do eixo (a
+// icosfera, "nível" subdivisões do icosaedro); formas planas utilizam
+// 1<<nível divisões por lado.
+#define PROCEDURAL_NUM_LEVELS 6
+
+const char* ProceduralMesh_Name(ProceduralShape shape);
+
+// Gera a malha, sem utilizar o cache.
+void ProceduralMesh_Build(ProceduralShape shape, int level, ObjMeshData& data);
+
+// Retorna a malha do cache, gerando-a na primeira chamada.
+const ObjMeshData& ProceduralMesh_Get(ProceduralShape shape, int level);
+
+// Adiciona a "data" as malhas dos níveis [first_level, last_level], uma
+// ObjShapeRange por nível, para que todos os níveis compartilhem um único VAO.
+void ProceduralMesh_AppendLevels(ProceduralShape shape, int first_level, int last_level, ObjMeshData& data);
+
+// Maior distância entre a malha do nível dado e a superfície exata, para a
+// forma de tamanho unitário (raio 1). Zero para formas sem curvatura.
+float ProceduralMesh_Error(ProceduralShape shape, int level);
+
+// Nível mais grosseiro cujo erro, multiplicado por "error_scale" (ex.: a
+// escala do objeto vezes pixels por unidade na sua distância), não excede
+// "max_error". Se nenhum nível atender ao limite, retorna o mais fino.
+int ProceduralMesh_SelectLevel(ProceduralShape shape, float error_scale, float max_error);
+
+// Descarta as malhas guardadas no cache.
+void ProceduralMesh_ClearCache();
+
+#endif // _PROCEDURALMESH_H
@@ -0,0 +1,88 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+// Profiler de quadros: mede o tempo de CPU e de GPU de cada etapa ("pass")
+// do quadro, e mantém um histórico recente para o cálculo de percentis.
+// Veja "profiler.cpp".
+
+// Percentis (em milissegundos) de um histórico de medições.
+struct ProfilerStats
+{
+    double p50;
+    double p95;
+    double p99;
+    double average;
+    double max;
+    int    num_samples;
+};
+
+// Número máximo de etapas e de medições guardadas no histórico de cada uma.
+#define PROFILER_MAX_PASSES  16
+#define PROFILER_HISTORY     240
+
+// Registra uma etapa com nome "name" e retorna seu identificador. Se "gpu"
+// for true, o tempo de GPU da etapa também é medido, com queries
+// GL_TIMESTAMP. Deve ser chamada após a criação do contexto OpenGL.
+int Profiler_RegisterPass(const char* name, bool gpu);
+
+// Delimitam um quadro. Profiler_EndFrame() deve ser chamada após a troca de
+// buffers; é nela que os resultados das queries de quadros anteriores são
+// lidos (somente os que já estão disponíveis: a CPU nunca espera pela GPU).
+void Profiler_BeginFrame();
+void Profiler_EndFrame();
+
+// Delimitam uma etapa, dentro de um quadro. Podem ser aninhadas.
+void Profiler_BeginPass(int pass);
+void Profiler_EndPass(int pass);
+
+// Estatísticas das medições recentes.
+int         Profiler_GetNumPasses();
+const char* Profiler_GetPassName(int pass);
+bool        Profiler_PassHasGpuTime(int pass);
+ProfilerStats Profiler_GetCpuStats(int pass);
+ProfilerStats Profiler_GetGpuStats(int pass);
+ProfilerStats Profiler_GetFrameStats(); // Tempo de CPU do quadro inteiro
+
+// Copia para "milliseconds" o histórico do tempo de CPU dos quadros, do mais
+// antigo para o mais recente. Retorna o número de valores copiados.
+int Profiler_GetFrameHistory(float* milliseconds, int max_count);
+
+// Calcula os percentis de "count" medições quaisquer (em milissegundos).
+ProfilerStats Profiler_ComputeStats(const float* milliseconds, int count);
+
+// Registro completo das medições de cada quadro, sem o limite do histórico,
+// utilizado pelo modo de benchmark sem janela (veja "headless.cpp").
+struct ProfilerFrameRecord
+{
+    float frame_ms;                    // Tempo de CPU do quadro inteiro
+    float cpu_ms[PROFILER_MAX_PASSES]; // Tempo de CPU de cada etapa
+    float gpu_ms[PROFILER_MAX_PASSES]; // Tempo de GPU de cada etapa (negativo se não medido)
+};
+
+// Inicia o registro dos quadros, descartando o registro anterior. Deve ser
+// chamada entre dois quadros.
+void Profiler_StartFrameLog();
+
+// Encerra o registro. Espera (glFinish()) pelos resultados das queries
+// ainda pendentes, de forma que todos os quadros registrados tenham o seu
+// tempo de GPU.
+void Profiler_StopFrameLog();
+
+int Profiler_GetFrameLogSize();
+const ProfilerFrameRecord& Profiler_GetFrameLogRecord(int frame);
+
+// Mede o tempo da etapa "pass" durante o escopo C++ onde for declarada:
+//
+//    {
+//        ProfilerScope scope(scene_pass);
+//        ... desenho da cena ...
+//    }
+struct ProfilerScope
+{
+    explicit ProfilerScope(int pass) : pass(pass) { Profiler_BeginPass(pass); }
+    ~ProfilerScope() { Profiler_EndPass(pass); }
+
+    int pass;
+};
+
+#endif // _PROFILER_H
@@ -0,0 +1,33 @@
+#ifndef _PROGRAMCACHE_H
+#define _PROGRAMCACHE_H
+
+// Cache em disco de programas de GPU já linkados ("program binaries"). Veja
+// "programcache.cpp".
+
+#include <string>
+
+#include <glad/glad.h>
+
+// Inicializa o cache, que guardará os arquivos no diretório "directory".
+// Deve ser chamada após a criação do contexto OpenGL. Se o driver não
+// suportar program binaries, o cache fica desabilitado e as funções abaixo
+// não fazem nada.
+void ProgramCache_Init(const char* directory);
+
+// Retorna true se o cache está habilitado.
+bool ProgramCache_IsEnabled();
+
+// Cria um programa de GPU a partir do binário guardado para este par de
+// shaders (código-fonte completo, já incluindo os #defines). Retorna 0 se
+// não existe binário no cache ou se o driver o rejeitou; neste caso, o
+// programa deve ser compilado a partir do código-fonte.
+GLuint ProgramCache_Load(const std::string& vertex_source, const std::string& fragment_source);
+
+// Deve ser chamada antes de glLinkProgram() para que o driver mantenha o
+// binário do programa disponível para ProgramCache_Store().
+void ProgramCache_PrepareForLink(GLuint program_id);
+
+// Guarda no cache o binário de um programa já linkado com sucesso.
+void ProgramCache_Store(GLuint program_id, const std::string& vertex_source, const std::string& fragment_source);
+
+#endif // _PROGRAMCACHE_H
@@ -0,0 +1,89 @@
+#ifndef _SHADERPROGRAM_H
+#define _SHADERPROGRAM_H
+
+// Reflexão das variáveis "uniform" e dos atributos de um programa de GPU, e
+// envio de valores "uniform" somente quando estes mudam. Veja
+// "shaderprogram.cpp".
+//
+// ShaderProgram_Reflect() lista as variáveis ativas do programa (isto é,
+// que o compilador GLSL não removeu) com glGetActiveUniform() e
+// glGetActiveAttrib(). As variáveis são acessadas por um "handle" obtido com
+// ShaderProgram_Uniform(), e os valores são escritos com
+// ShaderProgram_Set*(): uma cópia do último valor escrito em cada variável é
+// mantida na CPU, e a chamada glUniform*() só é feita se o valor mudou.
+//
+// Como os valores "uniform" fazem parte do estado do programa, a cópia
+// continua válida quando outro programa é utilizado. As funções
+// ShaderProgram_Set*() escrevem no programa em uso: o chamador deve tê-lo
+// ligado antes (ex.: GlState_UseProgram(program.program_id)).
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Handle de uma variável que nunca foi buscada. Escritas são ignoradas.
+#define SHADER_UNIFORM_NONE -1
+
+struct ShaderUniform
+{
+    std::string name;         // Sem o sufixo "[0]" de arrays
+    GLint       location;     // -1 se a variável não está ativa no programa
+    GLenum      type;         // Ex.: GL_FLOAT_VEC4, GL_SAMPLER_2D
+    GLint       size;         // Número de elementos (1 se não for array)
+    size_t      value_offset; // Posição do valor em ShaderProgram::values
+    size_t      value_size;   // Bytes de um elemento
+    size_t      known_count;  // Elementos cujo valor na GPU é conhecido
+    bool        required;     // Avisar se valores forem escritos e a variável não estiver ativa
+    bool        warned;
+};
+
+struct ShaderAttribute
+{
+    std::string name;
+    GLint       location;
+    GLenum      type;
+    GLint       size;
+};
+
+struct ShaderProgram
+{
+    GLuint                       program_id;
+    std::string                  label;      // Identifica o programa nos avisos
+    std::vector<ShaderUniform>   uniforms;   // Ativas, seguidas das buscadas mas inativas
+    std::vector<ShaderAttribute> attributes;
+    std::vector<unsigned char>   values;     // Cópia dos valores enviados
+};
+
+// Contadores de escritas de um quadro, somando todos os programas.
+struct ShaderUniformStats
+{
+    size_t issued;   // glUniform*() chamadas
+    size_t filtered; // Escritas eliminadas (o valor não mudou)
+};
+
+// Lista as variáveis "uniform" (fora de blocos) e os atributos ativos do
+// programa "program_id", já linkado. Nenhum valor é considerado conhecido.
+void ShaderProgram_Reflect(ShaderProgram& program, GLuint program_id, const char* label);
+
+// Retorna o handle da variável "name". Se ela não estiver ativa no programa
+// (não declarada, ou removida pelo compilador por não ser utilizada), o
+// handle ainda é válido, mas escritas nele são ignoradas; se "required" for
+// true, a primeira escrita imprime um aviso.
+int ShaderProgram_Uniform(ShaderProgram& program, const char* name, bool required = true);
+
+// Localização do atributo "name", ou -1 se ele não estiver ativo.
+GLint ShaderProgram_AttributeLocation(const ShaderProgram& program, const char* name);
+
+void ShaderProgram_Set1i(ShaderProgram& program, int uniform, GLint value);
+void ShaderProgram_Set1f(ShaderProgram& program, int uniform, GLfloat value);
+void ShaderProgram_Set3fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value);
+void ShaderProgram_Set4fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value);
+void ShaderProgram_SetMatrix4fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value);
+
+// Fecha os contadores do quadro atual.
+void ShaderProgram_EndFrame();
+ShaderUniformStats ShaderProgram_GetFrameStats(); // Contadores do último quadro completo
+
+#endif // _SHADERPROGRAM_H
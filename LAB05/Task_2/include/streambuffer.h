@@ -0,0 +1,118 @@
+#ifndef _STREAMBUFFER_H
+#define _STREAMBUFFER_H
+
+// Alocador de geometria dinâmica ("streaming"): dados reescritos a cada
+// quadro (texto, gráficos, linhas de debug) são escritos em sub-alocações
+// de um buffer grande, utilizado como anel. Veja "streambuffer.cpp".
+//
+// Reescrever um buffer que a GPU ainda pode estar lendo (ex.: um
+// glBufferSubData() por caractere no mesmo VBO) obriga o driver a esperar a
+// GPU, ou a copiar os dados. Aqui cada alocação ocupa uma região nova do
+// anel, e uma região só é reutilizada depois que a GPU terminou os comandos
+// que a leem.
+//
+// Uso:
+//
+//     size_t offset;
+//     float* vertices = (float*)StreamBuffer_Allocate(stream, bytes, 16, offset);
+//     ... escreve os vértices ...
+//     StreamBuffer_Commit(stream);
+//     glDrawArrays(GL_TRIANGLES, offset / 16, count); // VAO apontando para stream.buffer
+//     ...
+//     StreamBuffer_EndFrame(stream); // Uma vez por quadro, após os desenhos
+//
+// Os dados de uma alocação podem ser utilizados pelos comandos enviados até
+// a próxima chamada de StreamBuffer_EndFrame().
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gpuresources.h"
+
+enum StreamBufferMode
+{
+    // glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT) de cada região, com um
+    // "fence" (glFenceSync()) por quadro indicando quando a GPU terminou de
+    // ler as regiões daquele quadro.
+    STREAM_BUFFER_MAP,
+
+    // Os dados são copiados com glBufferSubData() para regiões nunca lidas
+    // pela GPU; quando o anel enche, o buffer é "órfão" (glBufferData()
+    // com NULL) e o driver fornece uma nova memória, sem esperar a GPU.
+    // Útil em drivers onde mapear buffers é lento.
+    STREAM_BUFFER_ORPHAN
+};
+
+// Estatísticas de um StreamBuffer. Os valores "frame_*" são do último
+// quadro completo (veja StreamBuffer_EndFrame()).
+struct StreamBufferStats
+{
+    size_t frame_bytes;       // Bytes alocados no último quadro
+    size_t frame_allocations; // Alocações no último quadro
+    size_t stalls;            // Vezes em que o anel encheu e foi preciso esperar a GPU
+    double stall_seconds;     // Tempo total esperando a GPU
+    size_t orphans;           // Vezes em que o buffer foi órfão
+};
+
+// Região do anel lida por comandos já enviados, que só pode ser
+// reescrita após "fence" ser sinalizado.
+struct StreamBufferFence
+{
+    GLsync fence;
+    size_t begin;
+    size_t size;
+};
+
+struct StreamBuffer
+{
+    GpuBuffer        buffer;
+    GLenum           target;   // Ex.: GL_ARRAY_BUFFER
+    StreamBufferMode mode;
+    size_t           capacity; // Tamanho do anel, em bytes
+    size_t           head;     // Próximo byte livre
+
+    // Região do anel ocupada pelas alocações do quadro atual, incluindo o
+    // espaço perdido por alinhamento e ao dar a volta no anel.
+    size_t           frame_begin;
+    size_t           frame_size;
+    size_t           frame_bytes;       // Contadores do quadro atual (veja StreamBufferStats)
+    size_t           frame_allocations;
+
+    std::deque<StreamBufferFence> fences; // Em ordem de envio (STREAM_BUFFER_MAP)
+    std::vector<unsigned char>    staging; // Dados da alocação atual (STREAM_BUFFER_ORPHAN)
+
+    size_t pending_offset;    // Alocação ainda não enviada por StreamBuffer_Commit()
+    size_t pending_size;
+
+    StreamBufferStats stats;
+};
+
+// Cria o buffer do anel, com "capacity" bytes. "label" identifica o buffer
+// em "gpuresources.h".
+void StreamBuffer_Init(StreamBuffer& stream, GLenum target, size_t capacity, StreamBufferMode mode, const char* label);
+
+// Reserva "size" bytes, com deslocamento múltiplo de "alignment", e retorna
+// onde escrevê-los. O deslocamento da região dentro de stream.buffer é
+// escrito em "offset". Se o anel estiver cheio, espera a GPU liberar a
+// região mais antiga (ou, no modo STREAM_BUFFER_ORPHAN, torna o buffer
+// órfão). O ponteiro é válido até StreamBuffer_Commit().
+void* StreamBuffer_Allocate(StreamBuffer& stream, size_t size, size_t alignment, size_t& offset);
+
+// Envia os dados escritos na última alocação. Deve ser chamada antes dos
+// comandos de desenho que os utilizam. Deixa o buffer ligado a stream.target.
+void StreamBuffer_Commit(StreamBuffer& stream);
+
+// Marca o fim do quadro: as alocações feitas desde a chamada anterior
+// passam a ser protegidas por um fence.
+void StreamBuffer_EndFrame(StreamBuffer& stream);
+
+// Libera o buffer e os fences.
+void StreamBuffer_Destroy(StreamBuffer& stream);
+
+// Imprime no terminal as estatísticas acumuladas.
+void StreamBuffer_PrintStats(const StreamBuffer& stream, const char* name);
+
+#endif // _STREAMBUFFER_H
@@ -0,0 +1,66 @@
+#ifndef _STRESSSCENE_H
+#define _STRESSSCENE_H
+
+// Gerador de cenas de estresse para benchmarks do renderizador (opção
+// --stress): muitas cópias dos modelos da cena, distribuídas no espaço, com
+// um número configurável de malhas distintas, texturas e fontes de luz.
+// Veja "stressscene.cpp".
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// Número máximo de fontes de luz pontuais. Também define MAX_POINT_LIGHTS
+// em "shader_fragment.glsl" (veja BuildShaderDefines() em "main.cpp").
+#define STRESS_MAX_LIGHTS 16
+
+// Distribuição espacial das instâncias.
+enum StressLayout
+{
+    STRESS_LAYOUT_GRID,     // Grade regular
+    STRESS_LAYOUT_RANDOM,   // Distribuição uniforme aleatória
+    STRESS_LAYOUT_CLUSTERS  // Aglomerados (muita sobreposição em tela)
+};
+
+struct StressSceneParams
+{
+    int          num_instances; // Zero desabilita a cena de estresse
+    StressLayout layout;
+    int          num_meshes;    // Malhas distintas (cada uma com seus próprios buffers na GPU)
+    int          num_textures;  // Texturas distintas (zero: materiais sem textura)
+    int          num_lights;    // Fontes de luz pontuais, até STRESS_MAX_LIGHTS
+    unsigned int seed;          // Semente do gerador de números aleatórios
+    float        extent;        // As instâncias ficam dentro do cubo [-extent, extent]^3
+};
+
+// Uma cópia de um modelo. "mesh" e "texture" são índices dentro das malhas
+// e texturas criadas para a cena (veja BuildStressScene() em "main.cpp").
+struct StressInstance
+{
+    int       mesh;
+    int       texture;
+    glm::vec3 position;
+    float     size;       // Tamanho desejado da maior dimensão do modelo
+    float     rotation_y; // Rotação em torno do eixo Y (radianos)
+};
+
+struct StressLight
+{
+    glm::vec4 position;
+    glm::vec3 color;
+};
+
+// Parâmetros padrão: nenhuma instância (cena de estresse desabilitada).
+StressSceneParams StressScene_DefaultParams();
+
+// Interpreta uma opção de linha de comando "--stress...". Retorna false se
+// "arg" não for uma opção da cena de estresse. Opções inválidas encerram o
+// programa.
+bool StressScene_ParseOption(const char* arg, StressSceneParams& params);
+
+// Gera as instâncias e as fontes de luz da cena. O resultado depende somente
+// dos parâmetros (incluindo a semente).
+void StressScene_Generate(const StressSceneParams& params, std::vector<StressInstance>& instances, std::vector<StressLight>& lights);
+
+#endif // _STRESSSCENE_H
@@ -0,0 +1,56 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+// Gravação de uma linha do tempo de eventos do programa (carregamento de
+// arquivos, compilação de shaders, etapas de cada quadro, ...), exportada no
+// formato JSON de "trace events" do Chrome, que pode ser aberto em
+// chrome://tracing ou em https://ui.perfetto.dev. Veja "trace.cpp".
+
+#include <string>
+
+// Habilita a gravação de eventos. Se "filename" não for NULL, o arquivo é
+// escrito por Trace_Shutdown(). Enquanto a gravação não for habilitada,
+// registrar eventos não custa quase nada.
+void Trace_Init(const char* filename);
+bool Trace_IsEnabled();
+
+// Nome da thread atual, mostrado pelo visualizador.
+void Trace_SetThreadName(const char* name);
+
+// Registra um evento "name" que começou no instante "begin" e terminou em
+// "end" (segundos, veja Trace_Now()). "name" e "detail" (opcional) devem ser
+// strings que existam até o fim do programa: literais, ou strings obtidas
+// com Trace_Intern().
+void Trace_Event(const char* name, const char* detail, double begin, double end);
+
+// Relógio utilizado pelos eventos, em segundos.
+double Trace_Now();
+
+// Retorna uma cópia permanente da string "str", para ser usada como nome ou
+// detalhe de eventos (ex.: nomes de arquivos).
+const char* Trace_Intern(const std::string& str);
+
+// Escreve todos os eventos gravados até agora no arquivo "filename".
+bool Trace_Write(const char* filename);
+
+// Escreve o arquivo informado em Trace_Init(), caso exista.
+void Trace_Shutdown();
+
+// Registra um evento com a duração do escopo C++ onde for declarado:
+//
+//    {
+//        TraceScope trace("LoadTextureImage", Trace_Intern(filename));
+//        ...
+//    }
+struct TraceScope
+{
+    explicit TraceScope(const char* name, const char* detail = NULL)
+        : name(name), detail(detail), begin(Trace_IsEnabled() ? Trace_Now() : 0.0) {}
+    ~TraceScope() { if ( begin != 0.0 ) Trace_Event(name, detail, begin, Trace_Now()); }
+
+    const char* name;
+    const char* detail;
+    double      begin;
+};
+
+#endif // _TRACE_H
@@ -2,6 +2,7 @@
 #define _UTILS_H
 
 #include <cstdio>
+#include <cstring>
 
 static GLenum glCheckError_(const char *file, int line)
 {
@@ -26,4 +27,20 @@ static GLenum glCheckError_(const char *file, int line)
 }
 #define glCheckError() glCheckError_(__FILE__, __LINE__)
 
+// Verifica se o driver OpenGL suporta a extensão "name" (ex.:
+// "GL_ARB_get_program_binary"). Em perfil "core", a lista de extensões deve
+// ser consultada uma a uma com glGetStringi().
+static bool glHasExtension(const char* name)
+{
+    GLint num_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+    for (GLint i = 0; i < num_extensions; ++i)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension != NULL && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
 #endif // _UTILS_H
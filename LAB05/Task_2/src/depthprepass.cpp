@@ -0,0 +1,180 @@
+// Decisão da passada de profundidade pelo overdraw medido na GPU.
+//
+// Como as queries de tempo do profiler (veja "profiler.cpp"), as queries
+// GL_SAMPLES_PASSED só têm resultado alguns quadros depois, e são
+// utilizadas em rodízio: o resultado é lido somente quando
+// GL_QUERY_RESULT_AVAILABLE indicar que está pronto, nunca bloqueando.
+//
+// A decisão usa histerese: a passada é ligada com overdraw acima de
+// DEPTH_PREPASS_ENABLE_OVERDRAW, e só desligada abaixo de
+// DEPTH_PREPASS_DISABLE_OVERDRAW, com um número mínimo de quadros entre
+// trocas. Note que a medida é por pixel da tela inteira: uma cena que cobre
+// metade da tela com duas camadas mede 1.0, e não 2.0. Isso torna a
+// decisão conservadora, o que é desejável, já que a passada extra de
+// vértices custa o mesmo independente da área coberta.
+#include <cstdio>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "depthprepass.h"
+
+#define DEPTH_PREPASS_NUM_QUERIES 3
+
+// Limites de overdraw (amostras por pixel) para ligar e desligar a passada
+// no modo DEPTH_PREPASS_AUTO.
+#define DEPTH_PREPASS_ENABLE_OVERDRAW  1.6f
+#define DEPTH_PREPASS_DISABLE_OVERDRAW 1.3f
+
+// Quadros mínimos entre duas trocas, para que a média reflita a nova
+// situação antes de decidir novamente.
+#define DEPTH_PREPASS_MIN_FRAMES 30
+
+// Peso de cada nova medição na média exponencial do overdraw.
+#define DEPTH_PREPASS_AVERAGE_WEIGHT 0.1f
+
+struct DepthPrePassQuery
+{
+    GLuint query;
+    bool   issued;
+    double samples; // Amostras da tela na medição (pixels x amostras por pixel)
+};
+
+static DepthPrePassQuery depthprepass_queries[DEPTH_PREPASS_NUM_QUERIES];
+static int               depthprepass_next = 0;
+static bool              depthprepass_initialized = false;
+static GLint             depthprepass_samples_per_pixel = 1;
+
+static DepthPrePassMode depthprepass_mode = DEPTH_PREPASS_AUTO;
+static bool             depthprepass_enabled = false; // Decisão do modo automático
+static int              depthprepass_frames_since_switch = 0;
+static float            depthprepass_overdraw = 0.0f;
+static bool             depthprepass_measured = false;
+
+const char* DepthPrePass_ModeName(DepthPrePassMode mode)
+{
+    switch ( mode )
+    {
+        case DEPTH_PREPASS_AUTO: return "auto";
+        case DEPTH_PREPASS_ON:   return "on";
+        case DEPTH_PREPASS_OFF:  return "off";
+        default:                 return "?";
+    }
+}
+
+void DepthPrePass_SetMode(DepthPrePassMode mode)
+{
+    depthprepass_mode = mode;
+}
+
+DepthPrePassMode DepthPrePass_GetMode()
+{
+    return depthprepass_mode;
+}
+
+static void DepthPrePass_Init()
+{
+    for (int i = 0; i < DEPTH_PREPASS_NUM_QUERIES; ++i)
+    {
+        glGenQueries(1, &depthprepass_queries[i].query);
+        depthprepass_queries[i].issued = false;
+        depthprepass_queries[i].samples = 0.0;
+    }
+
+    // Com multisampling, GL_SAMPLES_PASSED conta amostras, e não pixels.
+    glGetIntegerv(GL_SAMPLES, &depthprepass_samples_per_pixel);
+    depthprepass_samples_per_pixel = std::max(depthprepass_samples_per_pixel, 1);
+
+    depthprepass_initialized = true;
+}
+
+// Lê o resultado da query "index", caso já esteja disponível. Nunca bloqueia.
+static void DepthPrePass_Collect(int index)
+{
+    DepthPrePassQuery& query = depthprepass_queries[index];
+    if ( !query.issued )
+        return;
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if ( !available )
+        return;
+
+    GLuint samples_passed = 0;
+    glGetQueryObjectuiv(query.query, GL_QUERY_RESULT, &samples_passed);
+    query.issued = false;
+
+    const float overdraw = (float)(samples_passed / query.samples);
+    if ( depthprepass_measured )
+        depthprepass_overdraw += DEPTH_PREPASS_AVERAGE_WEIGHT * (overdraw - depthprepass_overdraw);
+    else
+        depthprepass_overdraw = overdraw;
+    depthprepass_measured = true;
+}
+
+bool DepthPrePass_BeginFrame()
+{
+    // As queries terminam na ordem em que foram enviadas: lemos a partir da
+    // mais antiga.
+    if ( depthprepass_initialized )
+        for (int i = 0; i < DEPTH_PREPASS_NUM_QUERIES; ++i)
+            DepthPrePass_Collect((depthprepass_next + i) % DEPTH_PREPASS_NUM_QUERIES);
+
+    depthprepass_frames_since_switch += 1;
+    if ( depthprepass_measured && depthprepass_frames_since_switch >= DEPTH_PREPASS_MIN_FRAMES )
+    {
+        const bool enable = depthprepass_enabled
+            ? depthprepass_overdraw >= DEPTH_PREPASS_DISABLE_OVERDRAW
+            : depthprepass_overdraw >= DEPTH_PREPASS_ENABLE_OVERDRAW;
+        if ( enable != depthprepass_enabled )
+        {
+            depthprepass_enabled = enable;
+            depthprepass_frames_since_switch = 0;
+        }
+    }
+
+    switch ( depthprepass_mode )
+    {
+        case DEPTH_PREPASS_ON:  return true;
+        case DEPTH_PREPASS_OFF: return false;
+        default:                return depthprepass_enabled;
+    }
+}
+
+void DepthPrePass_BeginMeasure()
+{
+    if ( !depthprepass_initialized )
+        DepthPrePass_Init();
+
+    // Se a query deste quadro ainda não tem resultado (a GPU está mais de
+    // DEPTH_PREPASS_NUM_QUERIES quadros atrasada), a medição é descartada.
+    DepthPrePass_Collect(depthprepass_next);
+    depthprepass_queries[depthprepass_next].issued = false;
+
+    glBeginQuery(GL_SAMPLES_PASSED, depthprepass_queries[depthprepass_next].query);
+}
+
+void DepthPrePass_EndMeasure(int width, int height)
+{
+    glEndQuery(GL_SAMPLES_PASSED);
+
+    DepthPrePassQuery& query = depthprepass_queries[depthprepass_next];
+    query.samples = std::max((double)width * height * depthprepass_samples_per_pixel, 1.0);
+    query.issued = true;
+    depthprepass_next = (depthprepass_next + 1) % DEPTH_PREPASS_NUM_QUERIES;
+}
+
+float DepthPrePass_GetOverdraw()
+{
+    return depthprepass_overdraw;
+}
+
+void DepthPrePass_Shutdown()
+{
+    if ( !depthprepass_initialized )
+        return;
+
+    for (int i = 0; i < DEPTH_PREPASS_NUM_QUERIES; ++i)
+        glDeleteQueries(1, &depthprepass_queries[i].query);
+    depthprepass_initialized = false;
+}
@@ -0,0 +1,135 @@
+// Monitoramento de modificações em arquivos.
+//
+// No Linux utilizamos a API inotify do kernel: monitoramos o DIRETÓRIO de
+// cada arquivo (e não o arquivo em si), pois muitos editores de texto salvam
+// um arquivo escrevendo uma cópia nova e renomeando-a por cima da antiga, o
+// que invalidaria um monitoramento feito diretamente no arquivo original.
+// Veja https://man7.org/linux/man-pages/man7/inotify.7.html
+//
+// Nas demais plataformas, comparamos periodicamente a data de modificação de
+// cada arquivo, obtida com stat().
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#endif
+
+#include "filewatcher.h"
+
+struct WatchedFile
+{
+    std::string filename;  // Caminho completo, como informado em FileWatcher_AddFile()
+    std::string directory; // Diretório do arquivo
+    std::string basename;  // Nome do arquivo dentro do diretório
+    int         watch;     // Descritor inotify do diretório (Linux)
+    time_t      mtime;     // Última data de modificação conhecida (demais plataformas)
+};
+
+static std::vector<WatchedFile> filewatcher_files;
+
+#ifdef __linux__
+static int filewatcher_inotify = -1;
+#else
+static std::chrono::steady_clock::time_point filewatcher_last_poll;
+#endif
+
+static time_t FileWatcher_ModificationTime(const std::string& filename)
+{
+    struct stat info;
+    if ( stat(filename.c_str(), &info) != 0 )
+        return 0;
+    return info.st_mtime;
+}
+
+void FileWatcher_AddFile(const char* filename)
+{
+    WatchedFile file;
+    file.filename = filename;
+
+    size_t i = file.filename.find_last_of("/\\");
+    file.directory = (i == std::string::npos) ? "." : file.filename.substr(0, i);
+    file.basename  = (i == std::string::npos) ? file.filename : file.filename.substr(i + 1);
+    file.watch = -1;
+    file.mtime = FileWatcher_ModificationTime(file.filename);
+
+    #ifdef __linux__
+    if ( filewatcher_inotify < 0 )
+    {
+        filewatcher_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if ( filewatcher_inotify < 0 )
+            perror("WARNING: inotify_init1");
+    }
+
+    if ( filewatcher_inotify >= 0 )
+    {
+        // inotify_add_watch() retorna o mesmo descritor caso o diretório já
+        // esteja sendo monitorado.
+        file.watch = inotify_add_watch(filewatcher_inotify, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if ( file.watch < 0 )
+            fprintf(stderr, "WARNING: Cannot watch directory \"%s\".\n", file.directory.c_str());
+    }
+    #endif
+
+    filewatcher_files.push_back(file);
+}
+
+bool FileWatcher_Poll()
+{
+    bool changed = false;
+
+    #ifdef __linux__
+    if ( filewatcher_inotify < 0 )
+        return false;
+
+    // Lemos todos os eventos pendentes. Como o descritor foi criado com
+    // IN_NONBLOCK, read() retorna -1 (EAGAIN) quando não há mais eventos.
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(filewatcher_inotify, buffer, sizeof(buffer));
+        if ( length <= 0 )
+            break;
+
+        for (char* p = buffer; p < buffer + length; )
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if ( event->len > 0 )
+            {
+                for (size_t i = 0; i < filewatcher_files.size(); ++i)
+                {
+                    if ( filewatcher_files[i].watch == event->wd && filewatcher_files[i].basename == event->name )
+                        changed = true;
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    #else
+    // Evitamos chamar stat() em todos os quadros.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if ( now - filewatcher_last_poll < std::chrono::milliseconds(250) )
+        return false;
+    filewatcher_last_poll = now;
+
+    for (size_t i = 0; i < filewatcher_files.size(); ++i)
+    {
+        time_t mtime = FileWatcher_ModificationTime(filewatcher_files[i].filename);
+        if ( mtime != 0 && mtime != filewatcher_files[i].mtime )
+        {
+            filewatcher_files[i].mtime = mtime;
+            changed = true;
+        }
+    }
+    #endif
+
+    return changed;
+}
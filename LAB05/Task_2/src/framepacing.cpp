@@ -0,0 +1,144 @@
+// Controle do ritmo de apresentação dos quadros ("frame pacing").
+//
+// Sem nenhum controle, o loop de renderização executa tão rápido quanto
+// possível: com o vsync desligado pelo driver, isto significa milhares de
+// quadros por segundo, ocupando um núcleo da CPU e a GPU inteiros para
+// desenhar quadros que nunca chegam a ser vistos. Aqui controlamos
+// explicitamente o vsync (glfwSwapInterval()) e, opcionalmente, limitamos o
+// número de quadros por segundo.
+//
+// O limite de FPS espera pelo instante do próximo quadro em duas etapas:
+// primeiro dormimos (liberando a CPU) até um pouco antes do instante
+// desejado, e então esperamos o restante ativamente ("spin"), pois a
+// precisão de sleep_for() depende do sistema operacional e pode ser de
+// vários milissegundos. A margem reservada para o spin se adapta ao atraso
+// observado do sleep.
+// Veja https://blog.bearcats.nl/perfect-sleep-function/
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+
+#include "framepacing.h"
+
+// Número de intervalos guardados para as estatísticas.
+#define FRAMEPACING_NUM_SAMPLES 128
+
+static int    framepacing_swap_interval = -1; // -1: ainda não definido (padrão do driver)
+static double framepacing_max_fps = 0.0;
+static double framepacing_next_deadline = 0.0; // Instante (glfwGetTime()) do próximo quadro
+static double framepacing_sleep_margin = 0.002; // Segundos reservados para o spin
+static double framepacing_last_present = 0.0;
+
+static double framepacing_samples[FRAMEPACING_NUM_SAMPLES];
+static int    framepacing_num_samples = 0;
+static int    framepacing_next_sample = 0;
+
+void FramePacing_SetSwapInterval(int interval)
+{
+    framepacing_swap_interval = interval;
+    glfwSwapInterval(interval);
+}
+
+int FramePacing_GetSwapInterval()
+{
+    return framepacing_swap_interval;
+}
+
+void FramePacing_SetFrameCap(double max_fps)
+{
+    framepacing_max_fps = max_fps;
+    framepacing_next_deadline = 0.0;
+}
+
+double FramePacing_GetFrameCap()
+{
+    return framepacing_max_fps;
+}
+
+// Espera até o instante "deadline" (no relógio de glfwGetTime()).
+static void FramePacing_WaitUntil(double deadline)
+{
+    double sleep_until = deadline - framepacing_sleep_margin;
+    double now = glfwGetTime();
+
+    if ( sleep_until > now )
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(sleep_until - now));
+
+        // Ajustamos a margem: se o sleep atrasou mais do que a margem, ela
+        // cresce imediatamente; caso contrário, diminui lentamente.
+        double overshoot = glfwGetTime() - sleep_until;
+        if ( overshoot > framepacing_sleep_margin )
+            framepacing_sleep_margin = overshoot;
+        else
+            framepacing_sleep_margin = 0.99 * framepacing_sleep_margin + 0.01 * overshoot;
+        framepacing_sleep_margin = std::min(std::max(framepacing_sleep_margin, 0.0002), 0.02);
+    }
+
+    while ( glfwGetTime() < deadline )
+        std::this_thread::yield();
+}
+
+void FramePacing_Present(GLFWwindow* window)
+{
+    if ( framepacing_max_fps > 0.0 )
+    {
+        double period = 1.0 / framepacing_max_fps;
+        double now = glfwGetTime();
+
+        // Os instantes dos quadros são espaçados de exatamente "period"
+        // segundos. Se nos atrasamos mais de um quadro inteiro (ou se o
+        // limite acabou de ser definido), recomeçamos a partir de agora, em
+        // vez de apresentar vários quadros seguidos para "recuperar".
+        if ( framepacing_next_deadline == 0.0 || now - framepacing_next_deadline > period )
+            framepacing_next_deadline = now;
+        else
+            FramePacing_WaitUntil(framepacing_next_deadline);
+
+        framepacing_next_deadline += period;
+    }
+
+    glfwSwapBuffers(window);
+
+    double now = glfwGetTime();
+    if ( framepacing_last_present > 0.0 )
+    {
+        framepacing_samples[framepacing_next_sample] = (now - framepacing_last_present) * 1000.0;
+        framepacing_next_sample = (framepacing_next_sample + 1) % FRAMEPACING_NUM_SAMPLES;
+        framepacing_num_samples = std::min(framepacing_num_samples + 1, FRAMEPACING_NUM_SAMPLES);
+    }
+    framepacing_last_present = now;
+}
+
+void FramePacing_Idle()
+{
+    framepacing_last_present = 0.0;
+    framepacing_next_deadline = 0.0;
+}
+
+FramePacingStats FramePacing_GetStats()
+{
+    FramePacingStats stats;
+    stats.average_ms = 0.0;
+    stats.min_ms = 0.0;
+    stats.max_ms = 0.0;
+    stats.num_samples = framepacing_num_samples;
+
+    if ( framepacing_num_samples == 0 )
+        return stats;
+
+    stats.min_ms = framepacing_samples[0];
+    stats.max_ms = framepacing_samples[0];
+    for (int i = 0; i < framepacing_num_samples; ++i)
+    {
+        stats.average_ms += framepacing_samples[i];
+        stats.min_ms = std::min(stats.min_ms, framepacing_samples[i]);
+        stats.max_ms = std::max(stats.max_ms, framepacing_samples[i]);
+    }
+    stats.average_ms /= framepacing_num_samples;
+
+    return stats;
+}
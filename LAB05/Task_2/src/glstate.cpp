@@ -0,0 +1,262 @@
+// Cópia do estado OpenGL na CPU.
+//
+// Cada valor espelhado começa "desconhecido" (GL_STATE_UNKNOWN), de forma
+// que a primeira chamada sempre chega ao driver. O custo de uma chamada
+// eliminada é uma comparação; o de uma chamada repassada inclui a validação
+// do driver, que para trocas de programa e de VAO pode ser considerável.
+#include <cstring>
+
+#include "glstate.h"
+
+// Valor que nenhum nome de objeto ou enum OpenGL assume na prática.
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu
+
+// Alvos de glBindBuffer() espelhados.
+static const GLenum glstate_buffer_targets[] = {
+    GL_ARRAY_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_UNIFORM_BUFFER
+};
+#define GL_STATE_NUM_BUFFER_TARGETS (sizeof(glstate_buffer_targets) / sizeof(glstate_buffer_targets[0]))
+
+// Capacidades de glEnable() espelhadas.
+static const GLenum glstate_capabilities[] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE };
+#define GL_STATE_NUM_CAPABILITIES (sizeof(glstate_capabilities) / sizeof(glstate_capabilities[0]))
+
+struct GlStateCache
+{
+    GLuint program;
+    GLuint vertex_array;
+    GLuint buffers[GL_STATE_NUM_BUFFER_TARGETS];
+    GLuint active_texture_unit;
+    GLuint textures[GL_STATE_MAX_TEXTURE_UNITS]; // GL_TEXTURE_2D
+    GLuint samplers[GL_STATE_MAX_TEXTURE_UNITS];
+    GLuint capabilities[GL_STATE_NUM_CAPABILITIES]; // GL_TRUE, GL_FALSE ou desconhecido
+    GLuint blend_source;
+    GLuint blend_destination;
+    GLuint depth_function;
+    GLuint depth_mask;
+    GLuint cull_face;
+    GLuint front_face;
+    GLuint polygon_mode;
+    GLuint color_mask;
+};
+
+static GlStateCache glstate;
+static bool         glstate_initialized = false;
+static GlStateStats glstate_frame = { 0, 0 };      // Quadro atual
+static GlStateStats glstate_last_frame = { 0, 0 }; // Último quadro completo
+
+void GlState_Invalidate()
+{
+    // Todos os campos são GLuint, então o padrão 0xFF... em cada byte
+    // corresponde a GL_STATE_UNKNOWN em todos eles.
+    memset(&glstate, 0xFF, sizeof(glstate));
+    glstate_initialized = true;
+}
+
+// Atualiza o valor espelhado "value" para "wanted", retornando true se a
+// chamada deve ser repassada ao driver.
+static bool GlState_Change(GLuint& value, GLuint wanted)
+{
+    if ( !glstate_initialized )
+        GlState_Invalidate();
+
+    if ( value == wanted )
+    {
+        glstate_frame.filtered += 1;
+        return false;
+    }
+
+    value = wanted;
+    glstate_frame.issued += 1;
+    return true;
+}
+
+// Chamada que não é espelhada: sempre repassada.
+static void GlState_Passthrough()
+{
+    glstate_frame.issued += 1;
+}
+
+void GlState_UseProgram(GLuint program)
+{
+    if ( GlState_Change(glstate.program, program) )
+        glUseProgram(program);
+}
+
+void GlState_BindVertexArray(GLuint vertex_array)
+{
+    if ( GlState_Change(glstate.vertex_array, vertex_array) )
+        glBindVertexArray(vertex_array);
+}
+
+void GlState_BindBuffer(GLenum target, GLuint buffer)
+{
+    for (size_t i = 0; i < GL_STATE_NUM_BUFFER_TARGETS; ++i)
+    {
+        if ( glstate_buffer_targets[i] == target )
+        {
+            if ( GlState_Change(glstate.buffers[i], buffer) )
+                glBindBuffer(target, buffer);
+            return;
+        }
+    }
+
+    GlState_Passthrough();
+    glBindBuffer(target, buffer);
+}
+
+void GlState_BindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    if ( GlState_Change(glstate.active_texture_unit, unit) )
+        glActiveTexture(GL_TEXTURE0 + unit);
+
+    if ( target == GL_TEXTURE_2D && unit < GL_STATE_MAX_TEXTURE_UNITS )
+    {
+        if ( GlState_Change(glstate.textures[unit], texture) )
+            glBindTexture(target, texture);
+        return;
+    }
+
+    GlState_Passthrough();
+    glBindTexture(target, texture);
+}
+
+void GlState_BindSampler(GLuint unit, GLuint sampler)
+{
+    if ( unit < GL_STATE_MAX_TEXTURE_UNITS )
+    {
+        if ( GlState_Change(glstate.samplers[unit], sampler) )
+            glBindSampler(unit, sampler);
+        return;
+    }
+
+    GlState_Passthrough();
+    glBindSampler(unit, sampler);
+}
+
+void GlState_SetEnabled(GLenum capability, bool enabled)
+{
+    size_t i = 0;
+    while ( i < GL_STATE_NUM_CAPABILITIES && glstate_capabilities[i] != capability )
+        ++i;
+
+    if ( i < GL_STATE_NUM_CAPABILITIES )
+    {
+        if ( !GlState_Change(glstate.capabilities[i], enabled ? GL_TRUE : GL_FALSE) )
+            return;
+    }
+    else
+    {
+        GlState_Passthrough();
+    }
+
+    if ( enabled )
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GlState_BlendFunc(GLenum source, GLenum destination)
+{
+    if ( !glstate_initialized )
+        GlState_Invalidate();
+
+    // As duas partes formam uma única chamada, contada uma única vez.
+    if ( glstate.blend_source == source && glstate.blend_destination == destination )
+    {
+        glstate_frame.filtered += 1;
+        return;
+    }
+
+    glstate.blend_source = source;
+    glstate.blend_destination = destination;
+    glstate_frame.issued += 1;
+    glBlendFunc(source, destination);
+}
+
+void GlState_DepthFunc(GLenum function)
+{
+    if ( GlState_Change(glstate.depth_function, function) )
+        glDepthFunc(function);
+}
+
+void GlState_DepthMask(GLboolean mask)
+{
+    if ( GlState_Change(glstate.depth_mask, mask) )
+        glDepthMask(mask);
+}
+
+void GlState_CullFace(GLenum mode)
+{
+    if ( GlState_Change(glstate.cull_face, mode) )
+        glCullFace(mode);
+}
+
+void GlState_FrontFace(GLenum mode)
+{
+    if ( GlState_Change(glstate.front_face, mode) )
+        glFrontFace(mode);
+}
+
+void GlState_PolygonMode(GLenum mode)
+{
+    if ( GlState_Change(glstate.polygon_mode, mode) )
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GlState_ColorMask(bool enabled)
+{
+    if ( GlState_Change(glstate.color_mask, enabled ? GL_TRUE : GL_FALSE) )
+        glColorMask(enabled, enabled, enabled, enabled);
+}
+
+void GlState_ObjectDeleted(GpuResourceType type, GLuint id)
+{
+    if ( !glstate_initialized )
+        return;
+
+    switch ( type )
+    {
+        case GPU_BUFFER:
+            for (size_t i = 0; i < GL_STATE_NUM_BUFFER_TARGETS; ++i)
+                if ( glstate.buffers[i] == id )
+                    glstate.buffers[i] = 0;
+            break;
+        case GPU_VERTEX_ARRAY:
+            if ( glstate.vertex_array == id )
+                glstate.vertex_array = 0;
+            break;
+        case GPU_TEXTURE:
+            for (size_t i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; ++i)
+                if ( glstate.textures[i] == id )
+                    glstate.textures[i] = 0;
+            break;
+        case GPU_SAMPLER:
+            for (size_t i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; ++i)
+                if ( glstate.samplers[i] == id )
+                    glstate.samplers[i] = 0;
+            break;
+        case GPU_PROGRAM:
+            // Um programa em uso só é deletado de fato quando deixa de ser
+            // utilizado. Esquecemos o programa atual, de forma que a próxima
+            // chamada de GlState_UseProgram() seja sempre repassada.
+            if ( glstate.program == id )
+                glstate.program = GL_STATE_UNKNOWN;
+            break;
+        default:
+            break;
+    }
+}
+
+void GlState_EndFrame()
+{
+    glstate_last_frame = glstate_frame;
+    glstate_frame.issued = 0;
+    glstate_frame.filtered = 0;
+}
+
+GlStateStats GlState_GetFrameStats()
+{
+    return glstate_last_frame;
+}
@@ -0,0 +1,247 @@
+// Registro central dos objetos OpenGL.
+//
+// Para cada categoria guardamos um dicionário id -> (rótulo, bytes) com os
+// objetos em uso, os contadores de GpuResourceStats e o pool de objetos
+// liberados. Somente buffers e VAOs são reaproveitados: são os objetos
+// recriados com frequência (malhas reconstruídas, modelos recarregados), e
+// podem ser "limpos" antes de voltarem ao pool. Texturas, samplers e
+// programas liberados são deletados imediatamente.
+//
+// Objetos reaproveitados não ocupam memória da GPU enquanto estão no pool:
+// os dados de um buffer são descartados com glBufferData(..., 0, NULL, ...)
+// e os atributos de um VAO são desabilitados (com divisor de instâncias
+// zero). Assim o pool economiza as chamadas glGen*()/glDelete*() sem reter
+// memória.
+#include <cstdio>
+#include <vector>
+#include <unordered_map>
+
+#include "gpuresources.h"
+
+// Número máximo de objetos guardados no pool de cada categoria. Objetos
+// liberados além deste limite são deletados.
+#define GPU_RESOURCES_MAX_POOLED 256
+
+struct GpuResourceEntry
+{
+    const char* label;
+    size_t      bytes;
+};
+
+struct GpuResourceRegistry
+{
+    std::unordered_map<GLuint, GpuResourceEntry> live;
+    std::vector<GLuint> pool;
+    GpuResourceStats    stats;
+};
+
+static GpuResourceRegistry gpuresources_registry[GPU_NUM_RESOURCE_TYPES];
+static bool gpuresources_shutdown = false; // GpuResources_Shutdown() já foi chamada
+static GpuResourceDeleteCallback gpuresources_delete_callback = NULL;
+
+static const char* const gpuresources_type_names[GPU_NUM_RESOURCE_TYPES] = {
+    "buffers", "vertex arrays", "textures", "samplers", "programs"
+};
+
+static bool GpuResources_IsPooled(GpuResourceType type)
+{
+    return type == GPU_BUFFER || type == GPU_VERTEX_ARRAY;
+}
+
+static GLuint GpuResources_GenObject(GpuResourceType type)
+{
+    GLuint id = 0;
+    switch ( type )
+    {
+        case GPU_BUFFER:       glGenBuffers(1, &id); break;
+        case GPU_VERTEX_ARRAY: glGenVertexArrays(1, &id); break;
+        case GPU_TEXTURE:      glGenTextures(1, &id); break;
+        case GPU_SAMPLER:      glGenSamplers(1, &id); break;
+        case GPU_PROGRAM:      id = glCreateProgram(); break;
+        default: break;
+    }
+    return id;
+}
+
+static void GpuResources_DeleteObject(GpuResourceType type, GLuint id)
+{
+    switch ( type )
+    {
+        case GPU_BUFFER:       glDeleteBuffers(1, &id); break;
+        case GPU_VERTEX_ARRAY: glDeleteVertexArrays(1, &id); break;
+        case GPU_TEXTURE:      glDeleteTextures(1, &id); break;
+        case GPU_SAMPLER:      glDeleteSamplers(1, &id); break;
+        case GPU_PROGRAM:      glDeleteProgram(id); break;
+        default: break;
+    }
+
+    if ( gpuresources_delete_callback != NULL )
+        gpuresources_delete_callback(type, id);
+}
+
+// Deixa um buffer ou VAO liberado no mesmo estado de um recém-criado.
+static void GpuResources_ClearObject(GpuResourceType type, GLuint id)
+{
+    if ( type == GPU_BUFFER )
+    {
+        // GL_COPY_WRITE_BUFFER não é utilizado pelo desenho, então ligar o
+        // buffer a ele não altera o estado dos VAOs. (No OpenGL 3.3 o próprio
+        // GL_COPY_WRITE_BUFFER é usado para consultar o buffer ligado.)
+        GLint previous = 0;
+        glGetIntegerv(GL_COPY_WRITE_BUFFER, &previous);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        glBufferData(GL_COPY_WRITE_BUFFER, 0, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint)previous);
+    }
+    else if ( type == GPU_VERTEX_ARRAY )
+    {
+        GLint previous = 0;
+        GLint max_attributes = 0;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+        glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+        glBindVertexArray(id);
+        for (GLint location = 0; location < max_attributes; ++location)
+        {
+            glDisableVertexAttribArray((GLuint)location);
+            glVertexAttribDivisor((GLuint)location, 0);
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindVertexArray((GLuint)previous);
+    }
+}
+
+GLuint GpuResources_Create(GpuResourceType type, const char* label)
+{
+    GpuResourceRegistry& registry = gpuresources_registry[type];
+
+    GLuint id;
+    if ( !registry.pool.empty() )
+    {
+        id = registry.pool.back();
+        registry.pool.pop_back();
+        registry.stats.reused += 1;
+    }
+    else
+    {
+        id = GpuResources_GenObject(type);
+        if ( id == 0 )
+        {
+            fprintf(stderr, "ERROR: Cannot create OpenGL %s for \"%s\".\n", gpuresources_type_names[type], label);
+            return 0;
+        }
+    }
+
+    GpuResourceEntry entry = { label, 0 };
+    registry.live[id] = entry;
+    registry.stats.created += 1;
+    registry.stats.live = registry.live.size();
+    registry.stats.pooled = registry.pool.size();
+    if ( registry.stats.live > registry.stats.peak )
+        registry.stats.peak = registry.stats.live;
+
+    return id;
+}
+
+void GpuResources_Release(GpuResourceType type, GLuint id)
+{
+    if ( id == 0 || gpuresources_shutdown )
+        return;
+
+    GpuResourceRegistry& registry = gpuresources_registry[type];
+
+    std::unordered_map<GLuint, GpuResourceEntry>::iterator it = registry.live.find(id);
+    if ( it == registry.live.end() )
+    {
+        fprintf(stderr, "WARNING: Releasing OpenGL %s %u not created by GpuResources_Create().\n", gpuresources_type_names[type], id);
+        GpuResources_DeleteObject(type, id);
+        return;
+    }
+
+    registry.stats.bytes -= it->second.bytes;
+    registry.live.erase(it);
+    registry.stats.live = registry.live.size();
+
+    if ( GpuResources_IsPooled(type) && registry.pool.size() < GPU_RESOURCES_MAX_POOLED )
+    {
+        GpuResources_ClearObject(type, id);
+        registry.pool.push_back(id);
+    }
+    else
+    {
+        GpuResources_DeleteObject(type, id);
+    }
+    registry.stats.pooled = registry.pool.size();
+}
+
+void GpuResources_SetSize(GpuResourceType type, GLuint id, size_t bytes)
+{
+    GpuResourceRegistry& registry = gpuresources_registry[type];
+
+    std::unordered_map<GLuint, GpuResourceEntry>::iterator it = registry.live.find(id);
+    if ( it == registry.live.end() )
+        return;
+
+    registry.stats.bytes = registry.stats.bytes - it->second.bytes + bytes;
+    it->second.bytes = bytes;
+}
+
+void GpuResources_SetDeleteCallback(GpuResourceDeleteCallback callback)
+{
+    gpuresources_delete_callback = callback;
+}
+
+GpuResourceStats GpuResources_GetStats(GpuResourceType type)
+{
+    return gpuresources_registry[type].stats;
+}
+
+const char* GpuResources_TypeName(GpuResourceType type)
+{
+    return gpuresources_type_names[type];
+}
+
+void GpuResources_PrintStats()
+{
+    printf("Recursos de GPU:\n");
+    for (int type = 0; type < GPU_NUM_RESOURCE_TYPES; ++type)
+    {
+        const GpuResourceStats& stats = gpuresources_registry[type].stats;
+        printf("  %-14s %6lu em uso (%8.2f MB), pico %6lu, criados %8lu, reutilizados %8lu\n",
+            gpuresources_type_names[type], (unsigned long)stats.live, stats.bytes / (1024.0 * 1024.0),
+            (unsigned long)stats.peak, (unsigned long)stats.created, (unsigned long)stats.reused);
+    }
+}
+
+int GpuResources_ReportLeaks()
+{
+    int num_leaks = 0;
+    for (int type = 0; type < GPU_NUM_RESOURCE_TYPES; ++type)
+    {
+        const GpuResourceRegistry& registry = gpuresources_registry[type];
+        for (std::unordered_map<GLuint, GpuResourceEntry>::const_iterator it = registry.live.begin(); it != registry.live.end(); ++it)
+        {
+            fprintf(stderr, "WARNING: Leaked OpenGL %s %u \"%s\" (%lu bytes).\n",
+                gpuresources_type_names[type], it->first, it->second.label, (unsigned long)it->second.bytes);
+            ++num_leaks;
+        }
+    }
+    return num_leaks;
+}
+
+void GpuResources_Shutdown()
+{
+    int num_leaks = GpuResources_ReportLeaks();
+    if ( num_leaks > 0 )
+        fprintf(stderr, "WARNING: %d OpenGL objects were never released.\n", num_leaks);
+
+    for (int type = 0; type < GPU_NUM_RESOURCE_TYPES; ++type)
+    {
+        GpuResourceRegistry& registry = gpuresources_registry[type];
+        for (size_t i = 0; i < registry.pool.size(); ++i)
+            GpuResources_DeleteObject((GpuResourceType)type, registry.pool[i]);
+        registry.pool.clear();
+        registry.stats.pooled = 0;
+    }
+
+    gpuresources_shutdown = true;
+}
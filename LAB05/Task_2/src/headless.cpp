@@ -0,0 +1,199 @@
+// Modo de benchmark sem janela visível (opção --headless).
+//
+// Máquinas de integração contínua normalmente não possuem monitor. O
+// contexto OpenGL continua sendo criado pela GLFW, mas com uma janela
+// invisível (GLFW_VISIBLE), o que funciona com um servidor X virtual (ex.:
+// "xvfb-run") e renderização por software (Mesa llvmpipe, com
+// LIBGL_ALWAYS_SOFTWARE=1). O conteúdo do framebuffer padrão de uma janela
+// invisível não é definido pela especificação, por isso a cena é desenhada
+// em um framebuffer offscreen próprio.
+//
+// O quadro i do benchmark sempre mostra a mesma cena (caminho de câmera e
+// tempo de animação fixos, veja main()), de forma que os resultados de
+// execuções diferentes são comparáveis.
+// Veja https://www.khronos.org/opengl/wiki/Framebuffer_Object
+#include <cstdio>
+#include <cmath>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "headless.h"
+#include "profiler.h"
+
+bool Headless_CreateTarget(HeadlessTarget& target, int width, int height)
+{
+    target.width = width;
+    target.height = height;
+
+    glGenRenderbuffers(1, &target.color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &target.depth_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color_renderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depth_renderbuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if ( status != GL_FRAMEBUFFER_COMPLETE )
+    {
+        fprintf(stderr, "ERROR: Offscreen framebuffer is incomplete (status 0x%04X).\n", status);
+        Headless_DestroyTarget(target);
+        return false;
+    }
+
+    return true;
+}
+
+void Headless_DestroyTarget(HeadlessTarget& target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &target.framebuffer);
+    glDeleteRenderbuffers(1, &target.color_renderbuffer);
+    glDeleteRenderbuffers(1, &target.depth_renderbuffer);
+    target.framebuffer = target.color_renderbuffer = target.depth_renderbuffer = 0;
+}
+
+// Uma volta completa ao redor da origem, subindo e descendo e aproximando e
+// afastando a câmera duas vezes, de forma que a cena seja vista de perto e
+// de longe, de lado e de cima.
+void Headless_CameraPath(int frame, int num_frames, float& theta, float& phi, float& distance)
+{
+    const float pi = 3.14159265f;
+    float t = (num_frames > 1) ? (float)frame / (num_frames - 1) : 0.0f;
+
+    theta = 2.0f * pi * t;
+    phi = 0.35f + 0.25f * sinf(4.0f * pi * t);
+    distance = 3.5f - 1.0f * cosf(4.0f * pi * t);
+}
+
+// Escreve uma string JSON, escapando aspas, barras e caracteres de controle.
+static void Headless_WriteString(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (const char* c = str; *c != '\0'; ++c)
+    {
+        if ( *c == '"' || *c == '\\' )
+            fprintf(file, "\\%c", *c);
+        else if ( (unsigned char)*c < 0x20 )
+            fprintf(file, "\\u%04x", *c);
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void Headless_WriteStats(FILE* file, const ProfilerStats& stats)
+{
+    fprintf(file, "{\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"average\":%.4f,\"max\":%.4f}",
+        stats.p50, stats.p95, stats.p99, stats.average, stats.max);
+}
+
+bool Headless_WriteResults(const char* filename, const HeadlessTarget& target)
+{
+    FILE* file = fopen(filename, "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write benchmark results \"%s\".\n", filename);
+        return false;
+    }
+
+    const int num_frames = Profiler_GetFrameLogSize();
+    const int num_passes = Profiler_GetNumPasses();
+
+    fprintf(file, "{\n  \"renderer\": ");
+    Headless_WriteString(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n  \"version\": ");
+    Headless_WriteString(file, (const char*)glGetString(GL_VERSION));
+    fprintf(file, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n", target.width, target.height, num_frames);
+
+    // Percentis de todos os quadros registrados, em milissegundos.
+    std::vector<float> values(num_frames);
+    for (int i = 0; i < num_frames; ++i)
+        values[i] = Profiler_GetFrameLogRecord(i).frame_ms;
+
+    fprintf(file, "  \"summary\": {\n    \"frame\": ");
+    Headless_WriteStats(file, Profiler_ComputeStats(values.data(), num_frames));
+
+    for (int pass = 0; pass < num_passes; ++pass)
+    {
+        for (int i = 0; i < num_frames; ++i)
+            values[i] = Profiler_GetFrameLogRecord(i).cpu_ms[pass];
+
+        fprintf(file, ",\n    ");
+        Headless_WriteString(file, Profiler_GetPassName(pass));
+        fprintf(file, ": {\"cpu\":");
+        Headless_WriteStats(file, Profiler_ComputeStats(values.data(), num_frames));
+
+        if ( Profiler_PassHasGpuTime(pass) )
+        {
+            // Quadros sem o tempo de GPU (queries descartadas) ficam de fora.
+            int count = 0;
+            for (int i = 0; i < num_frames; ++i)
+                if ( Profiler_GetFrameLogRecord(i).gpu_ms[pass] >= 0.0f )
+                    values[count++] = Profiler_GetFrameLogRecord(i).gpu_ms[pass];
+
+            fprintf(file, ",\"gpu\":");
+            Headless_WriteStats(file, Profiler_ComputeStats(values.data(), count));
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  },\n");
+
+    // Tempos de cada quadro. Um tempo de GPU negativo indica que ele não foi
+    // medido.
+    fprintf(file, "  \"frame_times\": [\n");
+    for (int i = 0; i < num_frames; ++i)
+    {
+        const ProfilerFrameRecord& record = Profiler_GetFrameLogRecord(i);
+
+        fprintf(file, "    {\"frame\":%d,\"cpu_ms\":%.4f", i, record.frame_ms);
+        for (int pass = 0; pass < num_passes; ++pass)
+        {
+            fprintf(file, ",");
+            Headless_WriteString(file, Profiler_GetPassName(pass));
+            fprintf(file, ":{\"cpu_ms\":%.4f", record.cpu_ms[pass]);
+            if ( Profiler_PassHasGpuTime(pass) )
+                fprintf(file, ",\"gpu_ms\":%.4f", record.gpu_ms[pass]);
+            fprintf(file, "}");
+        }
+        fprintf(file, "}%s\n", (i + 1 < num_frames) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    fclose(file);
+
+    printf("Resultados do benchmark escritos em \"%s\" (%d quadros).\n", filename, num_frames);
+    return true;
+}
+
+bool Headless_WriteImage(const char* filename, const HeadlessTarget& target)
+{
+    FILE* file = fopen(filename, "wb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write image \"%s\".\n", filename);
+        return false;
+    }
+
+    std::vector<unsigned char> pixels(target.width * target.height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, target.width, target.height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    // OpenGL retorna as linhas de baixo para cima; o formato PPM as espera
+    // de cima para baixo.
+    fprintf(file, "P6\n%d %d\n255\n", target.width, target.height);
+    for (int y = target.height - 1; y >= 0; --y)
+        fwrite(&pixels[y * target.width * 3], 1, target.width * 3, file);
+
+    fclose(file);
+
+    printf("Imagem escrita em \"%s\".\n", filename);
+    return true;
+}
@@ -0,0 +1,171 @@
+// Gravação e reprodução dos eventos de entrada.
+//
+// O arquivo é binário e compacto: um cabeçalho ("INPL", a versão do formato
+// e o instante inicial da simulação) seguido dos registros, um após o outro. Todo registro começa com
+// o seu tipo (1 byte) e o seu instante (double, 8 bytes); eventos de entrada
+// continuam com o tipo do evento (1 byte), a tecla ou botão (2 bytes), a
+// ação e os modificadores (1 byte cada) e as duas coordenadas (double, 8
+// bytes cada). Os valores são escritos em little-endian, byte a byte, de
+// forma que o arquivo não depende da máquina onde foi gravado. Doubles são
+// gravados com todos os seus bits: a reprodução recebe exatamente os mesmos
+// valores que a execução original.
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include "inputlog.h"
+
+#define INPUTLOG_VERSION 2
+
+static FILE* inputlog_file = NULL;
+
+static void InputLog_WriteUInt(FILE* file, uint64_t value, int num_bytes)
+{
+    for (int i = 0; i < num_bytes; ++i)
+        fputc((int)((value >> (8 * i)) & 0xFF), file);
+}
+
+static void InputLog_WriteDouble(FILE* file, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    InputLog_WriteUInt(file, bits, 8);
+}
+
+// Lê um inteiro sem sinal de "num_bytes" bytes. Retorna false no final do
+// arquivo.
+static bool InputLog_ReadUInt(FILE* file, uint64_t& value, int num_bytes)
+{
+    value = 0;
+    for (int i = 0; i < num_bytes; ++i)
+    {
+        int c = fgetc(file);
+        if ( c == EOF )
+            return false;
+        value |= (uint64_t)c << (8 * i);
+    }
+    return true;
+}
+
+static bool InputLog_ReadDouble(FILE* file, double& value)
+{
+    uint64_t bits;
+    if ( !InputLog_ReadUInt(file, bits, 8) )
+        return false;
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool InputLog_StartRecording(const char* filename, double simulation_start)
+{
+    InputLog_StopRecording();
+
+    inputlog_file = fopen(filename, "wb");
+    if ( inputlog_file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write input log \"%s\".\n", filename);
+        return false;
+    }
+
+    fwrite("INPL", 1, 4, inputlog_file);
+    InputLog_WriteUInt(inputlog_file, INPUTLOG_VERSION, 4);
+    InputLog_WriteDouble(inputlog_file, simulation_start);
+    return true;
+}
+
+bool InputLog_IsRecording()
+{
+    return inputlog_file != NULL;
+}
+
+void InputLog_Record(const InputLogRecord& record)
+{
+    if ( inputlog_file == NULL )
+        return;
+
+    InputLog_WriteUInt(inputlog_file, record.type, 1);
+    InputLog_WriteDouble(inputlog_file, record.time);
+
+    if ( record.type == INPUT_LOG_EVENT )
+    {
+        InputLog_WriteUInt(inputlog_file, (uint64_t)record.event_type, 1);
+        InputLog_WriteUInt(inputlog_file, (uint64_t)(uint16_t)(int16_t)record.key, 2);
+        InputLog_WriteUInt(inputlog_file, (uint64_t)record.action, 1);
+        InputLog_WriteUInt(inputlog_file, (uint64_t)record.mods, 1);
+        InputLog_WriteDouble(inputlog_file, record.x);
+        InputLog_WriteDouble(inputlog_file, record.y);
+    }
+}
+
+void InputLog_StopRecording()
+{
+    if ( inputlog_file == NULL )
+        return;
+
+    fclose(inputlog_file);
+    inputlog_file = NULL;
+}
+
+bool InputLog_Load(const char* filename, std::vector<InputLogRecord>& records, double& simulation_start)
+{
+    FILE* file = fopen(filename, "rb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open input log \"%s\".\n", filename);
+        return false;
+    }
+
+    char magic[4];
+    uint64_t version = 0;
+    if ( fread(magic, 1, 4, file) != 4 || memcmp(magic, "INPL", 4) != 0
+      || !InputLog_ReadUInt(file, version, 4) || version != INPUTLOG_VERSION
+      || !InputLog_ReadDouble(file, simulation_start) )
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not a version %d input log.\n", filename, INPUTLOG_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    records.clear();
+
+    uint64_t type;
+    while ( InputLog_ReadUInt(file, type, 1) )
+    {
+        InputLogRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = (InputLogRecordType)type;
+
+        bool ok = InputLog_ReadDouble(file, record.time);
+        if ( ok && record.type == INPUT_LOG_EVENT )
+        {
+            uint64_t event_type, key, action, mods;
+            ok = InputLog_ReadUInt(file, event_type, 1)
+              && InputLog_ReadUInt(file, key, 2)
+              && InputLog_ReadUInt(file, action, 1)
+              && InputLog_ReadUInt(file, mods, 1)
+              && InputLog_ReadDouble(file, record.x)
+              && InputLog_ReadDouble(file, record.y);
+
+            record.event_type = (int)event_type;
+            record.key = (int16_t)(uint16_t)key;
+            record.action = (int)action;
+            record.mods = (int)mods;
+        }
+        else if ( ok && record.type != INPUT_LOG_FRAME )
+        {
+            ok = false;
+        }
+
+        if ( !ok )
+        {
+            fprintf(stderr, "ERROR: Input log \"%s\" is truncated or corrupted.\n", filename);
+            fclose(file);
+            return false;
+        }
+
+        records.push_back(record);
+    }
+
+    fclose(file);
+    return true;
+}
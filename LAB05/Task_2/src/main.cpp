@@ -18,17 +18,25 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 // Headers abaixo são específicos de C++
 #include <map>
 #include <stack>
 #include <string>
 #include <vector>
+#include <memory>
 #include <limits>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // Headers das bibliotecas OpenGL
 #include <glad/glad.h>   // Criação de contexto OpenGL 3.3
@@ -36,6 +44,7 @@
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -47,65 +56,23 @@
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
 #include "matrices.h"
-
-// Estrutura que representa um modelo geométrico carregado a partir de um
-// arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
-struct ObjModel
-{
-    tinyobj::attrib_t                 attrib;
-    std::vector<tinyobj::shape_t>     shapes;
-    std::vector<tinyobj::material_t>  materials;
-
-    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
-    // Veja: https://github.com/syoyo/tinyobjloader
-    ObjModel(const char* filename, const char* basepath = NULL, bool triangulate = true)
-    {
-        printf("Carregando objetos do arquivo \"%s\"...\n", filename);
-
-        // Se basepath == NULL, então setamos basepath como o dirname do
-        // filename, para que os arquivos MTL sejam corretamente carregados caso
-        // estejam no mesmo diretório dos arquivos OBJ.
-        std::string fullpath(filename);
-        std::string dirname;
-        if (basepath == NULL)
-        {
-            auto i = fullpath.find_last_of("/");
-            if (i != std::string::npos)
-            {
-                dirname = fullpath.substr(0, i+1);
-                basepath = dirname.c_str();
-            }
-        }
-
-        std::string warn;
-        std::string err;
-        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate);
-
-        if (!err.empty())
-            fprintf(stderr, "\n%s\n", err.c_str());
-
-        if (!ret)
-            throw std::runtime_error("Erro ao carregar modelo.");
-
-        for (size_t shape = 0; shape < shapes.size(); ++shape)
-        {
-            if (shapes[shape].name.empty())
-            {
-                fprintf(stderr,
-                        "*********************************************\n"
-                        "Erro: Objeto sem nome dentro do arquivo '%s'.\n"
-                        "Veja https://www.inf.ufrgs.br/~eslgastal/fcg-faq-etc.html#Modelos-3D-no-formato-OBJ .\n"
-                        "*********************************************\n",
-                    filename);
-                throw std::runtime_error("Objeto sem nome.");
-            }
-            printf("- Objeto '%s'\n", shapes[shape].name.c_str());
-        }
-
-        printf("OK.\n");
-    }
-};
-
+#include "programcache.h"
+#include "filewatcher.h"
+#include "framesync.h"
+#include "framepacing.h"
+#include "profiler.h"
+#include "trace.h"
+#include "headless.h"
+#include "inputlog.h"
+#include "stressscene.h"
+#include "objmodel.h"
+#include "gpuresources.h"
+#include "meshindices.h"
+#include "proceduralmesh.h"
+#include "streambuffer.h"
+#include "glstate.h"
+#include "shaderprogram.h"
+#include "depthprepass.h"
 
 // Declaração de funções utilizadas para pilha de matrizes de modelagem.
 void PushMatrix(glm::mat4 M);
@@ -114,19 +81,32 @@ void PopMatrix(glm::mat4& M);
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
 void BuildTrianglesAndAddToVirtualScene(ObjModel*); // Constrói representação de um ObjModel como malha de triângulos para renderização
-void ComputeNormals(ObjModel* model); // Computa normais de um ObjModel, caso não existam.
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
-void LoadTextureImage(const char* filename); // Função que carrega imagens de textura
-void DrawVirtualObject(const char* object_name); // Desenha um objeto armazenado em g_VirtualScene
-GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
-GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
-void LoadShader(const char* filename, GLuint shader_id); // Função utilizada pelas duas acima
+void StartShaderReload(); // Inicia a recarga dos shaders sem bloquear a renderização
+void UpdateShaderReload(); // Verifica, a cada quadro, se a recarga dos shaders terminou
+void DiscardShaderReload(); // Descarta a recarga de shaders em andamento, caso exista
+GLint LoadTextureImage(const char* filename); // Função que carrega imagens de textura
+unsigned char* DecodeTextureImage(const char* filename, int& width, int& height); // Lê uma imagem do disco (RGB), liberada com stbi_image_free()
+GLint UploadTextureImage(const unsigned char* data, int width, int height); // Cria uma textura com uma imagem já lida
+std::string LoadShaderSource(const char* filename, const char* defines = ""); // Lê o código-fonte de um shader
+bool ReadShaderFile(const char* filename, std::string& contents); // Lê um arquivo GLSL, sem abortar em caso de erro
+std::string InsertShaderDefines(const std::string& contents, const char* defines); // Insere "defines" após a diretiva #version
+GLuint LoadShader_Vertex(const char* filename, const std::string& source);   // Carrega um vertex shader
+GLuint LoadShader_Fragment(const char* filename, const std::string& source); // Carrega um fragment shader
+void LoadShader(const char* filename, const std::string& source, GLuint shader_id); // Função utilizada pelas duas acima
+void CompileShader(GLuint shader_id, const std::string& source); // Inicia a compilação de um shader
+bool CheckShaderCompileStatus(const char* filename, GLuint shader_id); // Imprime o log de compilação de um shader
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Cria um programa de GPU
+GLuint LinkGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Inicia a linkagem de um programa de GPU
+bool CheckGpuProgramLinkStatus(GLuint program_id); // Imprime o log de linkagem de um programa de GPU
 void PrintObjModelInfo(ObjModel*); // Função para debugging
 
 // Declaração de funções auxiliares para renderizar texto dentro da janela
 // OpenGL. Estas funções estão definidas no arquivo "textrendering.cpp".
-void TextRendering_Init();
+void TextRendering_Init(StreamBufferMode stream_mode);
+void TextRendering_EndFrame(); // Protege os vértices do quadro no buffer circular. Veja "streambuffer.h".
+void TextRendering_Shutdown();
+const StreamBufferStats& TextRendering_GetStreamStats();
 float TextRendering_LineHeight(GLFWwindow* window);
 float TextRendering_CharWidth(GLFWwindow* window);
 void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f);
@@ -135,13 +115,15 @@ void TextRendering_PrintVector(GLFWwindow* window, glm::vec4 v, float x, float y
 void TextRendering_PrintMatrixVectorProduct(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
 void TextRendering_PrintMatrixVectorProductMoreDigits(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
 void TextRendering_PrintMatrixVectorProductDivW(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
+void TextRendering_PrintGraph(GLFWwindow* window, const float* values, int count, float max_value, float reference_value, float x, float y, float width, float height);
 
 // Funções abaixo renderizam como texto na janela OpenGL algumas matrizes e
 // outras informações do programa. Definidas após main().
 void TextRendering_ShowModelViewProjection(GLFWwindow* window, glm::mat4 projection, glm::mat4 view, glm::mat4 model, glm::vec4 p_model);
-void TextRendering_ShowEulerAngles(GLFWwindow* window);
-void TextRendering_ShowProjection(GLFWwindow* window);
+void TextRendering_ShowEulerAngles(GLFWwindow* window, glm::vec3 euler_angles);
+void TextRendering_ShowProjection(GLFWwindow* window, bool use_perspective_projection);
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window);
+void TextRendering_ShowProfiler(GLFWwindow* window);
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -152,32 +134,340 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 
+// Função de hash FNV-1a (32 bits) utilizada para identificar os objetos da
+// cena virtual pelo nome. Por ser "constexpr", o hash de um literal pode ser
+// computado em tempo de compilação; para garantir isso, o resultado deve
+// inicializar uma constante constexpr (ex.: constexpr uint32_t hash =
+// SceneObjectNameHash("the_bunny")), e não ser passado direto a uma função.
+// Veja http://www.isthe.com/chongo/tech/comp/fnv/index.html
+constexpr uint32_t SceneObjectNameHash(const char* name, uint32_t hash = 2166136261u)
+{
+    return (*name == '\0') ? hash : SceneObjectNameHash(name + 1, (hash ^ (uint32_t)(unsigned char)(*name)) * 16777619u);
+}
+
+// Identificador ("handle") de um objeto da cena virtual: é simplesmente o
+// índice do objeto dentro dos vetores da estrutura VirtualScene abaixo.
+typedef int SceneObjectHandle;
+const SceneObjectHandle INVALID_SCENE_OBJECT = -1;
+
 // Definimos uma estrutura que armazenará dados necessários para renderizar
-// cada objeto da cena virtual.
-struct SceneObject
-{
-    std::string  name;        // Nome do objeto
-    size_t       first_index; // Índice do primeiro vértice dentro do vetor indices[] definido em BuildTrianglesAndAddToVirtualScene()
-    size_t       num_indices; // Número de índices do objeto dentro do vetor indices[] definido em BuildTrianglesAndAddToVirtualScene()
-    GLenum       rendering_mode; // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
-    GLuint       vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
-    glm::vec3    bbox_min; // Axis-Aligned Bounding Box do objeto
-    glm::vec3    bbox_max;
+// cada objeto da cena virtual. Os dados são guardados em formato
+// "structure of arrays" (SoA): cada atributo de todos os objetos fica em um
+// vetor contíguo, indexado pelo handle do objeto. Assim, percorrer a cena a
+// cada quadro é uma varredura linear em memória contígua, sem alocações e
+// sem buscas por nome.
+struct VirtualScene
+{
+    std::vector<std::string>  name;        // Nome do objeto (utilizado somente no carregamento e para debugging)
+    std::vector<uint32_t>     name_hash;   // SceneObjectNameHash() do nome do objeto
+    std::vector<const char*>  trace_name;  // Cópia permanente do nome para o trace de eventos (veja Trace_Intern())
+    std::vector<MeshIndexRange> indices;   // Faixa de índices do objeto dentro do buffer de índices do VAO (veja "meshindices.h")
+    std::vector<GLenum>       rendering_mode; // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
+    std::vector<GLuint>       vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
+    std::vector<glm::vec3>    bbox_min; // Axis-Aligned Bounding Box do objeto
+    std::vector<glm::vec3>    bbox_max;
+    std::vector<int>          material; // Índice do material do objeto em g_Materials
+    std::vector<int>          lod_chain; // Índice em g_LodChains, ou -1 se o objeto possui um único nível de detalhe
 };
 
 // Abaixo definimos variáveis globais utilizadas em várias funções do código.
 
-// A cena virtual é uma lista de objetos nomeados, guardados em um dicionário
-// (map).  Veja dentro da função BuildTrianglesAndAddToVirtualScene() como que são incluídos
-// objetos dentro da variável g_VirtualScene, e veja na função main() como
-// estes são acessados.
-std::map<std::string, SceneObject> g_VirtualScene;
+// A cena virtual é uma lista de objetos nomeados. Veja dentro da função
+// BuildTrianglesAndAddToVirtualScene() como que são incluídos objetos dentro
+// da variável g_VirtualScene, e veja na função main() como os handles dos
+// objetos são obtidos (uma única vez) a partir de seus nomes.
+VirtualScene g_VirtualScene;
+
+// Funções de acesso à cena virtual g_VirtualScene. Definidas após main().
+SceneObjectHandle AddVirtualObject(const std::string& name, const MeshIndexRange& indices, GLenum rendering_mode, GLuint vertex_array_object_id, glm::vec3 bbox_min, glm::vec3 bbox_max, int material); // Insere (ou substitui) um objeto na cena
+SceneObjectHandle FindVirtualObject(uint32_t name_hash); // Busca o handle de um objeto pelo hash do nome
+SceneObjectHandle GetVirtualObject(uint32_t name_hash, const char* name); // Igual à acima, mas encerra o programa se o objeto não existir
+
+// Objetos gerados proceduralmente (veja "proceduralmesh.h") possuem vários
+// níveis de detalhe, todos no mesmo VAO. Cada nível é um objeto da cena
+// ("the_sphere@0", "the_sphere@1", ...), e todos, junto com o objeto de
+// nome base ("the_sphere", igual ao nível mais fino), apontam para a mesma
+// LodChain. A cada quadro, DrawScene() troca o objeto de cada comando pelo
+// nível mais grosseiro cujo erro na tela não passa de g_LodMaxScreenError
+// pixels. Veja SelectLevelsOfDetail().
+struct LodChain
+{
+    ProceduralShape                shape;
+    std::vector<SceneObjectHandle> levels; // Do mais grosseiro (0) ao mais fino
+};
+std::vector<LodChain> g_LodChains;
+float g_LodMaxScreenError = 0.5f; // Pixels; zero desenha sempre o nível mais fino
+SceneObjectHandle AddProceduralObject(const std::string& name, ProceduralShape shape); // Gera (ou reutiliza) os níveis de detalhe de uma forma e os insere na cena
+
+// Funcionalidades que um material pode declarar. Cada combinação destas
+// (máscara de bits) corresponde a uma variante especializada do programa de
+// GPU, compilada com os #defines de mesmo nome em "shader_fragment.glsl".
+// Assim, cada fragmento executa somente o código do seu material, sem
+// desvios condicionais e sem amostrar texturas que não utiliza.
+#define MATERIAL_DIFFUSE_MAP   (1u << 0) // Refletância difusa lida de uma textura
+#define MATERIAL_SPHERICAL_UV  (1u << 1) // Coordenadas de textura por projeção esférica
+#define MATERIAL_PLANAR_UV     (1u << 2) // Coordenadas de textura por projeção planar (plano XY)
+#define MATERIAL_NIGHT_MAP     (1u << 3) // Textura adicional para a parte não iluminada
+#define MATERIAL_PHONG         (1u << 4) // Termo especular de Phong
+#define MATERIAL_SPOTLIGHT     (1u << 5) // Iluminação por uma fonte de luz do tipo spotlight (tecla L)
+#define MATERIAL_POINT_LIGHTS  (1u << 6) // Fontes de luz pontuais adicionais (g_PointLights)
+#define MATERIAL_NUM_FEATURES  7
+
+// Bit da variante sem cor utilizada pela passada de profundidade (veja
+// DrawDepthPrePass()). Não é uma funcionalidade de material: nenhum
+// material o utiliza.
+#define GPU_PROGRAM_DEPTH_ONLY (1u << 31)
+
+// Nomes dos #defines correspondentes a cada bit acima (na mesma ordem).
+const char* const g_MaterialFeatureNames[MATERIAL_NUM_FEATURES] = {
+    "MATERIAL_DIFFUSE_MAP",
+    "MATERIAL_SPHERICAL_UV",
+    "MATERIAL_PLANAR_UV",
+    "MATERIAL_NIGHT_MAP",
+    "MATERIAL_PHONG",
+    "MATERIAL_SPOTLIGHT",
+    "MATERIAL_POINT_LIGHTS",
+};
+
+// Estrutura que define um material: as funcionalidades utilizadas (que
+// selecionam a variante do programa de GPU) e seus parâmetros. Os parâmetros
+// são preenchidos a partir dos arquivos MTL, quando existirem. Veja
+// CreateMaterial().
+struct Material
+{
+    std::string  name;
+    uint32_t     features;  // Combinação dos bits MATERIAL_* acima
+    glm::vec3    Ka;        // Refletância ambiente
+    glm::vec3    Kd;        // Refletância difusa (multiplica a textura, se existir)
+    glm::vec3    Ks;        // Refletância especular
+    float        q;         // Expoente especular de Phong
+    GLint        diffuse_texture_unit; // Unidade de textura da refletância difusa (MATERIAL_DIFFUSE_MAP)
+    GLint        night_texture_unit;   // Unidade de textura da parte noturna (MATERIAL_NIGHT_MAP)
+};
+
+// Todos os materiais da cena. Objetos referenciam materiais pelo índice.
+std::vector<Material> g_Materials;
+
+// Materiais já criados a partir de um MTL, indexados por (modelo, índice do
+// material em ObjModel::materials). Os objetos que utilizam o mesmo material
+// MTL (inclusive as cópias da cena de estresse) compartilham o mesmo
+// Material, e sua textura difusa é carregada uma única vez. Os modelos devem
+// existir até o final de main(). Veja BuildTrianglesAndAddToVirtualScene().
+std::map<std::pair<const ObjModel*, int>, int> g_MtlMaterials;
+
+// Programa de GPU (variante especializada para uma máscara de
+// funcionalidades), junto com os handles de suas variáveis "uniform". Os
+// valores são enviados através de ShaderProgram_Set*(), que ignora os que
+// não mudaram; veja "shaderprogram.h".
+struct GpuProgram
+{
+    ShaderProgram shader;
+    int model_uniform;
+    int view_uniform;
+    int projection_uniform;
+    int model_view_projection_uniform;
+    int normal_matrix_uniform;
+    int camera_position_world_uniform;
+    int bbox_min_uniform;
+    int bbox_max_uniform;
+    int Ka_uniform;
+    int Kd_uniform;
+    int Ks_uniform;
+    int q_uniform;
+    int diffuse_texture_uniform;
+    int night_texture_uniform;
+    int num_point_lights_uniform;
+    int point_light_position_uniform;
+    int point_light_color_uniform;
+    int spotlight_position_uniform;
+    int spotlight_direction_uniform;
+    int spotlight_cos_angle_uniform;
+};
+
+// Cache de variantes do programa de GPU, indexado pela máscara de
+// funcionalidades. Cada variante é compilada uma única vez. Veja
+// GetGpuProgram() e LoadShadersFromFiles().
+std::map<uint32_t, GpuProgram> g_GpuProgramCache;
+
+// Variante do programa de GPU sendo compilada durante uma recarga dos
+// shaders. Veja StartShaderReload() e UpdateShaderReload().
+struct PendingGpuProgram
+{
+    uint32_t    features;
+    GLuint      vertex_shader_id;   // Zero se o programa veio do cache em disco
+    GLuint      fragment_shader_id;
+    GLuint      program_id;
+    std::string vertex_source;
+    std::string fragment_source;
+};
+
+// Variantes da recarga em andamento. Enquanto esta lista não estiver vazia,
+// os quadros continuam sendo desenhados com os programas de
+// g_GpuProgramCache.
+std::vector<PendingGpuProgram> g_PendingGpuPrograms;
+unsigned int g_PendingShaderReloadFrames = 0;
+
+// Suporte a compilação paralela de shaders (GL_KHR_parallel_shader_compile
+// ou GL_ARB_parallel_shader_compile). Veja InitParallelShaderCompile().
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+bool g_ParallelShaderCompile = false;
+void InitParallelShaderCompile();
+
+// Fontes de luz pontuais utilizadas pelos materiais com
+// MATERIAL_POINT_LIGHTS (somente na cena de estresse, opção --stress).
+std::vector<StressLight> g_PointLights;
+
+// Fonte de luz do tipo "spotlight", posicionada acima da cena e apontando
+// para baixo, com abertura de 30 graus. A tecla L liga/desliga
+// MATERIAL_SPOTLIGHT em todos os materiais; a variante com spotlight é
+// compilada no primeiro quadro em que for utilizada. Veja KeyCallback().
+bool      g_SpotlightEnabled   = false;
+glm::vec4 g_SpotlightPosition  = glm::vec4(0.0f, 2.0f, 1.0f, 1.0f);
+glm::vec4 g_SpotlightDirection = glm::vec4(0.0f, -1.0f, 0.0f, 0.0f);
+float     g_SpotlightCosAngle  = 0.8660254f; // cos(30 graus)
+
+// Comando de desenho de um objeto da cena com uma matriz de modelagem e um
+// material. A cada quadro main() monta uma lista destes comandos, que é
+// ordenada por variante do programa de GPU antes de ser desenhada. Veja
+// DrawScene().
+struct DrawCommand
+{
+    SceneObjectHandle object;
+    int               material; // Índice em g_Materials
+    glm::mat4         model;
+};
+
+// Matrizes de modelagem e "model_view_projection" dos comandos de desenho do
+// quadro atual, computadas em lote por DrawScene(). Os vetores são mantidos
+// entre quadros para evitar realocações.
+std::vector<glm::mat4> g_DrawModelMatrices;
+std::vector<glm::mat4> g_DrawModelViewProjectionMatrices;
+
+// Funções de materiais e programas de GPU. Definidas após main().
+int CreateMaterial(const ObjModel* model, const tinyobj::material_t* mtl); // Cria um material (a partir de um MTL, se existir)
+GpuProgram& GetGpuProgram(uint32_t features); // Busca (ou compila) a variante do programa para as funcionalidades
+void SetModelMatrix(GpuProgram& program, const glm::mat4& model, const glm::mat4& model_view_projection); // Envia a matriz de modelagem (e derivadas) para a GPU
+void DrawVirtualObject(GpuProgram& program, SceneObjectHandle object); // Desenha um objeto armazenado em g_VirtualScene
+void DrawScene(std::vector<DrawCommand>& draw_list, const glm::mat4& view, const glm::mat4& projection, const glm::vec4& camera_position); // Desenha uma lista de objetos agrupados por variante
+void DrawDepthPrePass(const std::vector<DrawCommand>& draw_list, const glm::mat4& view, const glm::mat4& projection); // Desenha somente a profundidade da lista
+void SelectLevelsOfDetail(std::vector<DrawCommand>& draw_list, const glm::mat4& projection, const glm::vec4& camera_position); // Escolhe o nível de detalhe de cada objeto procedural
+
+// A simulação da cena (entrada do usuário, câmera e animações) executa em uma
+// thread separada da renderização, com passo de tempo fixo. A cada passo,
+// ela publica um "snapshot" imutável do estado necessário para desenhar um
+// quadro. A thread principal (renderização) interpola entre os dois últimos
+// snapshots recebidos e desenha. Veja SimulationThread().
+const double SIMULATION_TIMESTEP  = 1.0 / 60.0; // Passo de tempo fixo da simulação (segundos)
+const int    SIMULATION_MAX_STEPS = 8; // Máximo de passos executados de uma vez, caso a simulação se atrase
+
+struct FrameSnapshot
+{
+    double    time;            // Instante simulado, no mesmo relógio de glfwGetTime()
+    float     camera_theta;    // Câmera em coordenadas esféricas. Veja g_CameraTheta.
+    float     camera_phi;
+    float     camera_distance;
+    glm::vec3 euler_angles;    // g_AngleX, g_AngleY e g_AngleZ
+    bool      use_perspective_projection;
+    bool      animating;       // Existe alguma animação ativa (a cena muda com o tempo)
+    std::vector<DrawCommand> draw_list;
+
+    // Objetos que nunca mudam (cena de estresse). A lista é imutável e
+    // compartilhada por todos os snapshots, em vez de copiada a cada passo
+    // de simulação; se existir, substitui "draw_list".
+    std::shared_ptr<const std::vector<DrawCommand>> static_draw_list;
+};
+
+// Objetos da cena desenhados pela simulação, resolvidos em main(). Se a
+// cena de estresse estiver habilitada (opção --stress), ela substitui os três
+// objetos padrão. Veja BuildStressScene().
+struct SimulationScene
+{
+    SceneObjectHandle sphere;
+    SceneObjectHandle bunny;
+    SceneObjectHandle plane;
+    std::shared_ptr<const std::vector<DrawCommand>> stress_instances; // NULL sem a cena de estresse
+};
+
+// Eventos de entrada recebidos pelos callbacks da GLFW (que sempre executam
+// na thread principal), repassados à thread de simulação.
+enum InputEventType
+{
+    INPUT_EVENT_KEY,
+    INPUT_EVENT_MOUSE_BUTTON,
+    INPUT_EVENT_CURSOR_POS,
+    INPUT_EVENT_SCROLL
+};
+
+struct InputEvent
+{
+    InputEventType type;
+    int    key;    // Tecla ou botão do mouse
+    int    action;
+    int    mods;
+    double x;      // Posição do cursor, ou deslocamento da "rodinha"
+    double y;
+};
+
+SpscQueue<InputEvent, 1024> g_InputQueue;   // Thread principal -> simulação
+TripleBuffer<FrameSnapshot> g_FrameSnapshots; // Simulação -> thread principal
+std::atomic<bool> g_SimulationRunning(true);
+
+// Quando não há animações ativas nem entrada do usuário, a simulação dorme
+// esperando por um evento de entrada (veja PushInputEvent()), em vez de
+// executar passos que não mudariam nada.
+std::mutex              g_SimulationWakeMutex;
+std::condition_variable g_SimulationWake;
+bool                    g_SimulationWakeRequested = false;
+
+// Renderização sob demanda: um quadro só é desenhado quando algo na tela
+// mudou. Qualquer thread pode marcar o quadro como "sujo" com
+// InvalidateFrame(); enquanto nada estiver sujo e não houver animações
+// ativas, a thread principal fica bloqueada em glfwWaitEventsTimeout().
+std::atomic<bool> g_FrameDirty(true);
+void InvalidateFrame();
+
+void SimulationThread(SimulationScene scene, double simulation_start); // Loop da thread de simulação
+bool SimulationAdvance(double& simulation_time, double now); // Executa os passos de simulação até o instante "now"
+void BuildFrameSnapshot(FrameSnapshot& frame, double time, const SimulationScene& scene); // Monta o snapshot do estado atual
+void BuildStressScene(const StressSceneParams& params, ObjModel* const models[3], SimulationScene& scene); // Cria as malhas, materiais e instâncias da cena de estresse
+void PushInputEvent(const InputEvent& event); // Repassa um evento de entrada para a simulação
+void InterpolateFrameSnapshots(const FrameSnapshot& a, const FrameSnapshot& b, double time, FrameSnapshot& frame); // Interpola dois snapshots
+
+// Gravação (opção --record) e reprodução (opção --replay) dos eventos de
+// entrada e dos instantes dos quadros desenhados. Na reprodução não existe
+// thread de simulação: ela avança na thread principal, seguindo um relógio
+// virtual que só depende da gravação, de forma que duas reproduções da mesma
+// gravação desenham exatamente os mesmos quadros. O relógio da simulação
+// parte do mesmo instante da execução gravada, e cada evento é aplicado no
+// passo de simulação em que a execução gravada o recebeu (o primeiro passo
+// que termina depois do instante do evento). Veja "inputlog.cpp".
+double g_RecordingStartTime = 0.0; // Instante (glfwGetTime()) do início da gravação
+std::vector<InputLogRecord> g_ReplayRecords;
+double g_ReplaySimulationStart = 0.0; // Instante inicial da simulação na gravação
+size_t g_ReplayNextFrame = 0;         // Próximo registro INPUT_LOG_FRAME a ser lido
+size_t g_ReplayNextEvent = 0;         // Próximo registro INPUT_LOG_EVENT a ser repassado
+bool ReplayNextFrame(double& frame_time); // Busca o instante do próximo quadro gravado
+bool ReplaySimulationAdvance(GLFWwindow* window, double& simulation_time, double now); // Avança a simulação da reprodução até "now", repassando os eventos gravados
 
 // Pilha que guardará as matrizes de modelagem.
 std::stack<glm::mat4>  g_MatrixStack;
 
-// Razão de proporção da janela (largura/altura). Veja função FramebufferSizeCallback().
+// Razão de proporção da janela (largura/altura) e altura em pixels. Veja
+// função FramebufferSizeCallback().
 float g_ScreenRatio = 1.0f;
+int   g_ScreenWidth = 800;
+int   g_ScreenHeight = 600;
+
+// As variáveis abaixo, até g_UsePerspectiveProjection, formam o estado da
+// simulação: elas são lidas e modificadas SOMENTE pela thread de simulação.
+// A renderização utiliza as cópias contidas nos snapshots (FrameSnapshot).
+
+// Tempo (segundos) das animações da cena, que só avança enquanto elas
+// estiverem habilitadas. Veja tecla A em SimulationKey().
+double g_AnimationTime = 0.0;
+bool   g_AnimationsEnabled = true;
 
 // Ângulos de Euler que controlam a rotação de um dos cubos da cena virtual
 float g_AngleX = 0.0f;
@@ -191,9 +481,9 @@ bool g_RightMouseButtonPressed = false; // Análogo para botão direito do mouse
 bool g_MiddleMouseButtonPressed = false; // Análogo para botão do meio do mouse
 
 // Variáveis que definem a câmera em coordenadas esféricas, controladas pelo
-// usuário através do mouse (veja função CursorPosCallback()). A posição
+// usuário através do mouse (veja função SimulationCursorPos()). A posição
 // efetiva da câmera é calculada dentro da função main(), dentro do loop de
-// renderização.
+// renderização, a partir dos snapshots da simulação.
 float g_CameraTheta = 0.0f; // Ângulo no plano ZX em relação ao eixo Z
 float g_CameraPhi = 0.0f;   // Ângulo em relação ao eixo Y
 float g_CameraDistance = 3.5f; // Distância da câmera para a origem
@@ -212,20 +502,158 @@ bool g_UsePerspectiveProjection = true;
 // Variável que controla se o texto informativo será mostrado na tela.
 bool g_ShowInfoText = true;
 
-// Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
-GLuint g_GpuProgramID = 0;
-GLint g_model_uniform;
-GLint g_view_uniform;
-GLint g_projection_uniform;
-GLint g_object_id_uniform;
-GLint g_bbox_min_uniform;
-GLint g_bbox_max_uniform;
+// Variáveis que controlam o modo de benchmark (tecla B), o qual mede o tempo
+// de GPU gasto desenhando a cena a cada quadro. A tecla V alterna entre as
+// matrizes pré-computadas na CPU e o caminho antigo, onde os shaders compõem
+// as matrizes para cada vértice/fragmento, permitindo comparar os dois.
+bool g_BenchmarkMode = false;
+bool g_UseLegacyShaderMatrices = false;
+
+// Valor de g_UseLegacyShaderMatrices pedido pela tecla V. Só passa a valer
+// quando a recarga dos shaders iniciada pela tecla terminar com sucesso,
+// já que os programas em uso (e suas variáveis, veja
+// QueryGpuProgramUniforms()) foram compilados para o valor anterior.
+bool g_RequestedLegacyShaderMatrices = false;
 
 // Número de texturas carregadas pela função LoadTextureImage()
 GLuint g_NumLoadedTextures = 0;
 
+// Objetos OpenGL das texturas e dos modelos carregados. São liberados ao
+// final de main(), antes de GpuResources_Shutdown(). Veja "gpuresources.h".
+std::vector<GpuTexture> g_Textures;
+std::vector<GpuSampler> g_Samplers;
+std::vector<ObjMeshGpu> g_ObjMeshes;
+
 int main(int argc, char* argv[])
 {
+    // Opções de linha de comando. Argumentos que não são opções são o nome
+    // de um modelo ".obj" adicional a ser carregado.
+    //
+    //    --trace[=arquivo.json]   Grava uma linha do tempo dos eventos do
+    //                             programa, escrita ao final da execução
+    //                             (padrão: "trace.json"). Veja "trace.cpp".
+    //
+    //    --headless[=quadros]     Benchmark sem janela visível: desenha o
+    //                             número dado de quadros (padrão: 600) em um
+    //                             framebuffer offscreen, seguindo um caminho
+    //                             de câmera fixo, e termina. Veja "headless.cpp".
+    //    --benchmark-output=arquivo.json
+    //                             Onde escrever os tempos medidos no modo
+    //                             --headless (padrão: "benchmark.json").
+    //    --benchmark-image=arquivo.ppm
+    //                             Escreve também a imagem do último quadro.
+    //
+    //    --record=arquivo         Grava os eventos de entrada e os instantes
+    //                             dos quadros desenhados.
+    //    --replay=arquivo         Reproduz uma gravação e termina. Combinada
+    //                             com --headless, mede os quadros da
+    //                             gravação em vez do caminho de câmera fixo.
+    //
+    //    --stress=instâncias      Substitui a cena padrão por muitas cópias
+    //                             da esfera, do coelho e do plano. Veja
+    //                             "stressscene.cpp". Parâmetros adicionais:
+    //    --stress-layout=grid|random|clusters
+    //    --stress-meshes=N        Malhas distintas (padrão: 3)
+    //    --stress-textures=N      Texturas distintas (padrão: 2)
+    //    --stress-lights=N        Fontes de luz pontuais (padrão: 0, até 16)
+    //    --stress-seed=N          Semente da distribuição (padrão: 1)
+    //
+    //    --lod-error=pixels       Erro máximo na tela dos níveis de detalhe
+    //                             das malhas procedurais (padrão: 0.5). Com
+    //                             0, desenha sempre o nível mais fino.
+    //
+    //    --stream-buffer=map|orphan
+    //                             Como os vértices do texto são enviados à
+    //                             GPU: mapeando o buffer circular (padrão)
+    //                             ou com buffers órfãos. Veja
+    //                             "streambuffer.h".
+    //
+    //    --depth-prepass=auto|on|off
+    //                             Passada de profundidade antes da de cor:
+    //                             decidida pelo overdraw medido (padrão),
+    //                             sempre ou nunca. Veja "depthprepass.h" e
+    //                             tecla D.
+    const char* extra_model_filename = NULL;
+    bool        headless = false;
+    int         headless_num_frames = 600;
+    const char* benchmark_output_filename = "benchmark.json";
+    const char* benchmark_image_filename = NULL;
+    const char* record_filename = NULL;
+    const char* replay_filename = NULL;
+    StressSceneParams stress_params = StressScene_DefaultParams();
+    StreamBufferMode  stream_mode = STREAM_BUFFER_MAP;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ( strcmp(argv[i], "--trace") == 0 )
+            Trace_Init("trace.json");
+        else if ( strncmp(argv[i], "--trace=", 8) == 0 )
+            Trace_Init(argv[i] + 8);
+        else if ( strcmp(argv[i], "--headless") == 0 )
+            headless = true;
+        else if ( strncmp(argv[i], "--headless=", 11) == 0 )
+        {
+            headless = true;
+            headless_num_frames = atoi(argv[i] + 11);
+            if ( headless_num_frames <= 0 )
+            {
+                fprintf(stderr, "ERROR: Invalid number of frames \"%s\".\n", argv[i] + 11);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if ( strncmp(argv[i], "--benchmark-output=", 19) == 0 )
+            benchmark_output_filename = argv[i] + 19;
+        else if ( strncmp(argv[i], "--benchmark-image=", 18) == 0 )
+            benchmark_image_filename = argv[i] + 18;
+        else if ( strncmp(argv[i], "--record=", 9) == 0 )
+            record_filename = argv[i] + 9;
+        else if ( strncmp(argv[i], "--replay=", 9) == 0 )
+            replay_filename = argv[i] + 9;
+        else if ( strncmp(argv[i], "--lod-error=", 12) == 0 )
+        {
+            g_LodMaxScreenError = (float)atof(argv[i] + 12);
+            if ( g_LodMaxScreenError < 0.0f )
+            {
+                fprintf(stderr, "ERROR: Invalid level of detail error \"%s\".\n", argv[i] + 12);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if ( strcmp(argv[i], "--stream-buffer=map") == 0 )
+            stream_mode = STREAM_BUFFER_MAP;
+        else if ( strcmp(argv[i], "--stream-buffer=orphan") == 0 )
+            stream_mode = STREAM_BUFFER_ORPHAN;
+        else if ( strcmp(argv[i], "--depth-prepass=auto") == 0 )
+            DepthPrePass_SetMode(DEPTH_PREPASS_AUTO);
+        else if ( strcmp(argv[i], "--depth-prepass=on") == 0 )
+            DepthPrePass_SetMode(DEPTH_PREPASS_ON);
+        else if ( strcmp(argv[i], "--depth-prepass=off") == 0 )
+            DepthPrePass_SetMode(DEPTH_PREPASS_OFF);
+        else if ( StressScene_ParseOption(argv[i], stress_params) )
+            continue;
+        else
+            extra_model_filename = argv[i];
+    }
+
+    if ( record_filename != NULL && (replay_filename != NULL || headless) )
+    {
+        fprintf(stderr, "ERROR: --record cannot be combined with --replay or --headless.\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Na reprodução, o modo --headless desenha todos os quadros gravados.
+    if ( replay_filename != NULL )
+    {
+        if ( !InputLog_Load(replay_filename, g_ReplayRecords, g_ReplaySimulationStart) )
+            std::exit(EXIT_FAILURE);
+
+        headless_num_frames = 0;
+        for (size_t i = 0; i < g_ReplayRecords.size(); ++i)
+            if ( g_ReplayRecords[i].type == INPUT_LOG_FRAME )
+                headless_num_frames += 1;
+    }
+    const bool replaying = (replay_filename != NULL);
+    Trace_SetThreadName("main");
+    double startup_begin = Trace_Now();
+
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
     // sistema operacional, onde poderemos renderizar com OpenGL.
     int success = glfwInit();
@@ -250,6 +678,11 @@ int main(int argc, char* argv[])
     // funções modernas de OpenGL.
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    // No modo --headless a janela existe somente para que tenhamos um
+    // contexto OpenGL: ela nunca é mostrada.
+    if ( headless )
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
     // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
     // de pixels, e com título "INF01047 ...".
     GLFWwindow* window;
@@ -261,15 +694,21 @@ int main(int argc, char* argv[])
         std::exit(EXIT_FAILURE);
     }
 
-    // Definimos a função de callback que será chamada sempre que o usuário
-    // pressionar alguma tecla do teclado ...
-    glfwSetKeyCallback(window, KeyCallback);
-    // ... ou clicar os botões do mouse ...
-    glfwSetMouseButtonCallback(window, MouseButtonCallback);
-    // ... ou movimentar o cursor do mouse em cima da janela ...
-    glfwSetCursorPosCallback(window, CursorPosCallback);
-    // ... ou rolar a "rodinha" do mouse.
-    glfwSetScrollCallback(window, ScrollCallback);
+    // Durante uma reprodução (--replay), os eventos de entrada vêm somente da
+    // gravação (veja ReplayNextFrame()), e os callbacks abaixo não são
+    // definidos.
+    if ( !replaying )
+    {
+        // Definimos a função de callback que será chamada sempre que o usuário
+        // pressionar alguma tecla do teclado ...
+        glfwSetKeyCallback(window, KeyCallback);
+        // ... ou clicar os botões do mouse ...
+        glfwSetMouseButtonCallback(window, MouseButtonCallback);
+        // ... ou movimentar o cursor do mouse em cima da janela ...
+        glfwSetCursorPosCallback(window, CursorPosCallback);
+        // ... ou rolar a "rodinha" do mouse.
+        glfwSetScrollCallback(window, ScrollCallback);
+    }
 
     // Indicamos que as chamadas OpenGL deverão renderizar nesta janela
     glfwMakeContextCurrent(window);
@@ -278,12 +717,27 @@ int main(int argc, char* argv[])
     // biblioteca GLAD.
     gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
 
+    // Estado OpenGL espelhado na CPU: as trocas de estado passam por
+    // GlState_*(), que elimina as redundantes. Objetos deletados são
+    // desligados pelo OpenGL, então a cópia precisa ser avisada. Veja
+    // "glstate.h".
+    GpuResources_SetDeleteCallback(GlState_ObjectDeleted);
+
     // Definimos a função de callback que será chamada sempre que a janela for
     // redimensionada, por consequência alterando o tamanho do "framebuffer"
     // (região de memória onde são armazenados os pixels da imagem).
     glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
     FramebufferSizeCallback(window, 800, 600); // Forçamos a chamada do callback acima, para definir g_ScreenRatio.
 
+    // No modo --headless desenhamos em um framebuffer offscreen do mesmo
+    // tamanho da janela, o qual fica ligado durante toda a execução.
+    HeadlessTarget headless_target;
+    if ( headless && !Headless_CreateTarget(headless_target, 800, 600) )
+    {
+        glfwTerminate();
+        std::exit(EXIT_FAILURE);
+    }
+
     // Imprimimos no terminal informações sobre a GPU do sistema
     const GLubyte *vendor      = glGetString(GL_VENDOR);
     const GLubyte *renderer    = glGetString(GL_RENDERER);
@@ -291,50 +745,293 @@ int main(int argc, char* argv[])
     const GLubyte *glslversion = glGetString(GL_SHADING_LANGUAGE_VERSION);
 
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
+    printf("CPU: núcleos de matrizes %s\n", MatrixKernels_InstructionSet());
 
-    // Carregamos os shaders de vértices e de fragmentos que serão utilizados
-    // para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
-    //
-    LoadShadersFromFiles();
+    // Inicializamos o cache em disco de programas de GPU já compilados,
+    // guardado no diretório "shadercache" ao lado do executável. Veja
+    // "programcache.cpp".
+    ProgramCache_Init("shadercache");
+
+    // Habilitamos a compilação de shaders em threads do driver, caso
+    // suportada, para que a recarga dos shaders não trave a renderização.
+    InitParallelShaderCompile();
 
     // Carregamos duas imagens para serem utilizadas como textura
-    LoadTextureImage("../../data/tc-earth_daymap_surface.jpg");      // TextureImage0
-    LoadTextureImage("../../data/tc-earth_nightmap_citylights.gif"); // TextureImage1
+    GLint earth_day_texture   = LoadTextureImage("../../data/tc-earth_daymap_surface.jpg");
+    GLint earth_night_texture = LoadTextureImage("../../data/tc-earth_nightmap_citylights.gif");
 
-    // Construímos a representação de objetos geométricos através de malhas de triângulos
-    ObjModel spheremodel("../../data/sphere.obj");
-    ComputeNormals(&spheremodel);
-    BuildTrianglesAndAddToVirtualScene(&spheremodel);
+    // Construímos a representação de objetos geométricos através de malhas
+    // de triângulos. A esfera e o plano são gerados proceduralmente, em
+    // vários níveis de detalhe, ao invés de lidos de "sphere.obj" e
+    // "plane.obj" (o nível 0 da grade é o mesmo quadrado de "plane.obj"). Veja
+    // AddProceduralObject().
+    AddProceduralObject("the_sphere", PROCEDURAL_UV_SPHERE);
+    AddProceduralObject("the_plane", PROCEDURAL_PLANE_GRID);
 
     ObjModel bunnymodel("../../data/bunny.obj");
     ComputeNormals(&bunnymodel);
     BuildTrianglesAndAddToVirtualScene(&bunnymodel);
 
-    ObjModel planemodel("../../data/plane.obj");
-    ComputeNormals(&planemodel);
-    BuildTrianglesAndAddToVirtualScene(&planemodel);
+    // O modelo extra existe até o final de main(), como os demais (veja
+    // g_MtlMaterials).
+    std::unique_ptr<ObjModel> extra_model;
+    if ( extra_model_filename != NULL )
+    {
+        extra_model.reset(new ObjModel(extra_model_filename));
+        BuildTrianglesAndAddToVirtualScene(extra_model.get());
+    }
 
-    if ( argc > 1 )
+    // Buscamos os handles dos objetos da cena uma única vez, após o
+    // carregamento. O hash dos nomes é computado em tempo de compilação (as
+    // constantes constexpr abaixo obrigam isso), e dentro do loop de
+    // renderização os objetos são acessados somente por índice.
+    constexpr uint32_t the_sphere_hash = SceneObjectNameHash("the_sphere");
+    constexpr uint32_t the_bunny_hash  = SceneObjectNameHash("the_bunny");
+    constexpr uint32_t the_plane_hash  = SceneObjectNameHash("the_plane");
+    const SceneObjectHandle the_sphere = GetVirtualObject(the_sphere_hash, "the_sphere");
+    const SceneObjectHandle the_bunny  = GetVirtualObject(the_bunny_hash, "the_bunny");
+    const SceneObjectHandle the_plane  = GetVirtualObject(the_plane_hash, "the_plane");
+
+    // Definimos as funcionalidades dos materiais de cada objeto. Os modelos
+    // não possuem arquivos MTL, então todos utilizam a textura diurna da
+    // Terra, variando somente a projeção das coordenadas de textura.
+    Material& sphere_material = g_Materials[g_VirtualScene.material[the_sphere]];
+    sphere_material.features |= MATERIAL_DIFFUSE_MAP | MATERIAL_SPHERICAL_UV | MATERIAL_NIGHT_MAP;
+    sphere_material.diffuse_texture_unit = earth_day_texture;
+    sphere_material.night_texture_unit = earth_night_texture;
+
+    Material& bunny_material = g_Materials[g_VirtualScene.material[the_bunny]];
+    bunny_material.features |= MATERIAL_DIFFUSE_MAP | MATERIAL_PLANAR_UV;
+    bunny_material.diffuse_texture_unit = earth_day_texture;
+
+    Material& plane_material = g_Materials[g_VirtualScene.material[the_plane]];
+    plane_material.features |= MATERIAL_DIFFUSE_MAP;
+    plane_material.diffuse_texture_unit = earth_day_texture;
+
+    // Objetos desenhados pela simulação. A cena de estresse (opção --stress)
+    // é montada antes do carregamento dos shaders, para que as variantes dos
+    // seus materiais também sejam compiladas de antemão.
+    SimulationScene scene;
+    scene.sphere = the_sphere;
+    scene.bunny  = the_bunny;
+    scene.plane  = the_plane;
+    if ( stress_params.num_instances > 0 )
     {
-        ObjModel model(argv[1]);
-        BuildTrianglesAndAddToVirtualScene(&model);
+        ObjModel* const models[3] = { NULL, &bunnymodel, NULL }; // A esfera e o plano são procedurais
+        BuildStressScene(stress_params, models, scene);
     }
 
+    // Carregamos os shaders de vértices e de fragmentos que serão utilizados
+    // para renderização, compilando uma variante para cada combinação de
+    // funcionalidades dos materiais acima. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
+    //
+    LoadShadersFromFiles();
+
+    // Monitoramos os arquivos dos shaders: quando algum deles é salvo, os
+    // shaders são recarregados automaticamente. Veja "filewatcher.cpp".
+    FileWatcher_AddFile("../../src/shader_vertex.glsl");
+    FileWatcher_AddFile("../../src/shader_fragment.glsl");
+
     // Inicializamos o código para renderização de texto.
-    TextRendering_Init();
+    TextRendering_Init(stream_mode);
+
+    // Ligamos o vsync explicitamente (o padrão varia entre drivers), sem
+    // limite adicional de quadros por segundo. Veja teclas S e F em
+    // KeyCallback() e "framepacing.cpp".
+    FramePacing_SetSwapInterval(1);
+    FramePacing_SetFrameCap(0.0);
 
     // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
-    glEnable(GL_DEPTH_TEST);
+    GlState_SetEnabled(GL_DEPTH_TEST, true);
 
     // Habilitamos o Backface Culling. Veja slides 8-13 do documento Aula_02_Fundamentos_Matematicos.pdf, slides 23-34 do documento Aula_13_Clipping_and_Culling.pdf e slides 112-123 do documento Aula_14_Laboratorio_3_Revisao.pdf.
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    GlState_SetEnabled(GL_CULL_FACE, true);
+    GlState_CullFace(GL_BACK);
+    GlState_FrontFace(GL_CCW);
+
+    // Etapas de cada quadro medidas pelo profiler (tempo de CPU e, para as
+    // duas primeiras, de GPU). Os resultados são mostrados no modo de
+    // benchmark (tecla B). Veja "profiler.cpp".
+    const int scene_pass = Profiler_RegisterPass("scene", true);
+    const int text_pass  = Profiler_RegisterPass("text", true);
+    const int swap_pass  = Profiler_RegisterPass(headless ? "finish" : "swap", false);
+
+    // Iniciamos a thread de simulação, e esperamos pelo seu primeiro
+    // snapshot. Mantemos sempre os dois últimos snapshots recebidos
+    // (previous_frame e current_frame), e o quadro desenhado ("frame") é a
+    // interpolação entre eles. Os snapshots são declarados fora do loop para
+    // que a memória de suas listas de desenho seja reaproveitada entre quadros.
+    //
+    // No modo --headless não existe thread de simulação: cada quadro é
+    // montado pela própria thread principal, em um instante simulado que só
+    // depende do número do quadro, e o texto informativo (que depende do
+    // relógio) não é mostrado. Assim, o quadro i é sempre idêntico. O mesmo
+    // vale para uma reprodução (--replay), onde a simulação avança na thread
+    // principal seguindo o relógio virtual da gravação.
+    std::thread simulation_thread;
+    FrameSnapshot previous_frame;
+    FrameSnapshot current_frame;
+    FrameSnapshot frame;
+    int headless_frame = -HEADLESS_WARMUP_FRAMES;
+    bool woke_from_idle = false; // Houve uma espera por eventos desde o último snapshot
+
+    // Cópia local de frame.static_draw_list, que DrawScene() pode reordenar.
+    // Só é refeita quando a lista compartilhada muda.
+    std::vector<DrawCommand> static_draw_list;
+    const std::vector<DrawCommand>* static_draw_list_source = NULL;
+    double replay_time = 0.0;            // Relógio virtual da reprodução
+    double replay_simulation_time = g_ReplaySimulationStart; // Instante simulado da reprodução
+
+    if ( headless )
+    {
+        g_ShowInfoText = false;
+        FramePacing_SetSwapInterval(0);
+    }
+
+    if ( headless || replaying )
+    {
+        BuildFrameSnapshot(current_frame, replay_simulation_time, scene);
+        previous_frame = current_frame;
+        frame = current_frame;
+    }
+    else
+    {
+        // A gravação começa junto com a simulação. A diferença entre os
+        // dois relógios vai para o cabeçalho da gravação, para que a
+        // reprodução execute os passos de simulação nos mesmos instantes.
+        const double simulation_start = glfwGetTime();
+        if ( record_filename != NULL )
+        {
+            g_RecordingStartTime = glfwGetTime();
+            if ( !InputLog_StartRecording(record_filename, simulation_start - g_RecordingStartTime) )
+            {
+                glfwTerminate();
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        simulation_thread = std::thread(SimulationThread, scene, simulation_start);
+
+        while ( !g_FrameSnapshots.Update() )
+            std::this_thread::yield();
+
+        previous_frame = g_FrameSnapshots.ReadBuffer();
+        current_frame = previous_frame;
+        frame = current_frame;
+    }
+
+    // Registramos no trace todo o tempo de inicialização até aqui.
+    Trace_Event("Startup", NULL, startup_begin, Trace_Now());
 
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
     {
+        // Instante mostrado pelo quadro: a cena é interpolada um passo de
+        // simulação antes dele. Veja InterpolateFrameSnapshots().
+        double frame_time = 0.0;
+
+        // No modo --headless, as medições começam após os quadros de
+        // aquecimento (headless_frame negativo).
+        if ( headless )
+        {
+            if ( headless_frame == headless_num_frames )
+                break;
+            if ( headless_frame == 0 )
+                Profiler_StartFrameLog();
+        }
+
+        if ( replaying )
+        {
+            // Na reprodução, avançamos a simulação até o instante do próximo
+            // quadro gravado, repassando os eventos gravados nos passos em
+            // que foram recebidos. Os quadros de aquecimento do modo
+            // --headless repetem o quadro inicial, sem consumir a gravação.
+            UpdateShaderReload();
+
+            if ( !headless || headless_frame >= 0 )
+            {
+                if ( !ReplayNextFrame(replay_time) )
+                    break;
+
+                if ( ReplaySimulationAdvance(window, replay_simulation_time, replay_time) )
+                {
+                    previous_frame = current_frame;
+                    BuildFrameSnapshot(current_frame, replay_simulation_time, scene);
+                }
+            }
+            frame_time = replay_time;
+        }
+        else if ( headless )
+        {
+            // No modo --headless, posicionamos a câmera no caminho fixo e
+            // montamos o quadro diretamente.
+            int path_frame = std::max(headless_frame, 0);
+            Headless_CameraPath(path_frame, headless_num_frames, g_CameraTheta, g_CameraPhi, g_CameraDistance);
+            g_AnimationTime = path_frame * SIMULATION_TIMESTEP;
+            BuildFrameSnapshot(frame, g_AnimationTime, scene);
+        }
+        else
+        {
+            // Se algum arquivo de shader foi modificado, iniciamos sua recarga.
+            // A compilação acontece em segundo plano; enquanto ela não termina,
+            // continuamos desenhando com os programas antigos.
+            if ( FileWatcher_Poll() )
+                StartShaderReload();
+            UpdateShaderReload();
+
+            // Pegamos o snapshot mais recente publicado pela simulação, caso
+            // exista um novo. Desenhamos a cena um passo de simulação "atrasada"
+            // em relação ao relógio, de forma que o instante desenhado fique
+            // (quase sempre) entre os dois últimos snapshots, e interpolamos.
+            if ( g_FrameSnapshots.Update() )
+            {
+                previous_frame = current_frame;
+                current_frame = g_FrameSnapshots.ReadBuffer();
+                g_FrameDirty = true;
+
+                // Depois de uma espera por eventos, o snapshot anterior é de
+                // antes da espera: interpolar a partir dele faria os primeiros
+                // quadros mostrarem um estado velho. Partimos do novo snapshot.
+                if ( woke_from_idle )
+                    previous_frame = current_frame;
+                woke_from_idle = false;
+            }
+
+            // Só desenhamos um novo quadro se algo mudou: um evento do usuário ou
+            // da janela, um novo snapshot, uma animação ativa, ou uma
+            // interpolação que ainda não chegou ao último snapshot. O modo de
+            // benchmark sempre desenha. Caso contrário, esperamos por eventos sem
+            // consumir CPU nem GPU; o timeout mantém a verificação dos arquivos
+            // de shader (e da recarga em andamento) funcionando.
+            bool animating = current_frame.animating || frame.time < current_frame.time;
+            if ( !g_FrameDirty.exchange(false) && !animating && !g_BenchmarkMode )
+            {
+                TraceScope trace("WaitEvents");
+                FramePacing_Idle();
+                glfwWaitEventsTimeout(g_PendingGpuPrograms.empty() ? 0.25 : 0.01);
+                woke_from_idle = true;
+                continue;
+            }
+
+            frame_time = glfwGetTime();
+
+            // Gravamos o instante de cada quadro desenhado (opção --record).
+            if ( InputLog_IsRecording() )
+            {
+                InputLogRecord record;
+                memset(&record, 0, sizeof(record));
+                record.type = INPUT_LOG_FRAME;
+                record.time = frame_time - g_RecordingStartTime;
+                InputLog_Record(record);
+            }
+        }
+
+        if ( headless )
+            headless_frame += 1;
+
         // Aqui executamos as operações de renderização
+        Profiler_BeginFrame();
+        Profiler_BeginPass(scene_pass);
 
         // Definimos a cor do "fundo" do framebuffer como branco.  Tal cor é
         // definida como coeficientes RGBA: Red, Green, Blue, Alpha; isto é:
@@ -348,18 +1045,16 @@ int main(int argc, char* argv[])
         // e também resetamos todos os pixels do Z-buffer (depth buffer).
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
-        // os shaders de vértice e fragmentos).
-        glUseProgram(g_GpuProgramID);
+        if ( !headless || replaying )
+            InterpolateFrameSnapshots(previous_frame, current_frame, frame_time - SIMULATION_TIMESTEP, frame);
 
-        // Computamos a posição da câmera utilizando coordenadas esféricas.  As
-        // variáveis g_CameraDistance, g_CameraPhi, e g_CameraTheta são
-        // controladas pelo mouse do usuário. Veja as funções CursorPosCallback()
-        // e ScrollCallback().
-        float r = g_CameraDistance;
-        float y = r*sin(g_CameraPhi);
-        float z = r*cos(g_CameraPhi)*cos(g_CameraTheta);
-        float x = r*cos(g_CameraPhi)*sin(g_CameraTheta);
+        // Computamos a posição da câmera utilizando coordenadas esféricas.  Os
+        // parâmetros da câmera são controlados pelo mouse do usuário. Veja as
+        // funções SimulationCursorPos() e SimulationScroll().
+        float r = frame.camera_distance;
+        float y = r*sin(frame.camera_phi);
+        float z = r*cos(frame.camera_phi)*cos(frame.camera_theta);
+        float x = r*cos(frame.camera_phi)*sin(frame.camera_theta);
 
         // Abaixo definimos as varáveis que efetivamente definem a câmera virtual.
         // Veja slides 195-227 e 229-234 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
@@ -380,7 +1075,7 @@ int main(int argc, char* argv[])
         float nearplane = -0.1f;  // Posição do "near plane"
         float farplane  = -10.0f; // Posição do "far plane"
 
-        if (g_UsePerspectiveProjection)
+        if (frame.use_perspective_projection)
         {
             // Projeção Perspectiva.
             // Para definição do field of view (FOV), veja slides 205-215 do documento Aula_09_Projecoes.pdf.
@@ -393,66 +1088,72 @@ int main(int argc, char* argv[])
             // Para definição dos valores l, r, b, t ("left", "right", "bottom", "top"),
             // PARA PROJEÇÃO ORTOGRÁFICA veja slides 219-224 do documento Aula_09_Projecoes.pdf.
             // Para simular um "zoom" ortográfico, computamos o valor de "t"
-            // utilizando a variável g_CameraDistance.
-            float t = 1.5f*g_CameraDistance/2.5f;
+            // utilizando a distância da câmera.
+            float t = 1.5f*frame.camera_distance/2.5f;
             float b = -t;
             float r = t*g_ScreenRatio;
             float l = -r;
             projection = Matrix_Orthographic(l, r, b, t, nearplane, farplane);
         }
 
-        glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
-
-        // Enviamos as matrizes "view" e "projection" para a placa de vídeo
-        // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
-        // efetivamente aplicadas em todos os pontos.
-        glUniformMatrix4fv(g_view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
-        glUniformMatrix4fv(g_projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
-
-        #define SPHERE 0
-        #define BUNNY  1
-        #define PLANE  2
-
-        // Desenhamos o modelo da esfera
-        model = Matrix_Translate(-1.0f,0.0f,0.0f)
-              * Matrix_Rotate_Z(0.6f)
-              * Matrix_Rotate_X(0.2f)
-              * Matrix_Rotate_Y(g_AngleY + (float)glfwGetTime() * 0.1f);
-        glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, SPHERE);
-        DrawVirtualObject("the_sphere");
-
-        // Desenhamos o modelo do coelho
-        model = Matrix_Translate(1.0f,0.0f,0.0f)
-              * Matrix_Rotate_X(g_AngleX + (float)glfwGetTime() * 0.1f);
-        glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, BUNNY);
-        DrawVirtualObject("the_bunny");
-
-        // Desenhamos o plano do chão
-        model = Matrix_Translate(0.0f,-1.1f,0.0f);
-        glUniformMatrix4fv(g_model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, PLANE);
-        DrawVirtualObject("the_plane");
+        // Desenhamos a lista de objetos montada pela simulação. Veja
+        // BuildFrameSnapshot().
+        if ( frame.static_draw_list )
+        {
+            if ( frame.static_draw_list.get() != static_draw_list_source )
+            {
+                static_draw_list = *frame.static_draw_list;
+                static_draw_list_source = frame.static_draw_list.get();
+            }
+            DrawScene(static_draw_list, view, projection, camera_position_c);
+        }
+        else
+        {
+            DrawScene(frame.draw_list, view, projection, camera_position_c);
+        }
+
+        Profiler_EndPass(scene_pass);
+        Profiler_BeginPass(text_pass);
+
+        // No modo de benchmark, mostramos os tempos medidos pelo profiler.
+        if ( g_BenchmarkMode )
+            TextRendering_ShowProfiler(window);
 
         // Imprimimos na tela os ângulos de Euler que controlam a rotação do
         // terceiro cubo.
-        TextRendering_ShowEulerAngles(window);
+        TextRendering_ShowEulerAngles(window, frame.euler_angles);
 
         // Imprimimos na informação sobre a matriz de projeção sendo utilizada.
-        TextRendering_ShowProjection(window);
+        TextRendering_ShowProjection(window, frame.use_perspective_projection);
 
         // Imprimimos na tela informação sobre o número de quadros renderizados
         // por segundo (frames per second).
         TextRendering_ShowFramesPerSecond(window);
 
+        TextRendering_EndFrame();
+        Profiler_EndPass(text_pass);
+
         // O framebuffer onde OpenGL executa as operações de renderização não
         // é o mesmo que está sendo mostrado para o usuário, caso contrário
         // seria possível ver artefatos conhecidos como "screen tearing". A
         // chamada abaixo faz a troca dos buffers, mostrando para o usuário
         // tudo que foi renderizado pelas funções acima.
         // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
-        glfwSwapBuffers(window);
+        //
+        // A troca é feita por FramePacing_Present(), que antes espera pelo
+        // instante do próximo quadro caso exista um limite de FPS. No modo
+        // --headless não há o que apresentar: esperamos a GPU terminar o
+        // quadro, de forma que o tempo de CPU do quadro inclua o da GPU.
+        Profiler_BeginPass(swap_pass);
+        if ( headless )
+            glFinish();
+        else
+            FramePacing_Present(window);
+        Profiler_EndPass(swap_pass);
+
+        Profiler_EndFrame();
+        GlState_EndFrame();
+        ShaderProgram_EndFrame();
 
         // Verificamos com o sistema operacional se houve alguma interação do
         // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
@@ -461,22 +1162,87 @@ int main(int argc, char* argv[])
         glfwPollEvents();
     }
 
+    // Finalizamos a thread de simulação, acordando-a caso esteja esperando
+    // por eventos de entrada.
+    g_SimulationRunning = false;
+    {
+        std::lock_guard<std::mutex> lock(g_SimulationWakeMutex);
+        g_SimulationWakeRequested = true;
+    }
+    g_SimulationWake.notify_one();
+    if ( simulation_thread.joinable() )
+        simulation_thread.join();
+
+    // Terminamos a gravação (opção --record).
+    if ( InputLog_IsRecording() )
+    {
+        InputLog_StopRecording();
+        printf("Entrada gravada em \"%s\".\n", record_filename);
+    }
+    else if ( replaying && !headless )
+    {
+        printf("Reprodução de \"%s\" concluída (%d quadros).\n", replay_filename, headless_num_frames);
+    }
+
+    // Escrevemos os resultados do modo --headless.
+    int exit_status = EXIT_SUCCESS;
+    if ( headless )
+    {
+        Profiler_StopFrameLog();
+        if ( !Headless_WriteResults(benchmark_output_filename, headless_target) )
+            exit_status = EXIT_FAILURE;
+        if ( benchmark_image_filename != NULL && !Headless_WriteImage(benchmark_image_filename, headless_target) )
+            exit_status = EXIT_FAILURE;
+        Headless_DestroyTarget(headless_target);
+    }
+
+    // Liberamos os objetos OpenGL da cena. Qualquer objeto criado através de
+    // GpuResources_Create() que ainda existir é relatado como vazamento.
+    DiscardShaderReload();
+    for (std::map<uint32_t, GpuProgram>::iterator it = g_GpuProgramCache.begin(); it != g_GpuProgramCache.end(); ++it)
+        GpuResources_Release(GPU_PROGRAM, it->second.shader.program_id);
+    g_GpuProgramCache.clear();
+    TextRendering_Shutdown();
+    DepthPrePass_Shutdown();
+    g_ObjMeshes.clear();
+    ProceduralMesh_ClearCache();
+    g_Samplers.clear();
+    g_Textures.clear();
+    GpuResources_PrintStats();
+    GpuResources_Shutdown();
+
+    // Escrevemos o trace de eventos, caso habilitado (opção --trace).
+    Trace_Shutdown();
+
     // Finalizamos o uso dos recursos do sistema operacional
     glfwTerminate();
 
     // Fim do programa
-    return 0;
+    return exit_status;
 }
 
-// Função que carrega uma imagem para ser utilizada como textura
-void LoadTextureImage(const char* filename)
+// Função que carrega uma imagem para ser utilizada como textura. Retorna a
+// unidade de textura onde a imagem foi carregada.
+GLint LoadTextureImage(const char* filename)
 {
-    printf("Carregando imagem \"%s\"... ", filename);
+    TraceScope trace("LoadTextureImage", Trace_Intern(filename));
 
-    // Primeiro fazemos a leitura da imagem do disco
-    stbi_set_flip_vertically_on_load(true);
     int width;
     int height;
+    unsigned char* data = DecodeTextureImage(filename, width, height);
+    GLint textureunit = UploadTextureImage(data, width, height);
+    stbi_image_free(data);
+
+    return textureunit;
+}
+
+// Lê do disco a imagem "filename", com três canais (RGB). Encerra o programa
+// se a imagem não puder ser lida.
+unsigned char* DecodeTextureImage(const char* filename, int& width, int& height)
+{
+    printf("Carregando imagem \"%s\"... ", filename);
+
+    stbi_set_flip_vertically_on_load(true);
     int channels;
     unsigned char *data = stbi_load(filename, &width, &height, &channels, 3);
 
@@ -486,122 +1252,1221 @@ void LoadTextureImage(const char* filename)
         std::exit(EXIT_FAILURE);
     }
 
-    printf("OK (%dx%d).\n", width, height);
+    printf("OK (%dx%d).\n", width, height);
+    return data;
+}
+
+// Cria uma textura (e seu sampler) com a imagem RGB "data", já lida do disco,
+// em uma nova unidade de textura. Retorna a unidade de textura.
+GLint UploadTextureImage(const unsigned char* data, int width, int height)
+{
+    // Criamos objetos na GPU com OpenGL para armazenar a textura
+    g_Textures.push_back(GpuTexture("LoadTextureImage texture"));
+    g_Samplers.push_back(GpuSampler("LoadTextureImage sampler"));
+    GLuint texture_id = g_Textures.back().id;
+    GLuint sampler_id = g_Samplers.back().id;
+
+    // Veja slides 95-96 do documento Aula_20_Mapeamento_de_Texturas.pdf
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Parâmetros de amostragem da textura.
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Agora enviamos a imagem lida do disco para a GPU
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    GLuint textureunit = g_NumLoadedTextures;
+    GlState_BindTexture(textureunit, GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GlState_BindSampler(textureunit, sampler_id);
+    g_Textures.back().SetSize((size_t)width * height * 4 * 4 / 3); // GL_SRGB8 costuma ocupar 4 bytes por texel; +1/3 para os mipmaps
+
+    g_NumLoadedTextures += 1;
+
+    return textureunit;
+}
+
+// Função que insere um objeto na cena virtual, retornando seu handle. Caso já
+// exista um objeto com o mesmo nome, este é substituído (mantendo o handle).
+SceneObjectHandle AddVirtualObject(
+    const std::string& name,
+    const MeshIndexRange& indices,
+    GLenum rendering_mode,
+    GLuint vertex_array_object_id,
+    glm::vec3 bbox_min,
+    glm::vec3 bbox_max,
+    int material
+)
+{
+    const uint32_t name_hash = SceneObjectNameHash(name.c_str());
+
+    SceneObjectHandle object = FindVirtualObject(name_hash);
+    if ( object != INVALID_SCENE_OBJECT && g_VirtualScene.name[object] != name )
+    {
+        // Dois nomes distintos com o mesmo hash: não conseguiríamos
+        // diferenciá-los em DrawVirtualObject(). Extremamente improvável, mas
+        // detectamos aqui, no carregamento, ao invés de desenhar o objeto errado.
+        fprintf(stderr, "ERROR: Hash collision between objects \"%s\" and \"%s\".\n", g_VirtualScene.name[object].c_str(), name.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+
+    if ( object == INVALID_SCENE_OBJECT )
+    {
+        object = (SceneObjectHandle)g_VirtualScene.name.size();
+        g_VirtualScene.name.push_back(name);
+        g_VirtualScene.name_hash.push_back(name_hash);
+        g_VirtualScene.trace_name.push_back(Trace_Intern(name));
+        g_VirtualScene.indices.push_back(MeshIndexRange());
+        g_VirtualScene.rendering_mode.push_back(GL_TRIANGLES);
+        g_VirtualScene.vertex_array_object_id.push_back(0);
+        g_VirtualScene.bbox_min.push_back(glm::vec3(0.0f));
+        g_VirtualScene.bbox_max.push_back(glm::vec3(0.0f));
+        g_VirtualScene.material.push_back(0);
+        g_VirtualScene.lod_chain.push_back(-1);
+    }
+
+    g_VirtualScene.indices[object]                = indices;
+    g_VirtualScene.rendering_mode[object]         = rendering_mode;
+    g_VirtualScene.vertex_array_object_id[object] = vertex_array_object_id;
+    g_VirtualScene.bbox_min[object]               = bbox_min;
+    g_VirtualScene.bbox_max[object]               = bbox_max;
+    g_VirtualScene.material[object]               = material;
+
+    return object;
+}
+
+// Função que busca o handle de um objeto a partir do hash de seu nome. Faz uma
+// busca linear, e portanto deve ser chamada somente no carregamento da cena,
+// nunca dentro do loop de renderização.
+SceneObjectHandle FindVirtualObject(uint32_t name_hash)
+{
+    for (size_t i = 0; i < g_VirtualScene.name_hash.size(); ++i)
+        if ( g_VirtualScene.name_hash[i] == name_hash )
+            return (SceneObjectHandle)i;
+
+    return INVALID_SCENE_OBJECT;
+}
+
+// Função análoga a FindVirtualObject(), porém encerra o programa caso o objeto
+// não exista na cena. O nome é utilizado somente na mensagem de erro.
+SceneObjectHandle GetVirtualObject(uint32_t name_hash, const char* name)
+{
+    SceneObjectHandle object = FindVirtualObject(name_hash);
+    if ( object == INVALID_SCENE_OBJECT )
+    {
+        fprintf(stderr, "ERROR: Object \"%s\" not found in virtual scene.\n", name);
+        std::exit(EXIT_FAILURE);
+    }
+    return object;
+}
+
+// Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
+// dos objetos na função BuildTrianglesAndAddToVirtualScene().
+void DrawVirtualObject(GpuProgram& program, SceneObjectHandle object)
+{
+    TraceScope trace("DrawVirtualObject", g_VirtualScene.trace_name[object]);
+
+    // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
+    // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
+    // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
+    // Objetos consecutivos que compartilham o VAO (ex.: cópias da cena de
+    // estresse) não trocam o estado; veja "glstate.h".
+    GlState_BindVertexArray(g_VirtualScene.vertex_array_object_id[object]);
+
+    // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
+    // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
+    const glm::vec3& bbox_min = g_VirtualScene.bbox_min[object];
+    const glm::vec3& bbox_max = g_VirtualScene.bbox_max[object];
+    // Objetos consecutivos do mesmo modelo não reenviam estes valores.
+    const glm::vec4 bbox_min_point(bbox_min, 1.0f);
+    const glm::vec4 bbox_max_point(bbox_max, 1.0f);
+    ShaderProgram_Set4fv(program.shader, program.bbox_min_uniform, 1, glm::value_ptr(bbox_min_point));
+    ShaderProgram_Set4fv(program.shader, program.bbox_max_uniform, 1, glm::value_ptr(bbox_max_point));
+
+    // Pedimos para a GPU rasterizar os vértices dos eixos XYZ
+    // apontados pelo VAO como linhas. Veja a definição dos objetos de
+    // g_VirtualScene dentro da função BuildTrianglesAndAddToVirtualScene(), e veja
+    // a documentação da função glDrawElementsBaseVertex() em
+    // http://docs.gl/gl3/glDrawElementsBaseVertex. O tipo dos índices
+    // depende do número de vértices do objeto; veja "meshindices.h".
+    MeshIndices_Draw(g_VirtualScene.rendering_mode[object], g_VirtualScene.indices[object]);
+}
+
+// Função que envia para a GPU a matriz de modelagem de um objeto, junto com as
+// matrizes derivadas dela que os shaders utilizam. Estas são computadas uma
+// única vez por objeto, ao invés de uma vez por vértice em
+// "shader_vertex.glsl": o vertex shader faz somente produtos matriz-vetor. A
+// matriz "model_view_projection" é computada em lote para todos os objetos
+// do quadro por DrawScene().
+void SetModelMatrix(GpuProgram& program, const glm::mat4& model, const glm::mat4& model_view_projection)
+{
+    glm::mat4 normal_matrix = Matrix_Normal(model);
+
+    ShaderProgram_SetMatrix4fv(program.shader, program.model_uniform                 , 1 , glm::value_ptr(model));
+    ShaderProgram_SetMatrix4fv(program.shader, program.model_view_projection_uniform , 1 , glm::value_ptr(model_view_projection));
+    ShaderProgram_SetMatrix4fv(program.shader, program.normal_matrix_uniform         , 1 , glm::value_ptr(normal_matrix));
+}
+
+// Função de comparação utilizada por DrawScene() para ordenar os comandos de
+// desenho: primeiro pela variante do programa de GPU, depois pelo material, e
+// por fim pelo objeto (para que a ordem seja determinística).
+static bool CompareDrawCommands(const DrawCommand& a, const DrawCommand& b)
+{
+    const int material_a = a.material;
+    const int material_b = b.material;
+    const uint32_t features_a = g_Materials[material_a].features;
+    const uint32_t features_b = g_Materials[material_b].features;
+
+    if ( features_a != features_b )
+        return features_a < features_b;
+    if ( material_a != material_b )
+        return material_a < material_b;
+    return a.object < b.object;
+}
+
+// Função que troca o objeto de cada comando que possui níveis de detalhe
+// (veja LodChain) pelo nível mais grosseiro cujo erro na tela não passa de
+// g_LodMaxScreenError pixels. O erro de um nível é conhecido para a forma de
+// raio 1 (ProceduralMesh_Error()); ele é multiplicado pela escala do objeto
+// e pelo número de pixels por unidade na distância do objeto à câmera.
+void SelectLevelsOfDetail(std::vector<DrawCommand>& draw_list, const glm::mat4& projection, const glm::vec4& camera_position)
+{
+    if ( g_LodChains.empty() )
+        return;
+
+    // Na projeção perspectiva (w' depende de z, e projection[3][3] == 0), o
+    // número de pixels por unidade diminui com a distância; na ortográfica,
+    // é constante. projection[1][1] é a escala do eixo Y para NDC, que
+    // ocupa g_ScreenHeight/2 pixels por unidade.
+    const bool perspective = (projection[3][3] == 0.0f);
+    const float pixels_per_unit = 0.5f * g_ScreenHeight * fabs(projection[1][1]);
+
+    for (size_t i = 0; i < draw_list.size(); ++i)
+    {
+        DrawCommand& command = draw_list[i];
+        const int chain_index = g_VirtualScene.lod_chain[command.object];
+        if ( chain_index < 0 )
+            continue;
+        const LodChain& chain = g_LodChains[chain_index];
+
+        // Maior escala entre os eixos do objeto: a forma de raio 1 tem raio
+        // "scale" no sistema de coordenadas do mundo.
+        const glm::mat4& model = command.model;
+        const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+        float error_scale = scale * pixels_per_unit;
+        if ( perspective )
+        {
+            // Distância até o ponto do objeto mais próximo da câmera. Com a
+            // câmera dentro do objeto, usamos sempre o nível mais fino.
+            const float distance = glm::length(glm::vec3(model[3] - camera_position)) - scale;
+            error_scale = (distance > 0.0f) ? error_scale / distance : std::numeric_limits<float>::max();
+        }
+
+        command.object = chain.levels[ProceduralMesh_SelectLevel(chain.shape, error_scale, g_LodMaxScreenError)];
+    }
+}
+
+// Função que desenha uma lista de objetos. Os objetos são agrupados por
+// variante do programa de GPU, de forma que cada programa é ativado (e
+// recebe as matrizes da câmera) uma única vez por quadro, e os parâmetros de
+// cada material são enviados somente quando o material muda.
+void DrawScene(std::vector<DrawCommand>& draw_list, const glm::mat4& view, const glm::mat4& projection, const glm::vec4& camera_position)
+{
+    TraceScope trace("DrawScene");
+
+    // O nível de detalhe é escolhido antes da ordenação, para que comandos
+    // que passem a utilizar o mesmo nível fiquem juntos.
+    SelectLevelsOfDetail(draw_list, projection, camera_position);
+
+    std::sort(draw_list.begin(), draw_list.end(), CompareDrawCommands);
+
+    // O texto, desenhado depois da cena, não restaura o estado que altera.
+    GlState_SetEnabled(GL_BLEND, false);
+    GlState_DepthFunc(GL_LESS);
+
+    // Compomos as matrizes de projeção e de câmera uma única vez por
+    // quadro, e então computamos as matrizes "model_view_projection" de
+    // todos os objetos (já na ordem de desenho) em um único laço vetorizado.
+    // Veja "matrixkernels.h" e a função SetModelMatrix().
+    glm::mat4 view_projection = MatrixKernels_Multiply(projection, view);
+
+    g_DrawModelMatrices.resize(draw_list.size());
+    g_DrawModelViewProjectionMatrices.resize(draw_list.size());
+    for (size_t i = 0; i < draw_list.size(); ++i)
+        g_DrawModelMatrices[i] = draw_list[i].model;
+    MatrixKernels_MultiplyArray(view_projection, g_DrawModelMatrices.data(), g_DrawModelViewProjectionMatrices.data(), draw_list.size());
+
+    // Com a passada de profundidade, a profundidade final de cada pixel já
+    // está no Z-buffer quando a passada de cor começa: esta só colore os
+    // fragmentos com exatamente esta profundidade (GL_EQUAL), sem
+    // escrevê-la. O overdraw é medido na primeira das duas passadas que
+    // testa a profundidade contra a cena parcialmente desenhada. Veja
+    // "depthprepass.h".
+    const bool depth_prepass = DepthPrePass_BeginFrame();
+    DepthPrePass_BeginMeasure();
+    if ( depth_prepass )
+    {
+        DrawDepthPrePass(draw_list, view, projection);
+        DepthPrePass_EndMeasure(g_ScreenWidth, g_ScreenHeight);
+
+        GlState_DepthFunc(GL_EQUAL);
+        GlState_DepthMask(GL_FALSE);
+    }
+
+    GpuProgram* program = NULL;
+    uint32_t current_features = 0;
+    int current_material = -1;
+
+    for (size_t i = 0; i < draw_list.size(); ++i)
+    {
+        const DrawCommand& command = draw_list[i];
+        const int material_index = command.material;
+        const Material& material = g_Materials[material_index];
+
+        if ( program == NULL || material.features != current_features )
+        {
+            // Pedimos para a GPU utilizar a variante do programa de GPU
+            // (contendo os shaders de vértice e fragmentos) deste grupo.
+            program = &GetGpuProgram(material.features);
+            current_features = material.features;
+            current_material = -1;
+            GlState_UseProgram(program->shader.program_id);
+
+            // Enviamos as matrizes "view" e "projection" para a placa de vídeo
+            // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
+            // efetivamente aplicadas em todos os pontos.
+            ShaderProgram_SetMatrix4fv(program->shader, program->view_uniform       , 1 , glm::value_ptr(view));
+            ShaderProgram_SetMatrix4fv(program->shader, program->projection_uniform , 1 , glm::value_ptr(projection));
+
+            // A posição da câmera em coordenadas globais já é conhecida aqui na
+            // CPU, então não é necessário que o fragment shader a obtenha
+            // invertendo a matriz "view" para cada fragmento.
+            ShaderProgram_Set4fv(program->shader, program->camera_position_world_uniform, 1, glm::value_ptr(camera_position));
+
+            // Fontes de luz pontuais (somente variantes com
+            // MATERIAL_POINT_LIGHTS possuem estas variáveis). Cada vetor
+            // uniform é enviado com uma única chamada.
+            if ( (current_features & MATERIAL_POINT_LIGHTS) && !g_PointLights.empty() )
+            {
+                glm::vec4 light_positions[STRESS_MAX_LIGHTS];
+                glm::vec3 light_colors[STRESS_MAX_LIGHTS];
+                const GLsizei num_lights = (GLsizei)std::min(g_PointLights.size(), (size_t)STRESS_MAX_LIGHTS);
+                for (GLsizei j = 0; j < num_lights; ++j)
+                {
+                    light_positions[j] = g_PointLights[j].position;
+                    light_colors[j] = g_PointLights[j].color;
+                }
+                ShaderProgram_Set1i(program->shader, program->num_point_lights_uniform, num_lights);
+                ShaderProgram_Set4fv(program->shader, program->point_light_position_uniform, num_lights, glm::value_ptr(light_positions[0]));
+                ShaderProgram_Set3fv(program->shader, program->point_light_color_uniform, num_lights, glm::value_ptr(light_colors[0]));
+            }
+
+            // Parâmetros do spotlight (somente variantes com
+            // MATERIAL_SPOTLIGHT).
+            if ( current_features & MATERIAL_SPOTLIGHT )
+            {
+                ShaderProgram_Set4fv(program->shader, program->spotlight_position_uniform, 1, glm::value_ptr(g_SpotlightPosition));
+                ShaderProgram_Set4fv(program->shader, program->spotlight_direction_uniform, 1, glm::value_ptr(g_SpotlightDirection));
+                ShaderProgram_Set1f(program->shader, program->spotlight_cos_angle_uniform, g_SpotlightCosAngle);
+            }
+        }
+
+        if ( material_index != current_material )
+        {
+            current_material = material_index;
+            ShaderProgram_Set3fv(program->shader, program->Ka_uniform, 1, glm::value_ptr(material.Ka));
+            ShaderProgram_Set3fv(program->shader, program->Kd_uniform, 1, glm::value_ptr(material.Kd));
+            ShaderProgram_Set3fv(program->shader, program->Ks_uniform, 1, glm::value_ptr(material.Ks));
+            ShaderProgram_Set1f(program->shader, program->q_uniform, material.q);
+            ShaderProgram_Set1i(program->shader, program->diffuse_texture_uniform, material.diffuse_texture_unit);
+            ShaderProgram_Set1i(program->shader, program->night_texture_uniform, material.night_texture_unit);
+        }
+
+        SetModelMatrix(*program, command.model, g_DrawModelViewProjectionMatrices[i]);
+        DrawVirtualObject(*program, command.object);
+    }
+
+    if ( !depth_prepass )
+        DepthPrePass_EndMeasure(g_ScreenWidth, g_ScreenHeight);
+
+    // glClear() do Z-buffer no próximo quadro respeita glDepthMask().
+    GlState_DepthMask(GL_TRUE);
+}
+
+// Desenha somente a profundidade dos objetos de "draw_list", com a variante
+// GPU_PROGRAM_DEPTH_ONLY do programa de GPU: a mesma posição dos vértices
+// da passada de cor (veja "invariant gl_Position" em "shader_vertex.glsl"),
+// sem atributos interpolados e com um fragment shader vazio. As matrizes
+// "model_view_projection" são as já computadas por DrawScene().
+void DrawDepthPrePass(const std::vector<DrawCommand>& draw_list, const glm::mat4& view, const glm::mat4& projection)
+{
+    TraceScope trace("DrawDepthPrePass");
+
+    GpuProgram& program = GetGpuProgram(GPU_PROGRAM_DEPTH_ONLY);
+    GlState_UseProgram(program.shader.program_id);
+
+    // Somente utilizadas pelo caminho antigo (tecla V).
+    ShaderProgram_SetMatrix4fv(program.shader, program.view_uniform       , 1 , glm::value_ptr(view));
+    ShaderProgram_SetMatrix4fv(program.shader, program.projection_uniform , 1 , glm::value_ptr(projection));
+
+    GlState_ColorMask(false);
+    GlState_DepthMask(GL_TRUE);
+    GlState_DepthFunc(GL_LESS);
+
+    for (size_t i = 0; i < draw_list.size(); ++i)
+    {
+        const SceneObjectHandle object = draw_list[i].object;
+        ShaderProgram_SetMatrix4fv(program.shader, program.model_uniform, 1, glm::value_ptr(draw_list[i].model));
+        ShaderProgram_SetMatrix4fv(program.shader, program.model_view_projection_uniform, 1, glm::value_ptr(g_DrawModelViewProjectionMatrices[i]));
+
+        GlState_BindVertexArray(g_VirtualScene.vertex_array_object_id[object]);
+        MeshIndices_Draw(g_VirtualScene.rendering_mode[object], g_VirtualScene.indices[object]);
+    }
+
+    GlState_ColorMask(true);
+}
+
+// Função que cria um material, retornando seu índice em g_Materials. Se "mtl"
+// não for NULL, os parâmetros são lidos do material de um arquivo MTL
+// carregado pela tinyobjloader (textura difusa incluída); caso contrário,
+// utilizamos um material branco difuso, cuja textura e funcionalidades
+// devem ser definidas por quem o utiliza.
+int CreateMaterial(const ObjModel* model, const tinyobj::material_t* mtl)
+{
+    Material material;
+    material.name = "default";
+    material.features = 0;
+    material.Ka = glm::vec3(0.0f, 0.0f, 0.0f);
+    material.Kd = glm::vec3(1.0f, 1.0f, 1.0f);
+    material.Ks = glm::vec3(0.0f, 0.0f, 0.0f);
+    material.q = 1.0f;
+    material.diffuse_texture_unit = 0;
+    material.night_texture_unit = 0;
+
+    if ( mtl != NULL )
+    {
+        material.name = mtl->name;
+        material.Ka = glm::vec3(mtl->ambient[0], mtl->ambient[1], mtl->ambient[2]);
+        material.Kd = glm::vec3(mtl->diffuse[0], mtl->diffuse[1], mtl->diffuse[2]);
+        material.Ks = glm::vec3(mtl->specular[0], mtl->specular[1], mtl->specular[2]);
+        material.q = mtl->shininess;
+
+        // Materiais com refletância especular utilizam o modelo de Phong.
+        if ( material.Ks != glm::vec3(0.0f, 0.0f, 0.0f) )
+            material.features |= MATERIAL_PHONG;
+
+        // A textura difusa ("map_Kd") é carregada do mesmo diretório do MTL.
+        if ( !mtl->diffuse_texname.empty() )
+        {
+            std::string filename = model->basepath + mtl->diffuse_texname;
+            material.diffuse_texture_unit = LoadTextureImage(filename.c_str());
+            material.features |= MATERIAL_DIFFUSE_MAP;
+        }
+    }
+
+    g_Materials.push_back(material);
+    return (int)g_Materials.size() - 1;
+}
+
+// Monta os #defines que especializam os shaders para a máscara de
+// funcionalidades "features". "legacy" seleciona as matrizes compostas
+// dentro dos shaders (veja g_UseLegacyShaderMatrices).
+std::string BuildShaderDefines(uint32_t features, bool legacy)
+{
+    std::string defines;
+
+    // No modo de benchmark, o caminho antigo (matrizes compostas dentro dos
+    // shaders) pode ser selecionado através de um #define. Veja tecla V em
+    // KeyCallback().
+    if ( legacy )
+        defines += "#define LEGACY_PER_VERTEX_MATRICES\n";
+
+    if ( features & GPU_PROGRAM_DEPTH_ONLY )
+        defines += "#define DEPTH_ONLY\n";
+
+    for (int i = 0; i < MATERIAL_NUM_FEATURES; ++i)
+    {
+        if ( features & (1u << i) )
+        {
+            defines += "#define ";
+            defines += g_MaterialFeatureNames[i];
+            defines += "\n";
+        }
+    }
+
+    // O tamanho dos arrays de luzes pontuais vem do C++, para que o shader
+    // e a cena de estresse (veja "stressscene.h") concordem.
+    if ( features & MATERIAL_POINT_LIGHTS )
+        defines += "#define MAX_POINT_LIGHTS " + std::to_string(STRESS_MAX_LIGHTS) + "\n";
+
+    return defines;
+}
+
+// Busca as variáveis definidas dentro dos shaders do programa "program",
+// compilado para as funcionalidades "features". Utilizaremos estas variáveis
+// para enviar dados para a placa de vídeo (GPU)! Veja arquivo
+// "shader_vertex.glsl" e "shader_fragment.glsl".
+//
+// O compilador GLSL remove as variáveis que a variante não utiliza (ex.:
+// "bbox_min" sem projeção de coordenadas de textura). Estas são buscadas
+// como opcionais; as demais devem estar ativas, e escritas em uma delas que
+// tenha sido removida geram um aviso. Veja "shaderprogram.h".
+void QueryGpuProgramUniforms(GpuProgram& program, GLuint program_id, uint32_t features)
+{
+    char label[64];
+    snprintf(label, sizeof(label), "material variant 0x%02x", (unsigned int)features);
+    ShaderProgram_Reflect(program.shader, program_id, label);
+
+    ShaderProgram& shader = program.shader;
+    const bool legacy = g_UseLegacyShaderMatrices;
+    const bool depth  = (features & GPU_PROGRAM_DEPTH_ONLY) != 0;
+    const bool phong  = (features & MATERIAL_PHONG) != 0;
+    const bool uv     = (features & (MATERIAL_SPHERICAL_UV | MATERIAL_PLANAR_UV)) != 0;
+    const bool lights = (features & MATERIAL_POINT_LIGHTS) != 0;
+    const bool spot   = (features & MATERIAL_SPOTLIGHT) != 0;
+
+    program.model_uniform                 = ShaderProgram_Uniform(shader, "model", legacy || !depth); // Variável da matriz "model"
+    program.view_uniform                  = ShaderProgram_Uniform(shader, "view", legacy); // Variável da matriz "view" em shader_vertex.glsl
+    program.projection_uniform            = ShaderProgram_Uniform(shader, "projection", legacy); // Variável da matriz "projection" em shader_vertex.glsl
+    program.model_view_projection_uniform = ShaderProgram_Uniform(shader, "model_view_projection", !legacy); // Variável "model_view_projection" em shader_vertex.glsl
+    program.normal_matrix_uniform         = ShaderProgram_Uniform(shader, "normal_matrix", !legacy && !depth); // Variável "normal_matrix" em shader_vertex.glsl
+    program.camera_position_world_uniform = ShaderProgram_Uniform(shader, "camera_position_world", !legacy && phong); // Variável "camera_position_world" em shader_fragment.glsl
+    program.bbox_min_uniform              = ShaderProgram_Uniform(shader, "bbox_min", uv);
+    program.bbox_max_uniform              = ShaderProgram_Uniform(shader, "bbox_max", uv);
+    program.Ka_uniform                    = ShaderProgram_Uniform(shader, "material_Ka", !depth);
+    program.Kd_uniform                    = ShaderProgram_Uniform(shader, "material_Kd", !depth);
+    program.Ks_uniform                    = ShaderProgram_Uniform(shader, "material_Ks", phong);
+    program.q_uniform                     = ShaderProgram_Uniform(shader, "material_q", phong);
+    program.diffuse_texture_uniform       = ShaderProgram_Uniform(shader, "DiffuseTexture", (features & MATERIAL_DIFFUSE_MAP) != 0); // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
+    program.night_texture_uniform         = ShaderProgram_Uniform(shader, "NightTexture", (features & MATERIAL_NIGHT_MAP) != 0);
+    program.num_point_lights_uniform      = ShaderProgram_Uniform(shader, "num_point_lights", lights); // Fontes de luz pontuais (MATERIAL_POINT_LIGHTS)
+    program.point_light_position_uniform  = ShaderProgram_Uniform(shader, "point_light_position", lights);
+    program.point_light_color_uniform     = ShaderProgram_Uniform(shader, "point_light_color", lights);
+    program.spotlight_position_uniform    = ShaderProgram_Uniform(shader, "spotlight_position", spot); // Fonte de luz spotlight (MATERIAL_SPOTLIGHT)
+    program.spotlight_direction_uniform   = ShaderProgram_Uniform(shader, "spotlight_direction", spot);
+    program.spotlight_cos_angle_uniform   = ShaderProgram_Uniform(shader, "spotlight_cos_angle", spot);
+
+    // Os atributos de vértice são enviados nas localizações fixas definidas
+    // por ObjModel_Upload(); veja "objmodel.h".
+    const char* const attributes[3] = { "model_coefficients", "normal_coefficients", "texture_coefficients" };
+    for (GLint i = 0; i < 3; ++i)
+    {
+        GLint location = ShaderProgram_AttributeLocation(shader, attributes[i]);
+        if ( location != -1 && location != i )
+            fprintf(stderr, "WARNING: Attribute \"%s\" is at location %d in program \"%s\", expected %d.\n", attributes[i], location, label, i);
+    }
+}
+
+// Função que retorna a variante do programa de GPU especializada para a
+// máscara de funcionalidades "features". Caso esta variante ainda não
+// exista no cache g_GpuProgramCache, ela é compilada aqui, inserindo um
+// #define para cada funcionalidade no início dos shaders.
+GpuProgram& GetGpuProgram(uint32_t features)
+{
+    std::map<uint32_t, GpuProgram>::iterator it = g_GpuProgramCache.find(features);
+    if ( it != g_GpuProgramCache.end() )
+        return it->second;
+
+    TraceScope trace("GetGpuProgram");
+
+    std::string defines = BuildShaderDefines(features, g_UseLegacyShaderMatrices);
+
+    // Note que o caminho para os arquivos "shader_vertex.glsl" e
+    // "shader_fragment.glsl" estão fixados, sendo que assumimos a existência
+    // da seguinte estrutura no sistema de arquivos:
+    //
+    //    + FCG_Lab_01/
+    //    |
+    //    +--+ bin/
+    //    |  |
+    //    |  +--+ Release/  (ou Debug/ ou Linux/)
+    //    |     |
+    //    |     o-- main.exe
+    //    |
+    //    +--+ src/
+    //       |
+    //       o-- shader_vertex.glsl
+    //       |
+    //       o-- shader_fragment.glsl
+    //
+    std::string vertex_source = LoadShaderSource("../../src/shader_vertex.glsl", defines.c_str());
+    std::string fragment_source = LoadShaderSource("../../src/shader_fragment.glsl", defines.c_str());
+
+    // Buscamos o programa no cache em disco. Se ele não estiver lá (ou se o
+    // código-fonte, os #defines ou o driver mudaram), compilamos os shaders
+    // e guardamos o programa resultante no cache.
+    GLuint program_id = ProgramCache_Load(vertex_source, fragment_source);
+    if ( program_id == 0 )
+    {
+        GLuint vertex_shader_id = LoadShader_Vertex("../../src/shader_vertex.glsl", vertex_source);
+        GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment.glsl", fragment_source);
+
+        // Criamos um programa de GPU utilizando os shaders carregados acima.
+        program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+        ProgramCache_Store(program_id, vertex_source, fragment_source);
+    }
+
+    GpuProgram& program = g_GpuProgramCache[features];
+    QueryGpuProgramUniforms(program, program_id, features);
+    return program;
+}
+
+// Função que carrega os shaders de vértices e de fragmentos que serão
+// utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
+//
+// Descartamos todas as variantes já compiladas, e compilamos novamente uma
+// variante para cada combinação de funcionalidades utilizada pelos
+// materiais da cena (veja GetGpuProgram()). Assim, nenhuma compilação
+// acontece durante o desenho dos quadros.
+void LoadShadersFromFiles()
+{
+    TraceScope trace("LoadShadersFromFiles");
+
+    // Deletamos os programas de GPU anteriores, caso existam.
+    for (std::map<uint32_t, GpuProgram>::iterator it = g_GpuProgramCache.begin(); it != g_GpuProgramCache.end(); ++it)
+        GpuResources_Release(GPU_PROGRAM, it->second.shader.program_id);
+    g_GpuProgramCache.clear();
+
+    for (size_t i = 0; i < g_Materials.size(); ++i)
+        GetGpuProgram(g_Materials[i].features);
+    GetGpuProgram(GPU_PROGRAM_DEPTH_ONLY);
+}
+
+// Habilita a compilação paralela de shaders, caso o driver suporte a
+// extensão GL_KHR_parallel_shader_compile (ou sua antecessora ARB). Com ela,
+// glCompileShader() e glLinkProgram() retornam imediatamente e o driver
+// compila em suas próprias threads; podemos então perguntar se a compilação
+// terminou com GL_COMPLETION_STATUS_KHR, sem bloquear. Como a biblioteca
+// GLAD deste projeto carrega somente OpenGL 3.3, buscamos a função
+// manualmente com glfwGetProcAddress().
+// Veja https://registry.khronos.org/OpenGL/extensions/KHR/KHR_parallel_shader_compile.txt
+void InitParallelShaderCompile()
+{
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+    MaxShaderCompilerThreadsProc max_shader_compiler_threads = NULL;
+
+    if ( glHasExtension("GL_KHR_parallel_shader_compile") )
+        max_shader_compiler_threads = (MaxShaderCompilerThreadsProc) glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    else if ( glHasExtension("GL_ARB_parallel_shader_compile") )
+        max_shader_compiler_threads = (MaxShaderCompilerThreadsProc) glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+
+    g_ParallelShaderCompile = (max_shader_compiler_threads != NULL);
+    if ( g_ParallelShaderCompile )
+    {
+        // 0xFFFFFFFF: o driver escolhe o número de threads.
+        max_shader_compiler_threads(0xFFFFFFFF);
+        printf("Compilação paralela de shaders habilitada.\n");
+    }
+}
+
+// Descarta a recarga de shaders em andamento, caso exista.
+void DiscardShaderReload()
+{
+    for (size_t i = 0; i < g_PendingGpuPrograms.size(); ++i)
+    {
+        GpuResources_Release(GPU_PROGRAM, g_PendingGpuPrograms[i].program_id);
+        glDeleteShader(g_PendingGpuPrograms[i].vertex_shader_id);
+        glDeleteShader(g_PendingGpuPrograms[i].fragment_shader_id);
+    }
+    g_PendingGpuPrograms.clear();
+}
+
+// Inicia a recarga dos shaders a partir dos arquivos "shader_vertex.glsl" e
+// "shader_fragment.glsl", sem bloquear a renderização. Ao contrário de
+// LoadShadersFromFiles(), aqui somente pedimos ao driver que compile e
+// linke uma nova versão de cada variante em uso, sem consultar o resultado
+// (o que obrigaria a CPU a esperar a compilação terminar). O resultado é
+// verificado nos próximos quadros por UpdateShaderReload(). Se já houver uma
+// recarga em andamento (o arquivo foi salvo novamente), ela é descartada.
+// Os shaders são compilados para g_RequestedLegacyShaderMatrices, que só é
+// aplicado por UpdateShaderReload() se a recarga terminar com sucesso.
+void StartShaderReload()
+{
+    TraceScope trace("StartShaderReload");
+
+    DiscardShaderReload();
+
+    std::string vertex_file, fragment_file;
+    if ( !ReadShaderFile("../../src/shader_vertex.glsl", vertex_file) || !ReadShaderFile("../../src/shader_fragment.glsl", fragment_file) )
+    {
+        fprintf(stderr, "WARNING: Shader reload cancelled. Keeping previous programs.\n");
+        g_RequestedLegacyShaderMatrices = g_UseLegacyShaderMatrices;
+        return;
+    }
+
+    // Recompilamos todas as variantes já existentes, e também as utilizadas
+    // pelos materiais da cena.
+    std::vector<uint32_t> features;
+    for (std::map<uint32_t, GpuProgram>::iterator it = g_GpuProgramCache.begin(); it != g_GpuProgramCache.end(); ++it)
+        features.push_back(it->first);
+    for (size_t i = 0; i < g_Materials.size(); ++i)
+        features.push_back(g_Materials[i].features);
+    std::sort(features.begin(), features.end());
+    features.erase(std::unique(features.begin(), features.end()), features.end());
+
+    for (size_t i = 0; i < features.size(); ++i)
+    {
+        std::string defines = BuildShaderDefines(features[i], g_RequestedLegacyShaderMatrices);
+
+        PendingGpuProgram pending;
+        pending.features = features[i];
+        pending.vertex_source = InsertShaderDefines(vertex_file, defines.c_str());
+        pending.fragment_source = InsertShaderDefines(fragment_file, defines.c_str());
+        pending.vertex_shader_id = 0;
+        pending.fragment_shader_id = 0;
+
+        // Se esta versão dos shaders já foi compilada antes (por exemplo, o
+        // usuário desfez uma edição), o programa vem pronto do cache em disco.
+        pending.program_id = ProgramCache_Load(pending.vertex_source, pending.fragment_source);
+        if ( pending.program_id == 0 )
+        {
+            pending.vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+            CompileShader(pending.vertex_shader_id, pending.vertex_source);
+            pending.fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+            CompileShader(pending.fragment_shader_id, pending.fragment_source);
+            pending.program_id = LinkGpuProgram(pending.vertex_shader_id, pending.fragment_shader_id);
+        }
+
+        g_PendingGpuPrograms.push_back(pending);
+    }
+
+    g_PendingShaderReloadFrames = 0;
+}
+
+// Função chamada no início de cada quadro, que verifica se a recarga dos
+// shaders iniciada por StartShaderReload() terminou. Quando todas as
+// variantes estiverem prontas e sem erros, elas substituem de uma só vez os
+// programas de g_GpuProgramCache, entre dois quadros. Se alguma variante
+// falhar, os erros são impressos e os programas antigos continuam em uso.
+void UpdateShaderReload()
+{
+    if ( g_PendingGpuPrograms.empty() )
+        return;
+
+    TraceScope trace("UpdateShaderReload");
+
+    g_PendingShaderReloadFrames += 1;
+
+    // Com compilação paralela, perguntamos ao driver se cada programa já
+    // está pronto, o que nunca bloqueia. Sem ela, a primeira consulta ao
+    // resultado de um programa bloqueia até o fim de sua compilação; mesmo
+    // assim, esperamos alguns quadros para que a compilação (que muitos
+    // drivers fazem em segundo plano) tenha chance de terminar antes.
+    for (size_t i = 0; i < g_PendingGpuPrograms.size(); ++i)
+    {
+        if ( g_PendingGpuPrograms[i].vertex_shader_id == 0 )
+            continue;
+
+        if ( g_ParallelShaderCompile )
+        {
+            GLint completed = GL_FALSE;
+            glGetProgramiv(g_PendingGpuPrograms[i].program_id, GL_COMPLETION_STATUS_KHR, &completed);
+            if ( !completed )
+                return;
+        }
+        else if ( g_PendingShaderReloadFrames < 3 )
+        {
+            return;
+        }
+    }
+
+    bool reload_ok = true;
+    for (size_t i = 0; i < g_PendingGpuPrograms.size(); ++i)
+    {
+        const PendingGpuProgram& pending = g_PendingGpuPrograms[i];
+        if ( pending.vertex_shader_id == 0 )
+            continue;
+
+        bool compiled_ok = CheckShaderCompileStatus("../../src/shader_vertex.glsl", pending.vertex_shader_id);
+        compiled_ok = CheckShaderCompileStatus("../../src/shader_fragment.glsl", pending.fragment_shader_id) && compiled_ok;
+        if ( !compiled_ok || !CheckGpuProgramLinkStatus(pending.program_id) )
+            reload_ok = false;
+    }
+
+    if ( !reload_ok )
+    {
+        fprintf(stderr, "ERROR: Shader reload failed. Keeping previous programs.\n");
+        g_RequestedLegacyShaderMatrices = g_UseLegacyShaderMatrices;
+        DiscardShaderReload();
+        return;
+    }
+
+    // Todas as variantes foram linkadas com sucesso: montamos o novo cache
+    // de programas e trocamos pelo antigo. A troca de matrizes pedida pela
+    // tecla V passa a valer agora, antes de QueryGpuProgramUniforms(), que
+    // depende dela.
+    g_UseLegacyShaderMatrices = g_RequestedLegacyShaderMatrices;
+    std::map<uint32_t, GpuProgram> programs;
+    for (size_t i = 0; i < g_PendingGpuPrograms.size(); ++i)
+    {
+        PendingGpuProgram& pending = g_PendingGpuPrograms[i];
+        if ( pending.vertex_shader_id != 0 )
+        {
+            ProgramCache_Store(pending.program_id, pending.vertex_source, pending.fragment_source);
+            glDeleteShader(pending.vertex_shader_id);
+            glDeleteShader(pending.fragment_shader_id);
+        }
+
+        QueryGpuProgramUniforms(programs[pending.features], pending.program_id, pending.features);
+    }
+    g_PendingGpuPrograms.clear();
+
+    for (std::map<uint32_t, GpuProgram>::iterator it = g_GpuProgramCache.begin(); it != g_GpuProgramCache.end(); ++it)
+        GpuResources_Release(GPU_PROGRAM, it->second.shader.program_id);
+    g_GpuProgramCache.swap(programs);
+
+    printf("Shaders recarregados!\n");
+    fflush(stdout);
+}
+
+// Monta em "frame" o snapshot do estado atual da simulação, no instante
+// "time": a câmera e a lista de objetos a serem desenhados.
+void BuildFrameSnapshot(FrameSnapshot& frame, double time, const SimulationScene& scene)
+{
+    TraceScope trace("BuildFrameSnapshot");
+
+    frame.time = time;
+    frame.camera_theta = g_CameraTheta;
+    frame.camera_phi = g_CameraPhi;
+    frame.camera_distance = g_CameraDistance;
+    frame.euler_angles = glm::vec3(g_AngleX, g_AngleY, g_AngleZ);
+    frame.use_perspective_projection = g_UsePerspectiveProjection;
+    frame.animating = g_AnimationsEnabled;
+
+    glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
+
+    // Montamos a lista de objetos a serem desenhados neste instante. O
+    // desenho efetivo é feito por DrawScene(), que agrupa os objetos por
+    // variante do programa de GPU.
+    frame.draw_list.clear();
+
+    // A cena de estresse é estática: o snapshot só referencia suas instâncias.
+    frame.static_draw_list = scene.stress_instances;
+    if ( scene.stress_instances )
+        return;
+
+    DrawCommand command;
+
+    // Desenhamos o modelo da esfera
+    model = Matrix_Translate(-1.0f,0.0f,0.0f)
+          * Matrix_Rotate_Z(0.6f)
+          * Matrix_Rotate_X(0.2f)
+          * Matrix_Rotate_Y(g_AngleY + (float)g_AnimationTime * 0.1f);
+    command.object = scene.sphere;
+    command.material = g_VirtualScene.material[scene.sphere];
+    command.model = model;
+    frame.draw_list.push_back(command);
+
+    // Desenhamos o modelo do coelho
+    model = Matrix_Translate(1.0f,0.0f,0.0f)
+          * Matrix_Rotate_X(g_AngleX + (float)g_AnimationTime * 0.1f);
+    command.object = scene.bunny;
+    command.material = g_VirtualScene.material[scene.bunny];
+    command.model = model;
+    frame.draw_list.push_back(command);
+
+    // Desenhamos o plano do chão
+    model = Matrix_Translate(0.0f,-1.1f,0.0f);
+    command.object = scene.plane;
+    command.material = g_VirtualScene.material[scene.plane];
+    command.model = model;
+    frame.draw_list.push_back(command);
+}
+
+// Função que monta a cena de estresse (opção --stress): cria as malhas e os
+// materiais distintos pedidos em "params" e preenche scene.stress_instances
+// com um comando de desenho por instância gerada por StressScene_Generate().
+// As três primeiras malhas são os objetos já carregados; as demais são cópias
+// destes com seus próprios buffers na GPU (VAOs distintos), de forma que
+// --stress-meshes controla o número de trocas de VAO por quadro. Objetos sem
+// ObjModel (models[i] == NULL) são procedurais, e suas cópias reutilizam as
+// malhas já geradas (veja AddProceduralObject()).
+void BuildStressScene(const StressSceneParams& params, ObjModel* const models[3], SimulationScene& scene)
+{
+    TraceScope trace("BuildStressScene");
+
+    std::vector<StressInstance> instances;
+    StressScene_Generate(params, instances, g_PointLights);
+
+    // Malhas distintas
+    const SceneObjectHandle base_objects[3] = { scene.sphere, scene.bunny, scene.plane };
+    std::vector<SceneObjectHandle> meshes(params.num_meshes);
+    for (int i = 0; i < params.num_meshes; ++i)
+    {
+        if ( i < 3 )
+        {
+            meshes[i] = base_objects[i];
+            continue;
+        }
+
+        // A cópia recebe um nome próprio ("the_bunny#1", ...), para que
+        // AddVirtualObject() não substitua o objeto original.
+        ObjModel* model = models[i % 3];
+        if ( model == NULL )
+        {
+            const SceneObjectHandle base = base_objects[i % 3];
+            std::string name = g_VirtualScene.name[base] + "#" + std::to_string(i / 3);
+            meshes[i] = AddProceduralObject(name, g_LodChains[g_VirtualScene.lod_chain[base]].shape);
+            continue;
+        }
+
+        std::string original_name = model->shapes[0].name;
+        std::string name = original_name + "#" + std::to_string(i / 3);
+        model->shapes[0].name = name;
+        BuildTrianglesAndAddToVirtualScene(model);
+        model->shapes[0].name = original_name;
+
+        meshes[i] = GetVirtualObject(SceneObjectNameHash(name.c_str()), name.c_str());
+    }
+
+    // Materiais distintos, cada um com sua própria textura (alternando entre
+    // as imagens diurna e noturna da Terra) e projeção das coordenadas de
+    // textura. Cada textura ocupa uma unidade de textura (veja
+    // UploadTextureImage()), e a unidade 31 é do texto (veja
+    // "textrendering.cpp"), o que limita o número de texturas.
+    int num_textures = params.num_textures;
+    const int max_textures = 31 - (int)g_NumLoadedTextures;
+    if ( num_textures > max_textures )
+    {
+        fprintf(stderr, "WARNING: Only %d stress scene textures are supported (asked for %d).\n", max_textures, num_textures);
+        num_textures = max_textures;
+    }
+
+    // As duas imagens são lidas do disco uma única vez; cada textura recebe
+    // uma cópia dos mesmos pixels na GPU.
+    const char* const image_filenames[2] = { "../../data/tc-earth_daymap_surface.jpg", "../../data/tc-earth_nightmap_citylights.gif" };
+    unsigned char* images[2] = { NULL, NULL };
+    int image_widths[2];
+    int image_heights[2];
+    for (int i = 0; i < std::min(num_textures, 2); ++i)
+        images[i] = DecodeTextureImage(image_filenames[i], image_widths[i], image_heights[i]);
+
+    const uint32_t light_features = g_PointLights.empty() ? 0 : MATERIAL_POINT_LIGHTS;
+    std::vector<int> materials;
+    for (int i = 0; i < num_textures; ++i)
+    {
+        int material_index = CreateMaterial(NULL, NULL);
+        Material& material = g_Materials[material_index];
+        material.name = "stress#" + std::to_string(i);
+        material.features = MATERIAL_DIFFUSE_MAP | ((i % 2 == 0) ? MATERIAL_SPHERICAL_UV : MATERIAL_PLANAR_UV) | light_features;
+        material.diffuse_texture_unit = UploadTextureImage(images[i % 2], image_widths[i % 2], image_heights[i % 2]);
+        materials.push_back(material_index);
+    }
+
+    for (int i = 0; i < 2; ++i)
+        if ( images[i] != NULL )
+            stbi_image_free(images[i]);
+    if ( materials.empty() )
+    {
+        int material_index = CreateMaterial(NULL, NULL);
+        g_Materials[material_index].name = "stress";
+        g_Materials[material_index].features = light_features;
+        materials.push_back(material_index);
+    }
+
+    // Uma matriz de modelagem por instância. A escala leva a maior dimensão
+    // da bounding box da malha ao tamanho pedido pelo gerador.
+    std::shared_ptr<std::vector<DrawCommand>> stress_instances = std::make_shared<std::vector<DrawCommand>>(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const StressInstance& instance = instances[i];
+        const SceneObjectHandle object = meshes[instance.mesh];
+
+        glm::vec3 extent = g_VirtualScene.bbox_max[object] - g_VirtualScene.bbox_min[object];
+        float largest = std::max(extent.x, std::max(extent.y, extent.z));
+        float scale = (largest > 0.0f) ? instance.size / largest : instance.size;
+
+        DrawCommand& command = (*stress_instances)[i];
+        command.object = object;
+        command.material = materials[instance.texture % materials.size()];
+        command.model = Matrix_Translate(instance.position.x, instance.position.y, instance.position.z)
+                      * Matrix_Rotate_Y(instance.rotation_y)
+                      * Matrix_Scale(scale, scale, scale);
+    }
+    scene.stress_instances = stress_instances;
+
+    printf("Cena de estresse: %lu instâncias, %d malhas, %d materiais, %lu luzes.\n",
+           (unsigned long)instances.size(), params.num_meshes, (int)materials.size(), (unsigned long)g_PointLights.size());
+}
+
+// Entrega um evento de entrada para a simulação, o qual será processado no
+// início do seu próximo passo. Veja SimulationProcessInput().
+void PushInputEvent(const InputEvent& event)
+{
+    // Gravamos o evento (opção --record). Ele é repassado para a simulação
+    // como foi gravado: na reprodução, o clique do mouse já contém a posição
+    // do cursor. Veja ReplayNextFrame().
+    if ( InputLog_IsRecording() )
+    {
+        InputLogRecord record;
+        record.type = INPUT_LOG_EVENT;
+        record.time = glfwGetTime() - g_RecordingStartTime;
+        record.event_type = event.type;
+        record.key = event.key;
+        record.action = event.action;
+        record.mods = event.mods;
+        record.x = event.x;
+        record.y = event.y;
+        InputLog_Record(record);
+    }
+
+    if ( !g_InputQueue.Push(event) )
+        fprintf(stderr, "WARNING: Input event queue is full. Event dropped.\n");
+
+    // Acordamos a simulação, caso ela esteja dormindo por falta de eventos.
+    {
+        std::lock_guard<std::mutex> lock(g_SimulationWakeMutex);
+        g_SimulationWakeRequested = true;
+    }
+    g_SimulationWake.notify_one();
+}
+
+// Marca o quadro atual como desatualizado, fazendo com que a thread principal
+// desenhe um novo quadro. Pode ser chamada de qualquer thread:
+// glfwPostEmptyEvent() acorda a thread principal caso ela esteja bloqueada
+// em glfwWaitEventsTimeout().
+void InvalidateFrame()
+{
+    g_FrameDirty = true;
+    glfwPostEmptyEvent();
+}
+
+// Busca o instante do próximo quadro da gravação, retornado em
+// "frame_time". Os eventos são repassados separadamente, passo a passo, por
+// ReplaySimulationAdvance(). Retorna false quando a gravação termina.
+bool ReplayNextFrame(double& frame_time)
+{
+    while ( g_ReplayNextFrame < g_ReplayRecords.size() )
+    {
+        const InputLogRecord& record = g_ReplayRecords[g_ReplayNextFrame++];
+        if ( record.type == INPUT_LOG_FRAME )
+        {
+            frame_time = record.time;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Instante do próximo evento gravado ainda não repassado, ou infinito se não
+// houver mais nenhum.
+double ReplayNextEventTime()
+{
+    while ( g_ReplayNextEvent < g_ReplayRecords.size() && g_ReplayRecords[g_ReplayNextEvent].type != INPUT_LOG_EVENT )
+        g_ReplayNextEvent += 1;
+
+    if ( g_ReplayNextEvent == g_ReplayRecords.size() )
+        return std::numeric_limits<double>::infinity();
+    return g_ReplayRecords[g_ReplayNextEvent].time;
+}
+
+// Repassa para os callbacks de entrada os eventos gravados até o instante
+// "time" (inclusive).
+void ReplayEvents(GLFWwindow* window, double time)
+{
+    while ( ReplayNextEventTime() <= time )
+    {
+        const InputLogRecord& record = g_ReplayRecords[g_ReplayNextEvent++];
+
+        InputEvent event;
+        event.type = (InputEventType)record.event_type;
+        event.key = record.key;
+        event.action = record.action;
+        event.mods = record.mods;
+        event.x = record.x;
+        event.y = record.y;
+
+        // O clique do mouse não passa por MouseButtonCallback(), pois este
+        // consulta a posição atual do cursor; a posição gravada vem junto
+        // com o evento.
+        switch ( event.type )
+        {
+        case INPUT_EVENT_KEY:          KeyCallback(window, event.key, 0, event.action, event.mods); break;
+        case INPUT_EVENT_CURSOR_POS:   CursorPosCallback(window, event.x, event.y); break;
+        case INPUT_EVENT_SCROLL:       ScrollCallback(window, event.x, event.y); break;
+        case INPUT_EVENT_MOUSE_BUTTON: PushInputEvent(event); break;
+        }
+    }
+}
+
+void SimulationKey(int key, int action, int mod);
+void SimulationMouseButton(int button, int action, double xpos, double ypos);
+void SimulationCursorPos(double xpos, double ypos);
+void SimulationScroll(double yoffset);
+
+// Aplica um evento de entrada ao estado da simulação. Retorna false se o
+// evento certamente não alterou a cena (movimento do cursor sem nenhum botão
+// pressionado), caso em que nenhum quadro novo precisa ser desenhado.
+bool SimulationProcessInput(const InputEvent& event)
+{
+    switch ( event.type )
+    {
+    case INPUT_EVENT_KEY:          SimulationKey(event.key, event.action, event.mods); break;
+    case INPUT_EVENT_MOUSE_BUTTON: SimulationMouseButton(event.key, event.action, event.x, event.y); break;
+    case INPUT_EVENT_SCROLL:       SimulationScroll(event.y); break;
+    case INPUT_EVENT_CURSOR_POS:
+        SimulationCursorPos(event.x, event.y);
+        return g_LeftMouseButtonPressed || g_RightMouseButtonPressed || g_MiddleMouseButtonPressed;
+    }
+    return true;
+}
+
+// Executa quantos passos de simulação forem necessários para que o instante
+// simulado "simulation_time" alcance o relógio ("now"), aplicando os eventos
+// de entrada pendentes. Se a simulação estiver muito atrasada (ex.: o
+// programa ficou parado em um breakpoint), descartamos o tempo perdido em vez
+// de tentar recuperá-lo. Retorna true se a cena mudou.
+bool SimulationAdvance(double& simulation_time, double now)
+{
+    int steps = 0;
+    bool changed = false;
+    while ( simulation_time + SIMULATION_TIMESTEP <= now )
+    {
+        TraceScope trace("SimulationStep");
+
+        InputEvent event;
+        while ( g_InputQueue.Pop(event) )
+        {
+            if ( SimulationProcessInput(event) )
+                changed = true;
+        }
 
-    // Agora criamos objetos na GPU com OpenGL para armazenar a textura
-    GLuint texture_id;
-    GLuint sampler_id;
-    glGenTextures(1, &texture_id);
-    glGenSamplers(1, &sampler_id);
+        // As animações da cena são "invalidadores ativos": enquanto
+        // estiverem habilitadas, cada passo muda a cena.
+        if ( g_AnimationsEnabled )
+        {
+            g_AnimationTime += SIMULATION_TIMESTEP;
+            changed = true;
+        }
 
-    // Veja slides 95-96 do documento Aula_20_Mapeamento_de_Texturas.pdf
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        simulation_time += SIMULATION_TIMESTEP;
+        steps += 1;
 
-    // Parâmetros de amostragem da textura.
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if ( steps == SIMULATION_MAX_STEPS )
+        {
+            simulation_time = now;
+            break;
+        }
+    }
 
-    // Agora enviamos a imagem lida do disco para a GPU
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    return changed;
+}
 
-    GLuint textureunit = g_NumLoadedTextures;
-    glActiveTexture(GL_TEXTURE0 + textureunit);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glBindSampler(textureunit, sampler_id);
+// Equivalente a SimulationThread() na reprodução: executa os passos de
+// simulação até o instante "now", um de cada vez. Antes de cada passo, que
+// termina em simulation_time + SIMULATION_TIMESTEP, repassamos os eventos
+// gravados até esse instante, que são os que a thread de simulação já teria
+// recebido ao acordar para executá-lo. Sem animações ativas, a thread de
+// simulação dorme até o próximo evento e o seu relógio recomeça do instante
+// dele; fazemos o mesmo aqui. Retorna true se a cena mudou.
+bool ReplaySimulationAdvance(GLFWwindow* window, double& simulation_time, double now)
+{
+    bool changed = false;
+    for (;;)
+    {
+        if ( !g_AnimationsEnabled )
+        {
+            const double event_time = ReplayNextEventTime();
+            if ( event_time > now )
+                break;
+            simulation_time = std::max(simulation_time, event_time - SIMULATION_TIMESTEP);
+        }
 
-    stbi_image_free(data);
+        const double step_end = simulation_time + SIMULATION_TIMESTEP;
+        if ( step_end > now )
+            break;
 
-    g_NumLoadedTextures += 1;
+        ReplayEvents(window, step_end);
+        if ( SimulationAdvance(simulation_time, step_end) )
+            changed = true;
+    }
+
+    return changed;
 }
 
-// Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
-// dos objetos na função BuildTrianglesAndAddToVirtualScene().
-void DrawVirtualObject(const char* object_name)
+// Loop da thread de simulação. A simulação avança em passos de tamanho fixo
+// SIMULATION_TIMESTEP, independente da taxa de quadros da renderização:
+// assim, uma lógica de cena mais pesada (animações, física, ...) não
+// consome o tempo dos quadros, e o resultado da simulação não depende do
+// desempenho da GPU. Veja https://gafferongames.com/post/fix_your_timestep/
+void SimulationThread(SimulationScene scene, double simulation_start)
 {
-    // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
-    // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
-    // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
-    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
+    Trace_SetThreadName("simulation");
 
-    // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
-    // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
-    glm::vec3 bbox_min = g_VirtualScene[object_name].bbox_min;
-    glm::vec3 bbox_max = g_VirtualScene[object_name].bbox_max;
-    glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
-    glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
+    double simulation_time = simulation_start;
 
-    // Pedimos para a GPU rasterizar os vértices dos eixos XYZ
-    // apontados pelo VAO como linhas. Veja a definição de
-    // g_VirtualScene[""] dentro da função BuildTrianglesAndAddToVirtualScene(), e veja
-    // a documentação da função glDrawElements() em
-    // http://docs.gl/gl3/glDrawElements.
-    glDrawElements(
-        g_VirtualScene[object_name].rendering_mode,
-        g_VirtualScene[object_name].num_indices,
-        GL_UNSIGNED_INT,
-        (void*)(g_VirtualScene[object_name].first_index * sizeof(GLuint))
-    );
+    BuildFrameSnapshot(g_FrameSnapshots.WriteBuffer(), simulation_time, scene);
+    g_FrameSnapshots.Publish();
+
+    while ( g_SimulationRunning )
+    {
+        bool changed = SimulationAdvance(simulation_time, glfwGetTime());
+
+        // Só publicamos um snapshot se a cena mudou, e então acordamos a
+        // thread principal para que ela desenhe um novo quadro.
+        if ( changed )
+        {
+            BuildFrameSnapshot(g_FrameSnapshots.WriteBuffer(), simulation_time, scene);
+            g_FrameSnapshots.Publish();
+            InvalidateFrame();
+        }
+
+        // Sem animações ativas, nada muda até que o usuário interaja:
+        // dormimos até que um evento de entrada chegue. Ao acordar, o relógio
+        // da simulação recomeça do instante atual.
+        if ( !g_AnimationsEnabled )
+        {
+            std::unique_lock<std::mutex> lock(g_SimulationWakeMutex);
+            g_SimulationWake.wait(lock, []{ return g_SimulationWakeRequested; });
+            g_SimulationWakeRequested = false;
+            lock.unlock();
+
+            simulation_time = std::max(simulation_time, glfwGetTime() - SIMULATION_TIMESTEP);
+            continue;
+        }
 
-    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
-    // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
+        // Dormimos até o instante do próximo passo.
+        double wait = simulation_time + SIMULATION_TIMESTEP - glfwGetTime();
+        if ( wait > 0.0 )
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
 }
 
-// Função que carrega os shaders de vértices e de fragmentos que serão
-// utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
-//
-void LoadShadersFromFiles()
+// Interpola os snapshots "a" e "b" no instante "time", escrevendo o
+// resultado em "frame". As matrizes de modelagem são interpoladas elemento a
+// elemento: isto não preserva exatamente uma rotação, mas o erro é
+// desprezível para a rotação que acontece em um único passo de simulação.
+void InterpolateFrameSnapshots(const FrameSnapshot& a, const FrameSnapshot& b, double time, FrameSnapshot& frame)
 {
-    // Note que o caminho para os arquivos "shader_vertex.glsl" e
-    // "shader_fragment.glsl" estão fixados, sendo que assumimos a existência
-    // da seguinte estrutura no sistema de arquivos:
-    //
-    //    + FCG_Lab_01/
-    //    |
-    //    +--+ bin/
-    //    |  |
-    //    |  +--+ Release/  (ou Debug/ ou Linux/)
-    //    |     |
-    //    |     o-- main.exe
-    //    |
-    //    +--+ src/
-    //       |
-    //       o-- shader_vertex.glsl
-    //       |
-    //       o-- shader_fragment.glsl
-    //
-    GLuint vertex_shader_id = LoadShader_Vertex("../../src/shader_vertex.glsl");
-    GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment.glsl");
-
-    // Deletamos o programa de GPU anterior, caso ele exista.
-    if ( g_GpuProgramID != 0 )
-        glDeleteProgram(g_GpuProgramID);
-
-    // Criamos um programa de GPU utilizando os shaders carregados acima.
-    g_GpuProgramID = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
-
-    // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
-    // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
-    // (GPU)! Veja arquivo "shader_vertex.glsl" e "shader_fragment.glsl".
-    g_model_uniform      = glGetUniformLocation(g_GpuProgramID, "model"); // Variável da matriz "model"
-    g_view_uniform       = glGetUniformLocation(g_GpuProgramID, "view"); // Variável da matriz "view" em shader_vertex.glsl
-    g_projection_uniform = glGetUniformLocation(g_GpuProgramID, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
-    g_object_id_uniform  = glGetUniformLocation(g_GpuProgramID, "object_id"); // Variável "object_id" em shader_fragment.glsl
-    g_bbox_min_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_min");
-    g_bbox_max_uniform   = glGetUniformLocation(g_GpuProgramID, "bbox_max");
-
-    // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
-    glUseProgram(g_GpuProgramID);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage0"), 0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage1"), 1);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage2"), 2);
-    glUseProgram(0);
+    float t = 1.0f;
+    if ( b.time > a.time )
+        t = (float)std::min(1.0, std::max(0.0, (time - a.time) / (b.time - a.time)));
+
+    frame.time = a.time + (b.time - a.time) * t;
+    frame.camera_theta = a.camera_theta + (b.camera_theta - a.camera_theta) * t;
+    frame.camera_phi = a.camera_phi + (b.camera_phi - a.camera_phi) * t;
+    frame.camera_distance = a.camera_distance + (b.camera_distance - a.camera_distance) * t;
+    frame.euler_angles = a.euler_angles + (b.euler_angles - a.euler_angles) * t;
+    frame.use_perspective_projection = b.use_perspective_projection;
+
+    frame.static_draw_list = b.static_draw_list;
+    frame.draw_list = b.draw_list;
+    if ( a.draw_list.size() == b.draw_list.size() )
+    {
+        for (size_t i = 0; i < frame.draw_list.size(); ++i)
+        {
+            if ( a.draw_list[i].object == b.draw_list[i].object )
+                frame.draw_list[i].model = a.draw_list[i].model + (b.draw_list[i].model - a.draw_list[i].model) * t;
+        }
+    }
 }
 
 // Função que pega a matriz M e guarda a mesma no topo da pilha
@@ -624,268 +2489,204 @@ void PopMatrix(glm::mat4& M)
     }
 }
 
-// Função que computa as normais de um ObjModel, caso elas não tenham sido
-// especificadas dentro do arquivo ".obj"
-void ComputeNormals(ObjModel* model)
+// Constrói triângulos para futura renderização a partir de um ObjModel,
+// adicionando cada objeto do modelo à cena virtual. Veja "objmodel.cpp".
+void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
 {
-    if ( !model->attrib.normals.empty() )
-        return;
-
-    // Primeiro computamos as normais para todos os TRIÂNGULOS.
-    // Segundo, computamos as normais dos VÉRTICES através do método proposto
-    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
-    // todas as faces que compartilham este vértice.
-
-    size_t num_vertices = model->attrib.vertices.size() / 3;
+    TraceScope trace("BuildTrianglesAndAddToVirtualScene");
 
-    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
-    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f,0.0f,0.0f,0.0f));
+    ObjMeshData data;
+    ObjModel_Flatten(model, data);
+    g_ObjMeshes.push_back(ObjMeshGpu());
+    ObjModel_Upload(data, g_ObjMeshes.back());
+    const ObjMeshGpu& gpu = g_ObjMeshes.back();
 
     for (size_t shape = 0; shape < model->shapes.size(); ++shape)
     {
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
-
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        // O material do objeto é o do MTL referenciado pela primeira face do
+        // objeto, criado uma única vez por modelo (veja g_MtlMaterials).
+        // Objetos sem MTL recebem cada um seu próprio material padrão.
+        const std::vector<int>& material_ids = model->shapes[shape].mesh.material_ids;
+        int material;
+        if ( !material_ids.empty() && material_ids[0] >= 0 && material_ids[0] < (int)model->materials.size() )
         {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
-
-            glm::vec4  vertices[3];
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
-                vertices[vertex] = glm::vec4(vx,vy,vz,1.0);
-            }
-
-            const glm::vec4  a = vertices[0];
-            const glm::vec4  b = vertices[1];
-            const glm::vec4  c = vertices[2];
-
-            const glm::vec4  n = crossproduct(b-a,c-a);
-
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                num_triangles_per_vertex[idx.vertex_index] += 1;
-                vertex_normals[idx.vertex_index] += n;
-                model->shapes[shape].mesh.indices[3*triangle + vertex].normal_index = idx.vertex_index;
-            }
+            const std::pair<const ObjModel*, int> key(model, material_ids[0]);
+            std::map<std::pair<const ObjModel*, int>, int>::iterator it = g_MtlMaterials.find(key);
+            if ( it == g_MtlMaterials.end() )
+                it = g_MtlMaterials.insert(std::make_pair(key, CreateMaterial(model, &model->materials[material_ids[0]]))).first;
+            material = it->second;
+        }
+        else
+        {
+            material = CreateMaterial(model, NULL);
         }
-    }
-
-    model->attrib.normals.resize( 3*num_vertices );
 
-    for (size_t i = 0; i < vertex_normals.size(); ++i)
-    {
-        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
-        n /= norm(n);
-        model->attrib.normals[3*i + 0] = n.x;
-        model->attrib.normals[3*i + 1] = n.y;
-        model->attrib.normals[3*i + 2] = n.z;
+        const ObjShapeRange& range = data.shapes[shape];
+        AddVirtualObject(
+            model->shapes[shape].name,
+            gpu.shape_indices[shape],       // Faixa de índices do objeto
+            GL_TRIANGLES,                   // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
+            gpu.vertex_array.id,
+            range.bbox_min,
+            range.bbox_max,
+            material
+        );
     }
 }
 
-// Constrói triângulos para futura renderização a partir de um ObjModel.
-void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
+// Gera os níveis de detalhe de uma forma procedural (veja
+// "proceduralmesh.h"), enviando-os à GPU em um único VAO, e os insere na
+// cena virtual com os nomes "name@0", "name@1", ..., além de "name" (o nível
+// mais fino). Todos compartilham um material e uma LodChain. Se já existir
+// um objeto procedural com o mesmo nome, ele é retornado sem nova geração;
+// malhas de mesma forma e nível são geradas uma única vez, mesmo para nomes
+// distintos.
+SceneObjectHandle AddProceduralObject(const std::string& name, ProceduralShape shape)
 {
-    GLuint vertex_array_object_id;
-    glGenVertexArrays(1, &vertex_array_object_id);
-    glBindVertexArray(vertex_array_object_id);
+    TraceScope trace("AddProceduralObject", ProceduralMesh_Name(shape));
 
-    std::vector<GLuint> indices;
-    std::vector<float>  model_coefficients;
-    std::vector<float>  normal_coefficients;
-    std::vector<float>  texture_coefficients;
+    SceneObjectHandle object = FindVirtualObject(SceneObjectNameHash(name.c_str()));
+    if ( object != INVALID_SCENE_OBJECT && g_VirtualScene.lod_chain[object] >= 0 )
+        return object;
 
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    ObjMeshData data;
+    ProceduralMesh_AppendLevels(shape, 0, PROCEDURAL_NUM_LEVELS - 1, data);
+    g_ObjMeshes.push_back(ObjMeshGpu());
+    ObjModel_Upload(data, g_ObjMeshes.back());
+    const ObjMeshGpu& gpu = g_ObjMeshes.back();
+
+    const int material = CreateMaterial(NULL, NULL);
+    const int chain_index = (int)g_LodChains.size();
+    g_LodChains.push_back(LodChain());
+    g_LodChains.back().shape = shape;
+
+    for (int level = 0; level < PROCEDURAL_NUM_LEVELS; ++level)
     {
-        size_t first_index = indices.size();
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+        const ObjShapeRange& range = data.shapes[level];
+        std::string level_name = name + "@" + std::to_string(level);
+        SceneObjectHandle level_object = AddVirtualObject(level_name, gpu.shape_indices[level], GL_TRIANGLES, gpu.vertex_array.id, range.bbox_min, range.bbox_max, material);
+        g_VirtualScene.lod_chain[level_object] = chain_index;
+        g_LodChains[chain_index].levels.push_back(level_object);
+    }
 
-        const float minval = std::numeric_limits<float>::min();
-        const float maxval = std::numeric_limits<float>::max();
+    const int finest = PROCEDURAL_NUM_LEVELS - 1;
+    const ObjShapeRange& range = data.shapes[finest];
+    object = AddVirtualObject(name, gpu.shape_indices[finest], GL_TRIANGLES, gpu.vertex_array.id, range.bbox_min, range.bbox_max, material);
+    g_VirtualScene.lod_chain[object] = chain_index;
 
-        glm::vec3 bbox_min = glm::vec3(maxval,maxval,maxval);
-        glm::vec3 bbox_max = glm::vec3(minval,minval,minval);
+    printf("Malha procedural '%s' (%s): %d níveis de detalhe, de %lu a %lu triângulos.\n",
+           name.c_str(), ProceduralMesh_Name(shape), PROCEDURAL_NUM_LEVELS,
+           (unsigned long)(data.shapes[0].num_indices / 3), (unsigned long)(range.num_indices / 3));
 
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
-        {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+    return object;
+}
 
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-
-                indices.push_back(first_index + 3*triangle + vertex);
-
-                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
-                //printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
-                model_coefficients.push_back( vx ); // X
-                model_coefficients.push_back( vy ); // Y
-                model_coefficients.push_back( vz ); // Z
-                model_coefficients.push_back( 1.0f ); // W
-
-                bbox_min.x = std::min(bbox_min.x, vx);
-                bbox_min.y = std::min(bbox_min.y, vy);
-                bbox_min.z = std::min(bbox_min.z, vz);
-                bbox_max.x = std::max(bbox_max.x, vx);
-                bbox_max.y = std::max(bbox_max.y, vy);
-                bbox_max.z = std::max(bbox_max.z, vz);
-
-                // Inspecionando o código da tinyobjloader, o aluno Bernardo
-                // Sulzbach (2017/1) apontou que a maneira correta de testar se
-                // existem normais e coordenadas de textura no ObjModel é
-                // comparando se o índice retornado é -1. Fazemos isso abaixo.
-
-                if ( idx.normal_index != -1 )
-                {
-                    const float nx = model->attrib.normals[3*idx.normal_index + 0];
-                    const float ny = model->attrib.normals[3*idx.normal_index + 1];
-                    const float nz = model->attrib.normals[3*idx.normal_index + 2];
-                    normal_coefficients.push_back( nx ); // X
-                    normal_coefficients.push_back( ny ); // Y
-                    normal_coefficients.push_back( nz ); // Z
-                    normal_coefficients.push_back( 0.0f ); // W
-                }
+// Lê o conteúdo do arquivo GLSL "filename" para "contents". Retorna false
+// (sem abortar o programa) caso o arquivo não possa ser aberto, o que pode
+// acontecer durante a recarga dos shaders enquanto um editor salva o arquivo.
+bool ReadShaderFile(const char* filename, std::string& contents)
+{
+    // Lemos o arquivo de texto indicado pela variável "filename"
+    // e colocamos seu conteúdo em memória.
+    std::ifstream file;
+    try {
+        file.exceptions(std::ifstream::failbit);
+        file.open(filename);
+    } catch ( std::exception& e ) {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+    std::stringstream shader;
+    shader << file.rdbuf();
+    contents = shader.str();
+    return true;
+}
 
-                if ( idx.texcoord_index != -1 )
-                {
-                    const float u = model->attrib.texcoords[2*idx.texcoord_index + 0];
-                    const float v = model->attrib.texcoords[2*idx.texcoord_index + 1];
-                    texture_coefficients.push_back( u );
-                    texture_coefficients.push_back( v );
-                }
-            }
-        }
+// Insere o texto em "defines" (ex.: "#define X\n") no código-fonte de um
+// shader, logo após a diretiva #version.
+std::string InsertShaderDefines(const std::string& contents, const char* defines)
+{
+    // A diretiva #version deve obrigatoriamente ser a primeira linha do
+    // shader, então os "defines" são inseridos logo após ela. A diretiva
+    // #line mantém os números de linha dos logs de compilação corretos: a
+    // partir de GLSL 3.30, "#line N" indica que a próxima linha é a linha N,
+    // e a próxima linha é a segunda do arquivo.
+    size_t version_end = contents.find('\n');
+    version_end = (version_end == std::string::npos) ? contents.length() : version_end + 1;
+
+    return contents.substr(0, version_end) + defines + "#line 2\n" + contents.substr(version_end);
+}
 
-        size_t last_index = indices.size() - 1;
-
-        SceneObject theobject;
-        theobject.name           = model->shapes[shape].name;
-        theobject.first_index    = first_index; // Primeiro índice
-        theobject.num_indices    = last_index - first_index + 1; // Número de indices
-        theobject.rendering_mode = GL_TRIANGLES;       // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
-        theobject.vertex_array_object_id = vertex_array_object_id;
-
-        theobject.bbox_min = bbox_min;
-        theobject.bbox_max = bbox_max;
-
-        g_VirtualScene[model->shapes[shape].name] = theobject;
-    }
-
-    GLuint VBO_model_coefficients_id;
-    glGenBuffers(1, &VBO_model_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, model_coefficients.size() * sizeof(float), model_coefficients.data());
-    GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
-    GLint  number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-    glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    if ( !normal_coefficients.empty() )
-    {
-        GLuint VBO_normal_coefficients_id;
-        glGenBuffers(1, &VBO_normal_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, normal_coefficients.size() * sizeof(float), normal_coefficients.data());
-        location = 1; // "(location = 1)" em "shader_vertex.glsl"
-        number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    if ( !texture_coefficients.empty() )
-    {
-        GLuint VBO_texture_coefficients_id;
-        glGenBuffers(1, &VBO_texture_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, texture_coefficients.size() * sizeof(float), texture_coefficients.data());
-        location = 2; // "(location = 1)" em "shader_vertex.glsl"
-        number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
-        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    GLuint indices_id;
-    glGenBuffers(1, &indices_id);
-
-    // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
-    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
-    //
+// Lê o código-fonte de um shader de um arquivo GLSL. O texto em "defines"
+// (ex.: "#define X\n") é inserido logo após a diretiva #version do arquivo.
+std::string LoadShaderSource(const char* filename, const char* defines)
+{
+    std::string contents;
+    if ( !ReadShaderFile(filename, contents) )
+        std::exit(EXIT_FAILURE);
 
-    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
-    // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
+    return InsertShaderDefines(contents, defines);
 }
 
-// Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
-GLuint LoadShader_Vertex(const char* filename)
+// Carrega um Vertex Shader a partir de seu código-fonte. Veja definição de LoadShader() abaixo.
+GLuint LoadShader_Vertex(const char* filename, const std::string& source)
 {
     // Criamos um identificador (ID) para este shader, informando que o mesmo
     // será aplicado nos vértices.
     GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
 
     // Carregamos e compilamos o shader
-    LoadShader(filename, vertex_shader_id);
+    LoadShader(filename, source, vertex_shader_id);
 
     // Retorna o ID gerado acima
     return vertex_shader_id;
 }
 
-// Carrega um Fragment Shader de um arquivo GLSL . Veja definição de LoadShader() abaixo.
-GLuint LoadShader_Fragment(const char* filename)
+// Carrega um Fragment Shader a partir de seu código-fonte. Veja definição de LoadShader() abaixo.
+GLuint LoadShader_Fragment(const char* filename, const std::string& source)
 {
     // Criamos um identificador (ID) para este shader, informando que o mesmo
     // será aplicado nos fragmentos.
     GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
 
     // Carregamos e compilamos o shader
-    LoadShader(filename, fragment_shader_id);
+    LoadShader(filename, source, fragment_shader_id);
 
     // Retorna o ID gerado acima
     return fragment_shader_id;
 }
 
-// Função auxilar, utilizada pelas duas funções acima. Carrega código de GPU de
-// um arquivo GLSL e faz sua compilação.
-void LoadShader(const char* filename, GLuint shader_id)
+// Função auxilar, utilizada pelas duas funções acima. Faz a compilação do
+// código de GPU "source", lido do arquivo GLSL "filename" por
+// LoadShaderSource(). O nome do arquivo é utilizado somente nas mensagens.
+void LoadShader(const char* filename, const std::string& source, GLuint shader_id)
 {
-    // Lemos o arquivo de texto indicado pela variável "filename"
-    // e colocamos seu conteúdo em memória, apontado pela variável
-    // "shader_string".
-    std::ifstream file;
-    try {
-        file.exceptions(std::ifstream::failbit);
-        file.open(filename);
-    } catch ( std::exception& e ) {
-        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
-        std::exit(EXIT_FAILURE);
-    }
-    std::stringstream shader;
-    shader << file.rdbuf();
-    std::string str = shader.str();
-    const GLchar* shader_string = str.c_str();
-    const GLint   shader_string_length = static_cast<GLint>( str.length() );
+    TraceScope trace("LoadShader", Trace_Intern(filename));
+
+    CompileShader(shader_id, source);
+    CheckShaderCompileStatus(filename, shader_id);
+}
+
+// Inicia a compilação do código de GPU "source". O driver pode compilar o
+// shader em segundo plano; o resultado é consultado somente por
+// CheckShaderCompileStatus().
+void CompileShader(GLuint shader_id, const std::string& source)
+{
+    const GLchar* shader_string = source.c_str();
+    const GLint   shader_string_length = static_cast<GLint>( source.length() );
 
     // Define o código do shader GLSL, contido na string "shader_string"
     glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
 
     // Compila o código do shader GLSL (em tempo de execução)
     glCompileShader(shader_id);
+}
 
+// Imprime no terminal qualquer erro ou "warning" de compilação do shader
+// "shader_id", e retorna se a compilação teve sucesso. Bloqueia caso a
+// compilação ainda não tenha terminado.
+bool CheckShaderCompileStatus(const char* filename, GLuint shader_id)
+{
     // Verificamos se ocorreu algum erro ou "warning" durante a compilação
     GLint compiled_ok;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled_ok);
@@ -927,22 +2728,53 @@ void LoadShader(const char* filename, GLuint shader_id)
 
     // A chamada "delete" em C++ é equivalente ao "free()" do C
     delete [] log;
+
+    return compiled_ok == GL_TRUE;
 }
 
 // Esta função cria um programa de GPU, o qual contém obrigatoriamente um
 // Vertex Shader e um Fragment Shader.
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
+{
+    TraceScope trace("CreateGpuProgram");
+
+    GLuint program_id = LinkGpuProgram(vertex_shader_id, fragment_shader_id);
+    CheckGpuProgramLinkStatus(program_id);
+
+    // Os "Shader Objects" podem ser marcados para deleção após serem linkados 
+    glDeleteShader(vertex_shader_id);
+    glDeleteShader(fragment_shader_id);
+
+    // Retornamos o ID gerado acima
+    return program_id;
+}
+
+// Inicia a linkagem de um programa de GPU com os dois shaders dados. Assim
+// como a compilação, a linkagem pode acontecer em segundo plano; o
+// resultado é consultado somente por CheckGpuProgramLinkStatus().
+GLuint LinkGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
 {
     // Criamos um identificador (ID) para este programa de GPU
-    GLuint program_id = glCreateProgram();
+    GLuint program_id = GpuResources_Create(GPU_PROGRAM, "GpuProgram");
 
     // Definição dos dois shaders GLSL que devem ser executados pelo programa
     glAttachShader(program_id, vertex_shader_id);
     glAttachShader(program_id, fragment_shader_id);
 
+    // Pedimos que o driver mantenha o binário do programa disponível, para
+    // que ele possa ser guardado no cache em disco. Veja "programcache.cpp".
+    ProgramCache_PrepareForLink(program_id);
+
     // Linkagem dos shaders acima ao programa
     glLinkProgram(program_id);
 
+    return program_id;
+}
+
+// Imprime no terminal qualquer erro de linkagem do programa "program_id", e
+// retorna se a linkagem teve sucesso.
+bool CheckGpuProgramLinkStatus(GLuint program_id)
+{
     // Verificamos se ocorreu algum erro durante a linkagem
     GLint linked_ok = GL_FALSE;
     glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
@@ -972,12 +2804,7 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
         fprintf(stderr, "%s", output.c_str());
     }
 
-    // Os "Shader Objects" podem ser marcados para deleção após serem linkados 
-    glDeleteShader(vertex_shader_id);
-    glDeleteShader(fragment_shader_id);
-
-    // Retornamos o ID gerado acima
-    return program_id;
+    return linked_ok == GL_TRUE;
 }
 
 // Definição da função que será chamada sempre que a janela do sistema
@@ -999,15 +2826,58 @@ void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
     // O cast para float é necessário pois números inteiros são arredondados ao
     // serem divididos!
     g_ScreenRatio = (float)width / height;
+    g_ScreenWidth = width;
+    g_ScreenHeight = height;
+
+    // O conteúdo da janela precisa ser desenhado novamente no novo tamanho.
+    InvalidateFrame();
 }
 
 // Variáveis globais que armazenam a última posição do cursor do mouse, para
 // que possamos calcular quanto que o mouse se movimentou entre dois instantes
-// de tempo. Utilizadas no callback CursorPosCallback() abaixo.
+// de tempo. Utilizadas pela simulação em SimulationCursorPos() abaixo.
 double g_LastCursorPosX, g_LastCursorPosY;
 
-// Função callback chamada sempre que o usuário aperta algum dos botões do mouse
+// Os callbacks de mouse abaixo somente repassam os eventos para a thread de
+// simulação, que é quem altera o estado da cena. Veja PushInputEvent().
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    InputEvent event;
+    event.type = INPUT_EVENT_MOUSE_BUTTON;
+    event.key = button;
+    event.action = action;
+    event.mods = mods;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    PushInputEvent(event);
+}
+
+void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+{
+    InputEvent event;
+    event.type = INPUT_EVENT_CURSOR_POS;
+    event.key = 0;
+    event.action = 0;
+    event.mods = 0;
+    event.x = xpos;
+    event.y = ypos;
+    PushInputEvent(event);
+}
+
+void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    InputEvent event;
+    event.type = INPUT_EVENT_SCROLL;
+    event.key = 0;
+    event.action = 0;
+    event.mods = 0;
+    event.x = xoffset;
+    event.y = yoffset;
+    PushInputEvent(event);
+}
+
+// Função chamada pela simulação sempre que o usuário aperta algum dos botões
+// do mouse. A posição do cursor no momento do clique vem junto com o evento.
+void SimulationMouseButton(int button, int action, double xpos, double ypos)
 {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
     {
@@ -1016,7 +2886,8 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_LeftMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        g_LastCursorPosX = xpos;
+        g_LastCursorPosY = ypos;
         g_LeftMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
@@ -1032,7 +2903,8 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_RightMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        g_LastCursorPosX = xpos;
+        g_LastCursorPosY = ypos;
         g_RightMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE)
@@ -1048,7 +2920,8 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_MiddleMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        g_LastCursorPosX = xpos;
+        g_LastCursorPosY = ypos;
         g_MiddleMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_MIDDLE && action == GLFW_RELEASE)
@@ -1059,9 +2932,9 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
     }
 }
 
-// Função callback chamada sempre que o usuário movimentar o cursor do mouse em
-// cima da janela OpenGL.
-void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+// Função chamada pela simulação sempre que o usuário movimentar o cursor do
+// mouse em cima da janela OpenGL.
+void SimulationCursorPos(double xpos, double ypos)
 {
     // Abaixo executamos o seguinte: caso o botão esquerdo do mouse esteja
     // pressionado, computamos quanto que o mouse se movimento desde o último
@@ -1128,8 +3001,8 @@ void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
     }
 }
 
-// Função callback chamada sempre que o usuário movimenta a "rodinha" do mouse.
-void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+// Função chamada pela simulação sempre que o usuário movimenta a "rodinha" do mouse.
+void SimulationScroll(double yoffset)
 {
     // Atualizamos a distância da câmera para a origem utilizando a
     // movimentação da "rodinha", simulando um ZOOM.
@@ -1161,6 +3034,115 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
+    // Qualquer tecla pode mudar o que é mostrado na tela (ex.: o texto
+    // informativo da tecla H), então desenhamos um novo quadro.
+    InvalidateFrame();
+
+    // As teclas que alteram a cena (veja SimulationKey()) são tratadas pela
+    // thread de simulação. As demais, que controlam somente a renderização,
+    // são tratadas abaixo.
+    InputEvent event;
+    event.type = INPUT_EVENT_KEY;
+    event.key = key;
+    event.action = action;
+    event.mods = mod;
+    event.x = 0.0;
+    event.y = 0.0;
+    PushInputEvent(event);
+
+    // Se o usuário apertar a tecla H, fazemos um "toggle" do texto informativo mostrado na tela.
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        g_ShowInfoText = !g_ShowInfoText;
+    }
+
+    // Se o usuário apertar a tecla B, fazemos um "toggle" do modo de benchmark.
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
+    {
+        g_BenchmarkMode = !g_BenchmarkMode;
+    }
+
+    // Se o usuário apertar a tecla V, alternamos entre as matrizes
+    // pré-computadas na CPU e as matrizes compostas dentro dos shaders, para
+    // comparação no modo de benchmark. A troca acontece quando os shaders
+    // recompilados ficarem prontos (veja UpdateShaderReload()).
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        g_RequestedLegacyShaderMatrices = !g_RequestedLegacyShaderMatrices;
+        StartShaderReload();
+    }
+
+    // Se o usuário apertar a tecla S, ligamos/desligamos o vsync.
+    if (key == GLFW_KEY_S && action == GLFW_PRESS)
+    {
+        FramePacing_SetSwapInterval(FramePacing_GetSwapInterval() == 0 ? 1 : 0);
+    }
+
+    // Se o usuário apertar a tecla F, alternamos entre os limites de quadros
+    // por segundo abaixo (zero: sem limite).
+    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+    {
+        const double frame_caps[] = { 0.0, 30.0, 60.0, 120.0, 144.0 };
+        const int num_frame_caps = sizeof(frame_caps) / sizeof(frame_caps[0]);
+
+        int i = 0;
+        while ( i < num_frame_caps && frame_caps[i] != FramePacing_GetFrameCap() )
+            ++i;
+        FramePacing_SetFrameCap(frame_caps[(i + 1) % num_frame_caps]);
+    }
+
+    // Se o usuário apertar a tecla D, alternamos o modo da passada de
+    // profundidade entre automático, sempre e nunca. Veja "depthprepass.h".
+    if (key == GLFW_KEY_D && action == GLFW_PRESS)
+    {
+        DepthPrePass_SetMode((DepthPrePassMode)((DepthPrePass_GetMode() + 1) % DEPTH_PREPASS_NUM_MODES));
+    }
+
+    // Se o usuário apertar a tecla L, trocamos a luz direcional da cena pelo
+    // spotlight (ou vice-versa), ligando/desligando MATERIAL_SPOTLIGHT em
+    // todos os materiais. As funcionalidades dos materiais só são lidas pela
+    // renderização (DrawScene()), então podem mudar aqui.
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        g_SpotlightEnabled = !g_SpotlightEnabled;
+        for (size_t i = 0; i < g_Materials.size(); ++i)
+        {
+            if ( g_SpotlightEnabled )
+                g_Materials[i].features |= MATERIAL_SPOTLIGHT;
+            else
+                g_Materials[i].features &= ~MATERIAL_SPOTLIGHT;
+        }
+    }
+
+    // Se o usuário apertar a tecla T, escrevemos o trace de eventos gravado
+    // até agora no arquivo "trace.json". Se a gravação não estava
+    // habilitada (opção --trace), ela começa agora.
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        if ( Trace_IsEnabled() )
+        {
+            Trace_Write("trace.json");
+        }
+        else
+        {
+            Trace_Init(NULL);
+            printf("Gravação de trace iniciada. Aperte T novamente para escrever \"trace.json\".\n");
+        }
+    }
+
+    // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
+    // Os shaders também são recarregados automaticamente quando estes
+    // arquivos são salvos. Veja StartShaderReload().
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        StartShaderReload();
+    }
+}
+
+// Função chamada pela simulação sempre que o usuário pressionar alguma tecla
+// do teclado. Trata as teclas que alteram o estado da cena.
+void SimulationKey(int key, int action, int mod)
+{
     // O código abaixo implementa a seguinte lógica:
     //   Se apertar tecla X       então g_AngleX += delta;
     //   Se apertar tecla shift+X então g_AngleX -= delta;
@@ -1209,18 +3191,12 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
         g_UsePerspectiveProjection = false;
     }
 
-    // Se o usuário apertar a tecla H, fazemos um "toggle" do texto informativo mostrado na tela.
-    if (key == GLFW_KEY_H && action == GLFW_PRESS)
-    {
-        g_ShowInfoText = !g_ShowInfoText;
-    }
-
-    // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
-    if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    // Se o usuário apertar a tecla A, pausamos/retomamos as animações da
+    // cena. Com as animações pausadas e sem interação do usuário, nenhum
+    // quadro é desenhado (veja InvalidateFrame()).
+    if (key == GLFW_KEY_A && action == GLFW_PRESS)
     {
-        LoadShadersFromFiles();
-        fprintf(stdout,"Shaders recarregados!\n");
-        fflush(stdout);
+        g_AnimationsEnabled = !g_AnimationsEnabled;
     }
 }
 
@@ -1292,9 +3268,9 @@ void TextRendering_ShowModelViewProjection(
     TextRendering_PrintMatrixVectorProductMoreDigits(window, viewport_mapping, p_ndc, -1.0f, 1.0f-26*pad, 1.0f);
 }
 
-// Escrevemos na tela os ângulos de Euler definidos nas variáveis globais
-// g_AngleX, g_AngleY, e g_AngleZ.
-void TextRendering_ShowEulerAngles(GLFWwindow* window)
+// Escrevemos na tela os ângulos de Euler "euler_angles" (X, Y e Z), copiados
+// das variáveis globais g_AngleX, g_AngleY, e g_AngleZ pela simulação.
+void TextRendering_ShowEulerAngles(GLFWwindow* window, glm::vec3 euler_angles)
 {
     if ( !g_ShowInfoText )
         return;
@@ -1302,13 +3278,13 @@ void TextRendering_ShowEulerAngles(GLFWwindow* window)
     float pad = TextRendering_LineHeight(window);
 
     char buffer[80];
-    snprintf(buffer, 80, "Euler Angles rotation matrix = Z(%.2f)*Y(%.2f)*X(%.2f)\n", g_AngleZ, g_AngleY, g_AngleX);
+    snprintf(buffer, 80, "Euler Angles rotation matrix = Z(%.2f)*Y(%.2f)*X(%.2f)\n", euler_angles.z, euler_angles.y, euler_angles.x);
 
     TextRendering_PrintString(window, buffer, -1.0f+pad/10, -1.0f+2*pad/10, 1.0f);
 }
 
 // Escrevemos na tela qual matriz de projeção está sendo utilizada.
-void TextRendering_ShowProjection(GLFWwindow* window)
+void TextRendering_ShowProjection(GLFWwindow* window, bool use_perspective_projection)
 {
     if ( !g_ShowInfoText )
         return;
@@ -1316,14 +3292,16 @@ void TextRendering_ShowProjection(GLFWwindow* window)
     float lineheight = TextRendering_LineHeight(window);
     float charwidth = TextRendering_CharWidth(window);
 
-    if ( g_UsePerspectiveProjection )
+    if ( use_perspective_projection )
         TextRendering_PrintString(window, "Perspective", 1.0f-13*charwidth, -1.0f+2*lineheight/10, 1.0f);
     else
         TextRendering_PrintString(window, "Orthographic", 1.0f-13*charwidth, -1.0f+2*lineheight/10, 1.0f);
 }
 
 // Escrevemos na tela o número de quadros renderizados por segundo (frames per
-// second).
+// second), e abaixo dele os intervalos medidos entre apresentações de
+// quadros (média, mínimo e máximo) e a configuração de vsync e limite de FPS.
+// Veja "framepacing.cpp".
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
 {
     if ( !g_ShowInfoText )
@@ -1335,6 +3313,10 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     static int   ellapsed_frames = 0;
     static char  buffer[20] = "?? fps";
     static int   numchars = 7;
+    static char  present_buffer[64] = "";
+    static int   present_numchars = 0;
+    static char  pacing_buffer[64] = "";
+    static int   pacing_numchars = 0;
 
     ellapsed_frames += 1;
 
@@ -1347,15 +3329,103 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     if ( ellapsed_seconds > 1.0f )
     {
         numchars = snprintf(buffer, 20, "%.2f fps", ellapsed_frames / ellapsed_seconds);
-    
+
+        FramePacingStats stats = FramePacing_GetStats();
+        present_numchars = snprintf(present_buffer, 64, "present %.2f ms [%.2f, %.2f]",
+            stats.average_ms, stats.min_ms, stats.max_ms);
+
         old_seconds = seconds;
         ellapsed_frames = 0;
     }
 
+    // A configuração é atualizada a cada quadro, para refletir
+    // imediatamente as teclas S e F.
+    if ( FramePacing_GetFrameCap() > 0.0 )
+        pacing_numchars = snprintf(pacing_buffer, 64, "vsync %s, cap %.0f fps",
+            FramePacing_GetSwapInterval() != 0 ? "on" : "off", FramePacing_GetFrameCap());
+    else
+        pacing_numchars = snprintf(pacing_buffer, 64, "vsync %s, no cap",
+            FramePacing_GetSwapInterval() != 0 ? "on" : "off");
+
     float lineheight = TextRendering_LineHeight(window);
     float charwidth = TextRendering_CharWidth(window);
 
     TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-lineheight, 1.0f);
+    TextRendering_PrintString(window, present_buffer, 1.0f-(present_numchars + 1)*charwidth, 1.0f-2*lineheight, 1.0f);
+    TextRendering_PrintString(window, pacing_buffer, 1.0f-(pacing_numchars + 1)*charwidth, 1.0f-3*lineheight, 1.0f);
+}
+
+// Escrevemos na tela os tempos medidos pelo profiler no modo de benchmark
+// (tecla B): os percentis 50, 95 e 99 do tempo de CPU de cada quadro e dos
+// tempos de CPU e GPU de cada etapa, e um gráfico com o tempo de CPU dos
+// últimos quadros. A linha de referência do gráfico marca 16.67 ms (60 fps).
+// Veja "profiler.cpp".
+void TextRendering_ShowProfiler(GLFWwindow* window)
+{
+    float lineheight = TextRendering_LineHeight(window);
+    float y = 1.0f - lineheight;
+    char buffer[128];
+
+    ProfilerStats frame = Profiler_GetFrameStats();
+    snprintf(buffer, 128, "frame  cpu %6.2f %6.2f %6.2f ms  (%s matrices)",
+        frame.p50, frame.p95, frame.p99,
+        g_UseLegacyShaderMatrices ? "per-vertex" : "precomputed");
+    TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+
+    for (int i = 0; i < Profiler_GetNumPasses(); ++i)
+    {
+        y -= lineheight;
+
+        ProfilerStats cpu = Profiler_GetCpuStats(i);
+        int n = snprintf(buffer, 128, "%-6s cpu %6.2f %6.2f %6.2f ms",
+            Profiler_GetPassName(i), cpu.p50, cpu.p95, cpu.p99);
+
+        if ( Profiler_PassHasGpuTime(i) )
+        {
+            ProfilerStats gpu = Profiler_GetGpuStats(i);
+            snprintf(buffer + n, 128 - n, "  gpu %6.2f %6.2f %6.2f ms", gpu.p50, gpu.p95, gpu.p99);
+        }
+
+        TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+    }
+
+    // O gráfico ocupa a largura do texto acima, logo abaixo dele. A escala
+    // vertical cobre ao menos dois quadros de 60 fps, e cresce se houver
+    // quadros mais lentos.
+    float history[PROFILER_HISTORY];
+    int count = Profiler_GetFrameHistory(history, PROFILER_HISTORY);
+    float max_value = std::max(2.0f * 16.67f, (float)frame.max);
+    float height = 4.0f * lineheight;
+
+    // Uso do buffer circular do texto: bytes do último quadro e esperas
+    // pela GPU quando o anel encheu (veja "streambuffer.h").
+    y -= lineheight;
+    const StreamBufferStats& stream = TextRendering_GetStreamStats();
+    snprintf(buffer, 128, "stream %6.1f KB/frame  stalls %lu (%.2f ms)  orphans %lu",
+        stream.frame_bytes / 1024.0, (unsigned long)stream.stalls, stream.stall_seconds * 1000.0, (unsigned long)stream.orphans);
+    TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+
+    // Trocas de estado OpenGL do último quadro: repassadas ao driver e
+    // eliminadas por serem redundantes (veja "glstate.h").
+    y -= lineheight;
+    const GlStateStats glstate = GlState_GetFrameStats();
+    snprintf(buffer, 128, "gl state %5lu issued  %5lu filtered",
+        (unsigned long)glstate.issued, (unsigned long)glstate.filtered);
+    TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+
+    y -= lineheight;
+    const ShaderUniformStats uniforms = ShaderProgram_GetFrameStats();
+    snprintf(buffer, 128, "uniforms %5lu issued  %5lu filtered",
+        (unsigned long)uniforms.issued, (unsigned long)uniforms.filtered);
+    TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+
+    // Modo da passada de profundidade (tecla D) e overdraw medido.
+    y -= lineheight;
+    snprintf(buffer, 128, "depth prepass %-4s overdraw %.2f",
+        DepthPrePass_ModeName(DepthPrePass_GetMode()), DepthPrePass_GetOverdraw());
+    TextRendering_PrintString(window, buffer, -1.0f, y, 1.0f);
+
+    TextRendering_PrintGraph(window, history, count, max_value, 16.67f, -0.98f, y - height - 0.5f*lineheight, 0.8f, height);
 }
 
 // Função para debugging: imprime no terminal todas informações de um modelo
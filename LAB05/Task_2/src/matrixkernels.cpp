@@ -0,0 +1,179 @@
+// Núcleos SIMD de álgebra linear em lote.
+//
+// Todas as funções deste arquivo percorrem vetores contíguos de dados (pontos,
+// bounding boxes ou matrizes) em um único laço, mantendo em registradores os
+// operandos constantes (ex.: as colunas da matriz "a" em
+// MatrixKernels_MultiplyArray()). Com AVX, dois pontos (ou duas colunas de
+// matriz) são processados por instrução; com SSE, um; e o código escalar é
+// utilizado apenas quando nenhum dos dois está disponível. Os três caminhos
+// computam os mesmos produtos que GLM; os resultados diferem apenas pelo
+// arredondamento (ordem das somas e FMA).
+#include <cmath>
+
+#include "matrixkernels.h"
+
+#ifdef MATRIX_KERNELS_SSE
+// a*b + c, com FMA quando disponível.
+static inline __m128 MatrixKernels_MulAdd(__m128 a, __m128 b, __m128 c)
+{
+#if defined(MATRIX_KERNELS_AVX) && defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+#ifdef MATRIX_KERNELS_AVX
+static inline __m256 MatrixKernels_MulAdd(__m256 a, __m256 b, __m256 c)
+{
+#ifdef __FMA__
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+// Dados dois vetores de quatro floats [x0 y0 z0 w0 | x1 y1 z1 w1] em "v",
+// computa [m*v0 | m*v1], onde m0..m3 são as colunas de "m" replicadas nas
+// duas metades dos registradores.
+static inline __m256 MatrixKernels_Transform2(__m256 m0, __m256 m1, __m256 m2, __m256 m3, __m256 v)
+{
+    __m256 r = _mm256_mul_ps(m0, _mm256_permute_ps(v, 0x00));
+    r = MatrixKernels_MulAdd(m1, _mm256_permute_ps(v, 0x55), r);
+    r = MatrixKernels_MulAdd(m2, _mm256_permute_ps(v, 0xAA), r);
+    r = MatrixKernels_MulAdd(m3, _mm256_permute_ps(v, 0xFF), r);
+    return r;
+}
+#endif
+
+#ifdef MATRIX_KERNELS_SSE
+static inline __m128 MatrixKernels_Transform1(__m128 m0, __m128 m1, __m128 m2, __m128 m3, __m128 v)
+{
+    __m128 r = _mm_mul_ps(m0, _mm_shuffle_ps(v, v, 0x00));
+    r = MatrixKernels_MulAdd(m1, _mm_shuffle_ps(v, v, 0x55), r);
+    r = MatrixKernels_MulAdd(m2, _mm_shuffle_ps(v, v, 0xAA), r);
+    r = MatrixKernels_MulAdd(m3, _mm_shuffle_ps(v, v, 0xFF), r);
+    return r;
+}
+#endif
+
+// Aplica "m" a "count" vetores de quatro floats consecutivos. Um ponto
+// glm::vec4 e uma coluna de glm::mat4 têm o mesmo formato em memória, então
+// tanto a transformação de pontos quanto o produto de matrizes (coluna a
+// coluna) se reduzem a este laço.
+static void MatrixKernels_TransformVec4s(const glm::mat4& m, const float* in, float* out, size_t count)
+{
+    size_t i = 0;
+#if defined(MATRIX_KERNELS_AVX)
+    const __m256 m0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[0][0]));
+    const __m256 m1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[1][0]));
+    const __m256 m2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[2][0]));
+    const __m256 m3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[3][0]));
+    for (; i + 2 <= count; i += 2)
+        _mm256_storeu_ps(out + 4*i, MatrixKernels_Transform2(m0, m1, m2, m3, _mm256_loadu_ps(in + 4*i)));
+#endif
+#if defined(MATRIX_KERNELS_SSE)
+    const __m128 c0 = _mm_loadu_ps(&m[0][0]);
+    const __m128 c1 = _mm_loadu_ps(&m[1][0]);
+    const __m128 c2 = _mm_loadu_ps(&m[2][0]);
+    const __m128 c3 = _mm_loadu_ps(&m[3][0]);
+    for (; i < count; ++i)
+        _mm_storeu_ps(out + 4*i, MatrixKernels_Transform1(c0, c1, c2, c3, _mm_loadu_ps(in + 4*i)));
+#else
+    for (; i < count; ++i)
+    {
+        const float x = in[4*i+0], y = in[4*i+1], z = in[4*i+2], w = in[4*i+3];
+        for (int k = 0; k < 4; ++k)
+            out[4*i+k] = m[0][k]*x + m[1][k]*y + m[2][k]*z + m[3][k]*w;
+    }
+#endif
+}
+
+void MatrixKernels_TransformPoints(const glm::mat4& m, const glm::vec4* points, glm::vec4* out, size_t count)
+{
+    MatrixKernels_TransformVec4s(m, reinterpret_cast<const float*>(points), reinterpret_cast<float*>(out), count);
+}
+
+void MatrixKernels_MultiplyArray(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, size_t count)
+{
+    // As colunas de a*b[i] são "a" aplicada às colunas de b[i]; então
+    // todas as 4*count colunas são transformadas em um único laço.
+    MatrixKernels_TransformVec4s(a, reinterpret_cast<const float*>(b), reinterpret_cast<float*>(out), 4*count);
+}
+
+void MatrixKernels_MultiplyArrays(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = MatrixKernels_Multiply(a[i], b[i]);
+}
+
+// Uma AABB transformada por uma matriz afim é contida pela AABB de centro
+// m*c e meia-extensão |M|*e, onde c e e são o centro e a meia-extensão da
+// AABB original e |M| é a parte 3x3 de "m" com o valor absoluto de cada
+// elemento (Arvo, "Transforming Axis-Aligned Bounding Boxes", Graphics
+// Gems, 1990). Isto evita transformar os oito vértices de cada caixa.
+void MatrixKernels_TransformAABBs(const glm::mat4& m, const glm::vec3* bbox_min, const glm::vec3* bbox_max, glm::vec3* out_min, glm::vec3* out_max, size_t count)
+{
+#ifdef MATRIX_KERNELS_SSE
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 c0 = _mm_loadu_ps(&m[0][0]);
+    const __m128 c1 = _mm_loadu_ps(&m[1][0]);
+    const __m128 c2 = _mm_loadu_ps(&m[2][0]);
+    const __m128 c3 = _mm_loadu_ps(&m[3][0]);
+    const __m128 a0 = _mm_andnot_ps(sign, c0);
+    const __m128 a1 = _mm_andnot_ps(sign, c1);
+    const __m128 a2 = _mm_andnot_ps(sign, c2);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // glm::vec3 ocupa 12 bytes: carregamos cada caixa elemento a
+        // elemento para não ler além do final dos vetores.
+        const __m128 lo = _mm_set_ps(0.0f, bbox_min[i].z, bbox_min[i].y, bbox_min[i].x);
+        const __m128 hi = _mm_set_ps(0.0f, bbox_max[i].z, bbox_max[i].y, bbox_max[i].x);
+        const __m128 c = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+        const __m128 e = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+
+        __m128 center = MatrixKernels_MulAdd(c0, _mm_shuffle_ps(c, c, 0x00), c3);
+        center = MatrixKernels_MulAdd(c1, _mm_shuffle_ps(c, c, 0x55), center);
+        center = MatrixKernels_MulAdd(c2, _mm_shuffle_ps(c, c, 0xAA), center);
+
+        __m128 extent = _mm_mul_ps(a0, _mm_shuffle_ps(e, e, 0x00));
+        extent = MatrixKernels_MulAdd(a1, _mm_shuffle_ps(e, e, 0x55), extent);
+        extent = MatrixKernels_MulAdd(a2, _mm_shuffle_ps(e, e, 0xAA), extent);
+
+        float rmin[4], rmax[4];
+        _mm_storeu_ps(rmin, _mm_sub_ps(center, extent));
+        _mm_storeu_ps(rmax, _mm_add_ps(center, extent));
+        out_min[i] = glm::vec3(rmin[0], rmin[1], rmin[2]);
+        out_max[i] = glm::vec3(rmax[0], rmax[1], rmax[2]);
+    }
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3 c = (bbox_min[i] + bbox_max[i]) * 0.5f;
+        const glm::vec3 e = (bbox_max[i] - bbox_min[i]) * 0.5f;
+        glm::vec3 center, extent;
+        for (int k = 0; k < 3; ++k)
+        {
+            center[k] = m[0][k]*c.x + m[1][k]*c.y + m[2][k]*c.z + m[3][k];
+            extent[k] = std::fabs(m[0][k])*e.x + std::fabs(m[1][k])*e.y + std::fabs(m[2][k])*e.z;
+        }
+        out_min[i] = center - extent;
+        out_max[i] = center + extent;
+    }
+#endif
+}
+
+const char* MatrixKernels_InstructionSet()
+{
+#if defined(MATRIX_KERNELS_AVX) && defined(__FMA__)
+    return "avx+fma";
+#elif defined(MATRIX_KERNELS_AVX)
+    return "avx";
+#elif defined(MATRIX_KERNELS_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,294 @@
+// Carregamento de modelos ".obj" e construção dos buffers de vértices.
+//
+// A importação de um modelo tem quatro etapas, separadas aqui em funções
+// independentes para que possam ser medidas individualmente (veja
+// "bench/asset_bench.cpp"): a leitura do arquivo pela tinyobjloader (o
+// construtor de ObjModel), o cálculo das normais (ComputeNormals()), a
+// montagem dos atributos dos vértices (ObjModel_Flatten()) e o envio dos
+// buffers para a GPU (ObjModel_Upload()).
+#include <cstdio>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+
+#include "objmodel.h"
+#include "trace.h"
+#include "glstate.h"
+
+ObjModel::ObjModel(const char* filename, const char* basepath, bool triangulate)
+{
+    TraceScope trace("ObjModel", Trace_Intern(filename));
+
+    printf("Carregando objetos do arquivo \"%s\"...\n", filename);
+
+    // Se basepath == NULL, então setamos basepath como o dirname do
+    // filename, para que os arquivos MTL sejam corretamente carregados caso
+    // estejam no mesmo diretório dos arquivos OBJ.
+    std::string fullpath(filename);
+    std::string dirname;
+    if (basepath == NULL)
+    {
+        auto i = fullpath.find_last_of("/");
+        if (i != std::string::npos)
+        {
+            dirname = fullpath.substr(0, i+1);
+            basepath = dirname.c_str();
+        }
+    }
+
+    if (basepath != NULL)
+        this->basepath = basepath;
+
+    std::string warn;
+    std::string err;
+    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate);
+
+    if (!err.empty())
+        fprintf(stderr, "\n%s\n", err.c_str());
+
+    if (!ret)
+        throw std::runtime_error("Erro ao carregar modelo.");
+
+    for (size_t shape = 0; shape < shapes.size(); ++shape)
+    {
+        if (shapes[shape].name.empty())
+        {
+            fprintf(stderr,
+                    "*********************************************\n"
+                    "Erro: Objeto sem nome dentro do arquivo '%s'.\n"
+                    "Veja https://www.inf.ufrgs.br/~eslgastal/fcg-faq-etc.html#Modelos-3D-no-formato-OBJ .\n"
+                    "*********************************************\n",
+                filename);
+            throw std::runtime_error("Objeto sem nome.");
+        }
+        printf("- Objeto '%s'\n", shapes[shape].name.c_str());
+    }
+
+    printf("OK.\n");
+}
+
+// Função que computa as normais de um ObjModel, caso elas não tenham sido
+// especificadas dentro do arquivo ".obj"
+void ComputeNormals(ObjModel* model)
+{
+    TraceScope trace("ComputeNormals");
+
+    if ( !model->attrib.normals.empty() )
+        return;
+
+    // Primeiro computamos as normais para todos os TRIÂNGULOS.
+    // Segundo, computamos as normais dos VÉRTICES através do método proposto
+    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
+    // todas as faces que compartilham este vértice.
+
+    size_t num_vertices = model->attrib.vertices.size() / 3;
+
+    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
+    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f,0.0f,0.0f,0.0f));
+
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+
+            glm::vec3  vertices[3];
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
+                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
+                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
+                vertices[vertex] = glm::vec3(vx,vy,vz);
+            }
+
+            const glm::vec3  a = vertices[0];
+            const glm::vec3  b = vertices[1];
+            const glm::vec3  c = vertices[2];
+
+            const glm::vec4  n = glm::vec4(glm::cross(b-a,c-a), 0.0f);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+                num_triangles_per_vertex[idx.vertex_index] += 1;
+                vertex_normals[idx.vertex_index] += n;
+                model->shapes[shape].mesh.indices[3*triangle + vertex].normal_index = idx.vertex_index;
+            }
+        }
+    }
+
+    model->attrib.normals.resize( 3*num_vertices );
+
+    for (size_t i = 0; i < vertex_normals.size(); ++i)
+    {
+        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
+        n /= glm::length(glm::vec3(n));
+        model->attrib.normals[3*i + 0] = n.x;
+        model->attrib.normals[3*i + 1] = n.y;
+        model->attrib.normals[3*i + 2] = n.z;
+    }
+}
+
+// Monta os atributos dos vértices (posições, normais e coordenadas de
+// textura) de todos os objetos de um ObjModel.
+void ObjModel_Flatten(const ObjModel* model, ObjMeshData& data)
+{
+    TraceScope trace("ObjModel_Flatten");
+
+    data.indices.clear();
+    data.model_coefficients.clear();
+    data.normal_coefficients.clear();
+    data.texture_coefficients.clear();
+    data.shapes.clear();
+
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        size_t first_index = data.indices.size();
+        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+
+        const float minval = std::numeric_limits<float>::min();
+        const float maxval = std::numeric_limits<float>::max();
+
+        glm::vec3 bbox_min = glm::vec3(maxval,maxval,maxval);
+        glm::vec3 bbox_max = glm::vec3(minval,minval,minval);
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+
+                data.indices.push_back(first_index + 3*triangle + vertex);
+
+                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
+                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
+                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
+                //printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
+                data.model_coefficients.push_back( vx ); // X
+                data.model_coefficients.push_back( vy ); // Y
+                data.model_coefficients.push_back( vz ); // Z
+                data.model_coefficients.push_back( 1.0f ); // W
+
+                bbox_min.x = std::min(bbox_min.x, vx);
+                bbox_min.y = std::min(bbox_min.y, vy);
+                bbox_min.z = std::min(bbox_min.z, vz);
+                bbox_max.x = std::max(bbox_max.x, vx);
+                bbox_max.y = std::max(bbox_max.y, vy);
+                bbox_max.z = std::max(bbox_max.z, vz);
+
+                // Inspecionando o código da tinyobjloader, o aluno Bernardo
+                // Sulzbach (2017/1) apontou que a maneira correta de testar se
+                // existem normais e coordenadas de textura no ObjModel é
+                // comparando se o índice retornado é -1. Fazemos isso abaixo.
+
+                if ( idx.normal_index != -1 )
+                {
+                    const float nx = model->attrib.normals[3*idx.normal_index + 0];
+                    const float ny = model->attrib.normals[3*idx.normal_index + 1];
+                    const float nz = model->attrib.normals[3*idx.normal_index + 2];
+                    data.normal_coefficients.push_back( nx ); // X
+                    data.normal_coefficients.push_back( ny ); // Y
+                    data.normal_coefficients.push_back( nz ); // Z
+                    data.normal_coefficients.push_back( 0.0f ); // W
+                }
+
+                if ( idx.texcoord_index != -1 )
+                {
+                    const float u = model->attrib.texcoords[2*idx.texcoord_index + 0];
+                    const float v = model->attrib.texcoords[2*idx.texcoord_index + 1];
+                    data.texture_coefficients.push_back( u );
+                    data.texture_coefficients.push_back( v );
+                }
+            }
+        }
+
+        ObjShapeRange range;
+        range.first_index = first_index;
+        range.num_indices = data.indices.size() - first_index;
+        range.bbox_min = bbox_min;
+        range.bbox_max = bbox_max;
+        data.shapes.push_back(range);
+    }
+}
+
+// Envia os atributos de "data" para a GPU. Os objetos de "gpu" que já
+// existirem são substituídos (e devolvidos ao registro de recursos).
+void ObjModel_Upload(const ObjMeshData& data, ObjMeshGpu& gpu)
+{
+    TraceScope trace("ObjModel_Upload");
+
+    gpu.vertex_array.Create("ObjModel VAO");
+    GlState_BindVertexArray(gpu.vertex_array.id);
+
+    gpu.model_coefficients.Create("ObjModel model_coefficients");
+    GlState_BindBuffer(GL_ARRAY_BUFFER, gpu.model_coefficients.id);
+    glBufferData(GL_ARRAY_BUFFER, data.model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, data.model_coefficients.size() * sizeof(float), data.model_coefficients.data());
+    gpu.model_coefficients.SetSize(data.model_coefficients.size() * sizeof(float));
+    GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
+    GLint  number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
+    glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(location);
+    GlState_BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gpu.normal_coefficients.Reset();
+    if ( !data.normal_coefficients.empty() )
+    {
+        gpu.normal_coefficients.Create("ObjModel normal_coefficients");
+        GlState_BindBuffer(GL_ARRAY_BUFFER, gpu.normal_coefficients.id);
+        glBufferData(GL_ARRAY_BUFFER, data.normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, data.normal_coefficients.size() * sizeof(float), data.normal_coefficients.data());
+        gpu.normal_coefficients.SetSize(data.normal_coefficients.size() * sizeof(float));
+        location = 1; // "(location = 1)" em "shader_vertex.glsl"
+        number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
+        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(location);
+        GlState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    gpu.texture_coefficients.Reset();
+    if ( !data.texture_coefficients.empty() )
+    {
+        gpu.texture_coefficients.Create("ObjModel texture_coefficients");
+        GlState_BindBuffer(GL_ARRAY_BUFFER, gpu.texture_coefficients.id);
+        glBufferData(GL_ARRAY_BUFFER, data.texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, data.texture_coefficients.size() * sizeof(float), data.texture_coefficients.data());
+        gpu.texture_coefficients.SetSize(data.texture_coefficients.size() * sizeof(float));
+        location = 2; // "(location = 1)" em "shader_vertex.glsl"
+        number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
+        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(location);
+        GlState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Os índices de cada shape são convertidos para o menor tipo capaz de
+    // indexar seus vértices (ex.: GL_UNSIGNED_BYTE para o plano).
+    MeshIndexData index_data;
+    gpu.shape_indices.clear();
+    for (size_t shape = 0; shape < data.shapes.size(); ++shape)
+    {
+        const ObjShapeRange& range = data.shapes[shape];
+        gpu.shape_indices.push_back(MeshIndices_Append(index_data, data.indices.data() + range.first_index, range.num_indices));
+    }
+
+    gpu.indices.Create("ObjModel indices");
+
+    // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
+    MeshIndices_Upload(index_data, gpu.indices.id);
+    gpu.indices.SetSize(index_data.bytes.size());
+    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
+    //
+
+    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
+    // alterar o mesmo. Isso evita bugs.
+    GlState_BindVertexArray(0);
+}
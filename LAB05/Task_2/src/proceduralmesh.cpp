@@ -0,0 +1,485 @@
+// Malhas geradas proceduralmente, com vários níveis de detalhe.
+//
+// Ao contrário dos modelos ".obj", onde cada vértice de cada triângulo é
+// repetido (veja ObjModel_Flatten()), aqui os vértices são compartilhados
+// entre os triângulos vizinhos através dos índices, exceto nas arestas onde
+// a normal (ou a coordenada de textura) muda, como nas quinas do cubo.
+// Todos os triângulos são gerados em sentido anti-horário quando vistos de
+// fora, já que a renderização descarta as faces traseiras (GL_CULL_FACE).
+//
+// O erro de cada nível (ProceduralMesh_Error()) é a "flecha" (sagitta) da
+// aproximação: a maior distância entre um ponto da malha e a superfície
+// curva exata. Multiplicado pela escala do objeto e pelo número de pixels
+// por unidade na distância do objeto, ele dá o erro em pixels na tela, e
+// ProceduralMesh_SelectLevel() escolhe o nível mais grosseiro cujo erro não
+// seja visível.
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include "proceduralmesh.h"
+#include "trace.h"
+
+static const float PROCEDURAL_PI = 3.14159265358979f;
+
+static const char* const proceduralmesh_names[PROCEDURAL_NUM_SHAPES] = {
+    "disk", "ring", "box", "uv_sphere", "icosphere", "plane_grid", "cylinder"
+};
+
+// Cache das malhas já geradas, indexado por (forma, nível). Os elementos de
+// um std::map não mudam de endereço, então as referências retornadas por
+// ProceduralMesh_Get() continuam válidas até ProceduralMesh_ClearCache().
+static std::map<std::pair<int,int>, ObjMeshData> proceduralmesh_cache;
+
+const char* ProceduralMesh_Name(ProceduralShape shape)
+{
+    return proceduralmesh_names[shape];
+}
+
+// Número de segmentos ao redor do eixo das formas curvas.
+static int ProceduralMesh_Segments(int level)
+{
+    return 8 << level;
+}
+
+static GLuint ProceduralMesh_AddVertex(ObjMeshData& data, glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
+{
+    const GLuint index = (GLuint)(data.model_coefficients.size() / 4);
+
+    data.model_coefficients.push_back(position.x);
+    data.model_coefficients.push_back(position.y);
+    data.model_coefficients.push_back(position.z);
+    data.model_coefficients.push_back(1.0f);
+
+    data.normal_coefficients.push_back(normal.x);
+    data.normal_coefficients.push_back(normal.y);
+    data.normal_coefficients.push_back(normal.z);
+    data.normal_coefficients.push_back(0.0f);
+
+    data.texture_coefficients.push_back(uv.x);
+    data.texture_coefficients.push_back(uv.y);
+
+    return index;
+}
+
+static void ProceduralMesh_AddTriangle(ObjMeshData& data, GLuint a, GLuint b, GLuint c)
+{
+    data.indices.push_back(a);
+    data.indices.push_back(b);
+    data.indices.push_back(c);
+}
+
+// Quadrilátero a-b-c-d, em sentido anti-horário.
+static void ProceduralMesh_AddQuad(ObjMeshData& data, GLuint a, GLuint b, GLuint c, GLuint d)
+{
+    ProceduralMesh_AddTriangle(data, a, b, c);
+    ProceduralMesh_AddTriangle(data, a, c, d);
+}
+
+// Grade de NxN quadriláteros sobre o quadrado de lado 2 que começa em
+// "origin" e segue os eixos unitários "u" e "v". A face é visível do lado
+// de cross(u,v).
+static void ProceduralMesh_AddGrid(ObjMeshData& data, glm::vec3 origin, glm::vec3 u, glm::vec3 v, int divisions)
+{
+    const glm::vec3 normal = glm::cross(u, v);
+    const GLuint first = (GLuint)(data.model_coefficients.size() / 4);
+    const int row = divisions + 1;
+
+    for (int k = 0; k <= divisions; ++k)
+    {
+        for (int i = 0; i <= divisions; ++i)
+        {
+            const float s = (float)i / divisions;
+            const float t = (float)k / divisions;
+            ProceduralMesh_AddVertex(data, origin + 2.0f*s*u + 2.0f*t*v, normal, glm::vec2(s, t));
+        }
+    }
+
+    for (int k = 0; k < divisions; ++k)
+    {
+        for (int i = 0; i < divisions; ++i)
+        {
+            const GLuint a = first + k*row + i;
+            ProceduralMesh_AddQuad(data, a, a + 1, a + row + 1, a + row);
+        }
+    }
+}
+
+// Disco (inner_radius == 0) ou anel de raio externo 1 no plano y = "y",
+// virado para +Y (facing_up) ou para -Y.
+static void ProceduralMesh_AddAnnulus(ObjMeshData& data, float y, bool facing_up, float inner_radius, int segments)
+{
+    const glm::vec3 normal(0.0f, facing_up ? 1.0f : -1.0f, 0.0f);
+    // Espelhar Z inverte o sentido de percurso dos vértices, e portanto o
+    // lado visível dos triângulos.
+    const float z_sign = facing_up ? -1.0f : 1.0f;
+    const GLuint first = (GLuint)(data.model_coefficients.size() / 4);
+
+    for (int i = 0; i < segments; ++i)
+    {
+        const float theta = 2.0f * PROCEDURAL_PI * i / segments;
+        const float x = cosf(theta);
+        const float z = z_sign * sinf(theta);
+        ProceduralMesh_AddVertex(data, glm::vec3(x, y, z), normal, glm::vec2(0.5f + 0.5f*x, 0.5f - 0.5f*z));
+        if ( inner_radius > 0.0f )
+        {
+            const float xi = inner_radius * x;
+            const float zi = inner_radius * z;
+            ProceduralMesh_AddVertex(data, glm::vec3(xi, y, zi), normal, glm::vec2(0.5f + 0.5f*xi, 0.5f - 0.5f*zi));
+        }
+    }
+
+    if ( inner_radius > 0.0f )
+    {
+        for (int i = 0; i < segments; ++i)
+        {
+            const GLuint outer0 = first + 2*i;
+            const GLuint outer1 = first + 2*((i + 1) % segments);
+            ProceduralMesh_AddQuad(data, outer0 + 1, outer0, outer1, outer1 + 1);
+        }
+    }
+    else
+    {
+        const GLuint center = ProceduralMesh_AddVertex(data, glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+        for (int i = 0; i < segments; ++i)
+            ProceduralMesh_AddTriangle(data, center, first + i, first + (i + 1) % segments);
+    }
+}
+
+static void ProceduralMesh_BuildBox(ObjMeshData& data, int divisions)
+{
+    // Eixos (u, v) de cada face, com cross(u,v) apontando para fora.
+    static const float axes[6][2][3] = {
+        { { 0, 0,-1}, {0, 1, 0} }, // +X
+        { { 0, 0, 1}, {0, 1, 0} }, // -X
+        { { 1, 0, 0}, {0, 0,-1} }, // +Y
+        { { 1, 0, 0}, {0, 0, 1} }, // -Y
+        { { 1, 0, 0}, {0, 1, 0} }, // +Z
+        { {-1, 0, 0}, {0, 1, 0} }, // -Z
+    };
+
+    for (int face = 0; face < 6; ++face)
+    {
+        const glm::vec3 u(axes[face][0][0], axes[face][0][1], axes[face][0][2]);
+        const glm::vec3 v(axes[face][1][0], axes[face][1][1], axes[face][1][2]);
+        const glm::vec3 normal = glm::cross(u, v);
+        ProceduralMesh_AddGrid(data, normal - u - v, u, v, divisions);
+    }
+}
+
+// Esfera de "segments" meridianos e segments/2 paralelos. Os vértices da
+// costura (theta = 0 e 2*pi) são duplicados, pois suas coordenadas de
+// textura diferem.
+static void ProceduralMesh_BuildUVSphere(ObjMeshData& data, int segments)
+{
+    const int rings = segments / 2;
+    const int row = segments + 1;
+
+    for (int r = 0; r <= rings; ++r)
+    {
+        const float phi = PROCEDURAL_PI * r / rings; // A partir do polo norte
+        for (int i = 0; i <= segments; ++i)
+        {
+            const float theta = 2.0f * PROCEDURAL_PI * i / segments;
+            const glm::vec3 p(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+            ProceduralMesh_AddVertex(data, p, p, glm::vec2((float)i / segments, 1.0f - (float)r / rings));
+        }
+    }
+
+    for (int r = 0; r < rings; ++r)
+    {
+        for (int i = 0; i < segments; ++i)
+        {
+            const GLuint a = r*row + i;
+            const GLuint b = a + 1;
+            const GLuint c = a + row + 1;
+            const GLuint d = a + row;
+            // Nos polos, um dos triângulos do quadrilátero é degenerado.
+            if ( r != 0 )
+                ProceduralMesh_AddTriangle(data, a, b, c);
+            if ( r != rings - 1 )
+                ProceduralMesh_AddTriangle(data, a, c, d);
+        }
+    }
+}
+
+// Icosaedro subdividido "subdivisions" vezes: cada triângulo é dividido em
+// quatro, e os novos vértices (pontos médios das arestas) são projetados na
+// esfera. Os pontos médios são compartilhados pelos dois triângulos de cada
+// aresta.
+//
+// As coordenadas de textura são as mesmas da projeção esférica. Como em
+// ProceduralMesh_BuildUVSphere(), os vértices dos triângulos que cruzam a
+// costura (onde u volta de 1 para 0) são duplicados, com u + 1 (a textura
+// deve se repetir na horizontal, como as imagens da Terra). Os polos também
+// são duplicados, um por triângulo, com o u médio dos outros dois vértices:
+// ali a longitude não é definida.
+static void ProceduralMesh_BuildIcosphere(ObjMeshData& data, int subdivisions)
+{
+    const float t = (1.0f + sqrtf(5.0f)) / 2.0f;
+    std::vector<glm::vec3> positions = {
+        {-1, t, 0}, { 1, t, 0}, {-1,-t, 0}, { 1,-t, 0},
+        { 0,-1, t}, { 0, 1, t}, { 0,-1,-t}, { 0, 1,-t},
+        { t, 0,-1}, { t, 0, 1}, {-t, 0,-1}, {-t, 0, 1},
+    };
+    std::vector<GLuint> triangles = {
+        0,11, 5,   0, 5, 1,   0, 1, 7,   0, 7,10,   0,10,11,
+        1, 5, 9,   5,11, 4,  11,10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,   3, 4, 2,   3, 2, 6,   3, 6, 8,   3, 8, 9,
+        4, 9, 5,   2, 4,11,   6, 2,10,   8, 6, 7,   9, 8, 1,
+    };
+    for (size_t i = 0; i < positions.size(); ++i)
+        positions[i] = glm::normalize(positions[i]);
+
+    for (int level = 0; level < subdivisions; ++level)
+    {
+        std::map<std::pair<GLuint,GLuint>, GLuint> midpoints;
+        std::vector<GLuint> subdivided;
+        subdivided.reserve(4 * triangles.size());
+
+        for (size_t i = 0; i < triangles.size(); i += 3)
+        {
+            GLuint m[3];
+            for (int edge = 0; edge < 3; ++edge)
+            {
+                GLuint a = triangles[i + edge];
+                GLuint b = triangles[i + (edge + 1) % 3];
+                std::pair<GLuint,GLuint> key(std::min(a, b), std::max(a, b));
+
+                std::map<std::pair<GLuint,GLuint>, GLuint>::iterator it = midpoints.find(key);
+                if ( it == midpoints.end() )
+                {
+                    positions.push_back(glm::normalize(positions[a] + positions[b]));
+                    it = midpoints.insert(std::make_pair(key, (GLuint)positions.size() - 1)).first;
+                }
+                m[edge] = it->second;
+            }
+
+            const GLuint v0 = triangles[i], v1 = triangles[i + 1], v2 = triangles[i + 2];
+            const GLuint children[12] = { v0, m[0], m[2],   v1, m[1], m[0],   v2, m[2], m[1],   m[0], m[1], m[2] };
+            subdivided.insert(subdivided.end(), children, children + 12);
+        }
+
+        triangles.swap(subdivided);
+    }
+
+    std::vector<glm::vec2> uvs(positions.size());
+    std::vector<bool> poles(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const glm::vec3& p = positions[i];
+        uvs[i] = glm::vec2(0.5f + atan2f(p.z, p.x) / (2.0f * PROCEDURAL_PI), 0.5f + asinf(std::max(-1.0f, std::min(1.0f, p.y))) / PROCEDURAL_PI);
+        if ( uvs[i].x >= 1.0f ) // Vértices sobre a costura começam em u = 0
+            uvs[i].x -= 1.0f;
+        poles[i] = fabsf(p.x) < 1e-6f && fabsf(p.z) < 1e-6f;
+    }
+
+    std::map<GLuint, GLuint> seam_copies; // Vértice -> cópia com u + 1
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        // Costura: o triângulo cruza a costura se os u dos seus vértices
+        // (fora dos polos) estão a mais de meia volta de distância.
+        float min_u = 1.0f, max_u = 0.0f;
+        for (int k = 0; k < 3; ++k)
+        {
+            if ( !poles[triangles[i + k]] )
+            {
+                min_u = std::min(min_u, uvs[triangles[i + k]].x);
+                max_u = std::max(max_u, uvs[triangles[i + k]].x);
+            }
+        }
+        if ( max_u - min_u > 0.5f )
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const GLuint v = triangles[i + k];
+                if ( poles[v] || uvs[v].x >= 0.5f )
+                    continue;
+
+                std::map<GLuint, GLuint>::iterator it = seam_copies.find(v);
+                if ( it == seam_copies.end() )
+                {
+                    positions.push_back(positions[v]);
+                    uvs.push_back(uvs[v] + glm::vec2(1.0f, 0.0f));
+                    poles.push_back(false);
+                    it = seam_copies.insert(std::make_pair(v, (GLuint)positions.size() - 1)).first;
+                }
+                triangles[i + k] = it->second;
+            }
+        }
+
+        // Polos: uma cópia por triângulo.
+        for (int k = 0; k < 3; ++k)
+        {
+            const GLuint v = triangles[i + k];
+            if ( !poles[v] )
+                continue;
+
+            const float u = 0.5f * (uvs[triangles[i + (k + 1) % 3]].x + uvs[triangles[i + (k + 2) % 3]].x);
+            positions.push_back(positions[v]);
+            uvs.push_back(glm::vec2(u, uvs[v].y));
+            poles.push_back(true);
+            triangles[i + k] = (GLuint)positions.size() - 1;
+        }
+    }
+
+    for (size_t i = 0; i < positions.size(); ++i)
+        ProceduralMesh_AddVertex(data, positions[i], positions[i], uvs[i]);
+    data.indices = triangles;
+}
+
+// Cilindro de raio 1 e altura 2, com as tampas. As tampas possuem seus
+// próprios vértices, pois suas normais diferem das da lateral.
+static void ProceduralMesh_BuildCylinder(ObjMeshData& data, int segments)
+{
+    const GLuint first = (GLuint)(data.model_coefficients.size() / 4);
+    const int row = segments + 1;
+
+    for (int r = 0; r <= 1; ++r)
+    {
+        const float y = (r == 0) ? 1.0f : -1.0f;
+        for (int i = 0; i <= segments; ++i)
+        {
+            const float theta = 2.0f * PROCEDURAL_PI * i / segments;
+            const glm::vec3 normal(cosf(theta), 0.0f, sinf(theta));
+            ProceduralMesh_AddVertex(data, glm::vec3(normal.x, y, normal.z), normal, glm::vec2((float)i / segments, 1.0f - r));
+        }
+    }
+    for (int i = 0; i < segments; ++i)
+    {
+        const GLuint a = first + i;
+        ProceduralMesh_AddQuad(data, a, a + 1, a + row + 1, a + row);
+    }
+
+    ProceduralMesh_AddAnnulus(data, 1.0f, true, 0.0f, segments);
+    ProceduralMesh_AddAnnulus(data, -1.0f, false, 0.0f, segments);
+}
+
+void ProceduralMesh_Build(ProceduralShape shape, int level, ObjMeshData& data)
+{
+    TraceScope trace("ProceduralMesh_Build", ProceduralMesh_Name(shape));
+
+    data.indices.clear();
+    data.model_coefficients.clear();
+    data.normal_coefficients.clear();
+    data.texture_coefficients.clear();
+    data.shapes.clear();
+
+    level = std::max(0, std::min(PROCEDURAL_NUM_LEVELS - 1, level));
+    const int segments = ProceduralMesh_Segments(level);
+    const int divisions = 1 << level;
+
+    switch ( shape )
+    {
+        case PROCEDURAL_DISK:       ProceduralMesh_AddAnnulus(data, 0.0f, true, 0.0f, segments); break;
+        case PROCEDURAL_RING:       ProceduralMesh_AddAnnulus(data, 0.0f, true, 0.5f, segments); break;
+        case PROCEDURAL_BOX:        ProceduralMesh_BuildBox(data, divisions); break;
+        case PROCEDURAL_UV_SPHERE:  ProceduralMesh_BuildUVSphere(data, segments); break;
+        case PROCEDURAL_ICOSPHERE:  ProceduralMesh_BuildIcosphere(data, level); break;
+        case PROCEDURAL_PLANE_GRID: ProceduralMesh_AddGrid(data, glm::vec3(-1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), divisions); break;
+        case PROCEDURAL_CYLINDER:   ProceduralMesh_BuildCylinder(data, segments); break;
+        default: break;
+    }
+
+    const float maxval = std::numeric_limits<float>::max();
+    glm::vec3 bbox_min(maxval, maxval, maxval);
+    glm::vec3 bbox_max(-maxval, -maxval, -maxval);
+    for (size_t i = 0; i < data.model_coefficients.size(); i += 4)
+    {
+        const glm::vec3 p(data.model_coefficients[i], data.model_coefficients[i+1], data.model_coefficients[i+2]);
+        bbox_min = glm::min(bbox_min, p);
+        bbox_max = glm::max(bbox_max, p);
+    }
+
+    ObjShapeRange range;
+    range.first_index = 0;
+    range.num_indices = data.indices.size();
+    range.bbox_min = bbox_min;
+    range.bbox_max = bbox_max;
+    data.shapes.push_back(range);
+}
+
+const ObjMeshData& ProceduralMesh_Get(ProceduralShape shape, int level)
+{
+    std::pair<int,int> key((int)shape, level);
+    std::map<std::pair<int,int>, ObjMeshData>::iterator it = proceduralmesh_cache.find(key);
+    if ( it == proceduralmesh_cache.end() )
+    {
+        it = proceduralmesh_cache.insert(std::make_pair(key, ObjMeshData())).first;
+        ProceduralMesh_Build(shape, level, it->second);
+    }
+    return it->second;
+}
+
+void ProceduralMesh_AppendLevels(ProceduralShape shape, int first_level, int last_level, ObjMeshData& data)
+{
+    for (int level = first_level; level <= last_level; ++level)
+    {
+        const ObjMeshData& mesh = ProceduralMesh_Get(shape, level);
+        const GLuint first_vertex = (GLuint)(data.model_coefficients.size() / 4);
+
+        ObjShapeRange range = mesh.shapes[0];
+        range.first_index = data.indices.size();
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+            data.indices.push_back(first_vertex + mesh.indices[i]);
+
+        data.model_coefficients.insert(data.model_coefficients.end(), mesh.model_coefficients.begin(), mesh.model_coefficients.end());
+        data.normal_coefficients.insert(data.normal_coefficients.end(), mesh.normal_coefficients.begin(), mesh.normal_coefficients.end());
+        data.texture_coefficients.insert(data.texture_coefficients.end(), mesh.texture_coefficients.begin(), mesh.texture_coefficients.end());
+        data.shapes.push_back(range);
+    }
+}
+
+float ProceduralMesh_Error(ProceduralShape shape, int level)
+{
+    const float half_angle = PROCEDURAL_PI / ProceduralMesh_Segments(level);
+
+    switch ( shape )
+    {
+        // Flecha de uma aresta do polígono inscrito no círculo de raio 1.
+        case PROCEDURAL_DISK:
+        case PROCEDURAL_RING:
+        case PROCEDURAL_CYLINDER:
+            return 1.0f - cosf(half_angle);
+
+        // O ponto mais distante da esfera é o centro de um quadrilátero do
+        // equador, que está a meio passo de cada aresta nas duas direções.
+        case PROCEDURAL_UV_SPHERE:
+            return 1.0f - cosf(half_angle) * cosf(half_angle);
+
+        // Centro de um triângulo equilátero de aresta "edge" inscrito na
+        // esfera. A aresta do icosaedro de raio 1 é ~1.0515, e cada
+        // subdivisão a divide por dois; porém a projeção dos pontos médios
+        // na esfera estica os triângulos do centro de cada face original em
+        // até ~25%, então usamos a maior aresta.
+        case PROCEDURAL_ICOSPHERE:
+        {
+            const float stretch = (level == 0) ? 1.0f : 1.25f;
+            const float edge = stretch * 1.0514622f / (float)(1 << level);
+            return 1.0f - sqrtf(1.0f - edge * edge / 3.0f);
+        }
+
+        default:
+            return 0.0f;
+    }
+}
+
+int ProceduralMesh_SelectLevel(ProceduralShape shape, float error_scale, float max_error)
+{
+    for (int level = 0; level < PROCEDURAL_NUM_LEVELS - 1; ++level)
+        if ( ProceduralMesh_Error(shape, level) * error_scale <= max_error )
+            return level;
+    return PROCEDURAL_NUM_LEVELS - 1;
+}
+
+void ProceduralMesh_ClearCache()
+{
+    proceduralmesh_cache.clear();
+}
@@ -0,0 +1,327 @@
+// Profiler de quadros.
+//
+// O tempo de CPU de cada etapa é medido com std::chrono::steady_clock. O
+// tempo de GPU é medido com um par de queries GL_TIMESTAMP (glQueryCounter())
+// no início e no fim da etapa: ao contrário de GL_TIME_ELAPSED, timestamps
+// podem ser aninhados e intercalados livremente.
+//
+// O resultado de uma query só fica disponível quando a GPU termina de
+// executar os comandos anteriores a ela, o que acontece alguns quadros
+// depois. Pedir o resultado antes disso faria a CPU esperar pela GPU. Por
+// isso cada etapa possui dois conjuntos de queries, utilizados em quadros
+// alternados ("double buffering"): os resultados de um quadro são lidos
+// somente quando GL_QUERY_RESULT_AVAILABLE indicar que já estão prontos.
+// Veja https://www.khronos.org/opengl/wiki/Query_Object#Timer_queries
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "profiler.h"
+#include "trace.h"
+
+// Histórico circular das últimas PROFILER_HISTORY medições (milissegundos).
+struct ProfilerHistory
+{
+    float values[PROFILER_HISTORY];
+    int   count;
+    int   next;
+};
+
+struct ProfilerPass
+{
+    std::string     name;
+    const char*     trace_name;     // Nome permanente, para o trace de eventos
+    bool            gpu;
+    double          cpu_begin;      // Instante do início da etapa no quadro atual
+    GLuint          queries[2][2];  // [conjunto][início/fim]
+    bool            issued[2];      // Conjunto aguardando leitura dos resultados
+    unsigned int    issued_frame[2]; // Quadro em que cada conjunto foi utilizado
+    ProfilerHistory cpu_history;
+    ProfilerHistory gpu_history;
+};
+
+static std::vector<ProfilerPass> profiler_passes;
+static ProfilerHistory profiler_frame_history;
+static double          profiler_frame_begin = 0.0;
+static unsigned int    profiler_frame = 0;
+
+// Registro completo dos quadros (Profiler_StartFrameLog()). O registro de
+// índice i corresponde ao quadro profiler_frame_log_first + i.
+static std::vector<ProfilerFrameRecord> profiler_frame_log;
+static bool            profiler_frame_log_enabled = false;
+static unsigned int    profiler_frame_log_first = 0;
+
+// Relógio monotônico de alta resolução, em segundos. É o mesmo relógio de
+// Trace_Now(), de forma que os instantes podem ser passados para Trace_Event().
+static double Profiler_Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void Profiler_AddSample(ProfilerHistory& history, double milliseconds)
+{
+    history.values[history.next] = (float)milliseconds;
+    history.next = (history.next + 1) % PROFILER_HISTORY;
+    history.count = std::min(history.count + 1, PROFILER_HISTORY);
+}
+
+ProfilerStats Profiler_ComputeStats(const float* milliseconds, int count)
+{
+    ProfilerStats stats;
+    stats.p50 = stats.p95 = stats.p99 = stats.average = stats.max = 0.0;
+    stats.num_samples = count;
+
+    if ( count == 0 )
+        return stats;
+
+    std::vector<float> sorted(milliseconds, milliseconds + count);
+    std::sort(sorted.begin(), sorted.end());
+
+    // Percentil pelo método "nearest rank".
+    const int n = count;
+    stats.p50 = sorted[std::max(0, (int)std::ceil(0.50 * n) - 1)];
+    stats.p95 = sorted[std::max(0, (int)std::ceil(0.95 * n) - 1)];
+    stats.p99 = sorted[std::max(0, (int)std::ceil(0.99 * n) - 1)];
+    stats.max = sorted[n - 1];
+
+    for (int i = 0; i < n; ++i)
+        stats.average += sorted[i];
+    stats.average /= n;
+
+    return stats;
+}
+
+// Percentis do histórico (a ordem das medições não importa).
+static ProfilerStats Profiler_ComputeStats(const ProfilerHistory& history)
+{
+    return Profiler_ComputeStats(history.values, history.count);
+}
+
+// Registro do quadro "frame" no registro completo, ou NULL se ele não faz
+// parte do registro.
+static ProfilerFrameRecord* Profiler_FindFrameRecord(unsigned int frame)
+{
+    if ( frame < profiler_frame_log_first )
+        return NULL;
+
+    size_t index = frame - profiler_frame_log_first;
+    return (index < profiler_frame_log.size()) ? &profiler_frame_log[index] : NULL;
+}
+
+// Lê os resultados do conjunto de queries "set" da etapa "pass_id", caso já
+// estejam disponíveis. Nunca bloqueia.
+static void Profiler_CollectQueries(int pass_id, int set)
+{
+    ProfilerPass& pass = profiler_passes[pass_id];
+    if ( !pass.issued[set] )
+        return;
+
+    // As queries são executadas em ordem pela GPU: se a query do fim da
+    // etapa está pronta, a do início também está.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(pass.queries[set][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if ( !available )
+        return;
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(pass.queries[set][0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(pass.queries[set][1], GL_QUERY_RESULT, &end);
+    Profiler_AddSample(pass.gpu_history, (end - begin) / 1.0e6);
+
+    ProfilerFrameRecord* record = Profiler_FindFrameRecord(pass.issued_frame[set]);
+    if ( record != NULL )
+        record->gpu_ms[pass_id] = (float)((end - begin) / 1.0e6);
+
+    pass.issued[set] = false;
+}
+
+int Profiler_RegisterPass(const char* name, bool gpu)
+{
+    if ( profiler_passes.size() == PROFILER_MAX_PASSES )
+    {
+        fprintf(stderr, "ERROR: Too many profiler passes (\"%s\").\n", name);
+        return -1;
+    }
+
+    ProfilerPass pass;
+    pass.name = name;
+    pass.trace_name = Trace_Intern(name);
+    pass.gpu = gpu;
+    pass.cpu_begin = 0.0;
+    pass.issued[0] = pass.issued[1] = false;
+    pass.issued_frame[0] = pass.issued_frame[1] = 0;
+    pass.cpu_history.count = pass.cpu_history.next = 0;
+    pass.gpu_history.count = pass.gpu_history.next = 0;
+
+    if ( gpu )
+        glGenQueries(4, &pass.queries[0][0]);
+
+    profiler_passes.push_back(pass);
+    return (int)profiler_passes.size() - 1;
+}
+
+void Profiler_BeginFrame()
+{
+    profiler_frame_begin = Profiler_Now();
+
+    if ( profiler_frame_log_enabled )
+    {
+        ProfilerFrameRecord record;
+        record.frame_ms = 0.0f;
+        for (int i = 0; i < PROFILER_MAX_PASSES; ++i)
+        {
+            record.cpu_ms[i] = 0.0f;
+            record.gpu_ms[i] = -1.0f;
+        }
+        profiler_frame_log.push_back(record);
+    }
+}
+
+void Profiler_EndFrame()
+{
+    double now = Profiler_Now();
+    Profiler_AddSample(profiler_frame_history, (now - profiler_frame_begin) * 1000.0);
+
+    ProfilerFrameRecord* record = Profiler_FindFrameRecord(profiler_frame);
+    if ( record != NULL && profiler_frame_log_enabled )
+        record->frame_ms = (float)((now - profiler_frame_begin) * 1000.0);
+
+    // Os quadros e etapas também aparecem no trace de eventos, caso
+    // habilitado. Veja "trace.cpp".
+    Trace_Event("Frame", NULL, profiler_frame_begin, now);
+
+    // Tentamos ler os resultados do quadro anterior. Os do quadro atual
+    // ficam para o próximo quadro.
+    int previous_set = (profiler_frame + 1) % 2;
+    for (size_t i = 0; i < profiler_passes.size(); ++i)
+        if ( profiler_passes[i].gpu )
+            Profiler_CollectQueries((int)i, previous_set);
+
+    profiler_frame += 1;
+}
+
+void Profiler_BeginPass(int pass_id)
+{
+    if ( pass_id < 0 )
+        return;
+
+    ProfilerPass& pass = profiler_passes[pass_id];
+    pass.cpu_begin = Profiler_Now();
+
+    if ( pass.gpu )
+    {
+        // Antes de reutilizar o conjunto de queries deste quadro, tentamos
+        // uma última vez ler os resultados de dois quadros atrás. Se ainda
+        // não estiverem prontos (a GPU está mais de um quadro atrasada),
+        // esta medição é descartada.
+        int set = profiler_frame % 2;
+        Profiler_CollectQueries(pass_id, set);
+        pass.issued[set] = false;
+        pass.issued_frame[set] = profiler_frame;
+
+        glQueryCounter(pass.queries[set][0], GL_TIMESTAMP);
+    }
+}
+
+void Profiler_EndPass(int pass_id)
+{
+    if ( pass_id < 0 )
+        return;
+
+    ProfilerPass& pass = profiler_passes[pass_id];
+    double now = Profiler_Now();
+    Profiler_AddSample(pass.cpu_history, (now - pass.cpu_begin) * 1000.0);
+    Trace_Event(pass.trace_name, NULL, pass.cpu_begin, now);
+
+    ProfilerFrameRecord* record = Profiler_FindFrameRecord(profiler_frame);
+    if ( record != NULL && profiler_frame_log_enabled )
+        record->cpu_ms[pass_id] += (float)((now - pass.cpu_begin) * 1000.0);
+
+    if ( pass.gpu )
+    {
+        int set = profiler_frame % 2;
+        glQueryCounter(pass.queries[set][1], GL_TIMESTAMP);
+        pass.issued[set] = true;
+    }
+}
+
+int Profiler_GetNumPasses()
+{
+    return (int)profiler_passes.size();
+}
+
+const char* Profiler_GetPassName(int pass)
+{
+    return profiler_passes[pass].name.c_str();
+}
+
+bool Profiler_PassHasGpuTime(int pass)
+{
+    return profiler_passes[pass].gpu;
+}
+
+ProfilerStats Profiler_GetCpuStats(int pass)
+{
+    return Profiler_ComputeStats(profiler_passes[pass].cpu_history);
+}
+
+ProfilerStats Profiler_GetGpuStats(int pass)
+{
+    return Profiler_ComputeStats(profiler_passes[pass].gpu_history);
+}
+
+ProfilerStats Profiler_GetFrameStats()
+{
+    return Profiler_ComputeStats(profiler_frame_history);
+}
+
+int Profiler_GetFrameHistory(float* milliseconds, int max_count)
+{
+    const ProfilerHistory& history = profiler_frame_history;
+    int count = std::min(history.count, max_count);
+
+    // O valor mais antigo dos "count" mais recentes.
+    int first = (history.next - count + PROFILER_HISTORY) % PROFILER_HISTORY;
+    for (int i = 0; i < count; ++i)
+        milliseconds[i] = history.values[(first + i) % PROFILER_HISTORY];
+
+    return count;
+}
+
+void Profiler_StartFrameLog()
+{
+    profiler_frame_log.clear();
+    profiler_frame_log_first = profiler_frame;
+    profiler_frame_log_enabled = true;
+}
+
+void Profiler_StopFrameLog()
+{
+    profiler_frame_log_enabled = false;
+
+    // Após glFinish() os resultados de todas as queries estão disponíveis.
+    glFinish();
+    for (size_t i = 0; i < profiler_passes.size(); ++i)
+    {
+        if ( profiler_passes[i].gpu )
+        {
+            Profiler_CollectQueries((int)i, 0);
+            Profiler_CollectQueries((int)i, 1);
+        }
+    }
+}
+
+int Profiler_GetFrameLogSize()
+{
+    return (int)profiler_frame_log.size();
+}
+
+const ProfilerFrameRecord& Profiler_GetFrameLogRecord(int frame)
+{
+    return profiler_frame_log[frame];
+}
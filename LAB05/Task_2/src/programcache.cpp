@@ -0,0 +1,259 @@
+// Cache em disco de programas de GPU ("program binaries").
+//
+// Compilar e linkar os shaders GLSL é uma parte considerável do tempo de
+// inicialização, e cresce com o número de variantes de programas (veja
+// GetGpuProgram() em "main.cpp"). Após linkar um programa, pedimos ao driver
+// o binário resultante com glGetProgramBinary() e o guardamos em um arquivo.
+// Nas próximas execuções, se o código-fonte dos shaders (incluindo os
+// #defines) e o driver forem os mesmos, o programa é criado diretamente com
+// glProgramBinary(), sem compilação.
+//
+// Program binaries fazem parte de OpenGL 4.1 ou da extensão
+// GL_ARB_get_program_binary. Como a biblioteca GLAD deste projeto carrega
+// somente OpenGL 3.3, buscamos as funções manualmente com glfwGetProcAddress().
+// Veja https://www.khronos.org/opengl/wiki/Shader_Compilation#Binary_upload
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "utils.h"
+#include "programcache.h"
+#include "gpuresources.h"
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP ProgramCache_GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramCache_ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramCache_ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+static ProgramCache_GetProgramBinaryProc   programcache_glGetProgramBinary = NULL;
+static ProgramCache_ProgramBinaryProc      programcache_glProgramBinary = NULL;
+static ProgramCache_ProgramParameteriProc  programcache_glProgramParameteri = NULL;
+
+// Diretório dos arquivos do cache, e identificação do driver (GL_VENDOR,
+// GL_RENDERER e GL_VERSION): binários gerados por outro driver, ou outra
+// versão do mesmo driver, não podem ser reaproveitados.
+static std::string programcache_directory;
+static std::string programcache_driver;
+static bool        programcache_enabled = false;
+
+// Cabeçalho de cada arquivo do cache. O hash completo é repetido dentro do
+// arquivo para detectarmos arquivos inválidos ou truncados.
+static const char programcache_magic[8] = { 'F', 'C', 'G', 'P', 'B', 'I', 'N', '1' };
+
+struct ProgramCacheHeader
+{
+    char     magic[8];
+    uint64_t key;
+    uint32_t binary_format;
+    uint32_t binary_length;
+};
+
+// Função de hash FNV-1a de 64 bits.
+static uint64_t ProgramCache_Hash(uint64_t hash, const std::string& data)
+{
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    // Incluímos um separador, para que ("ab","c") e ("a","bc") não colidam.
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+static uint64_t ProgramCache_Key(const std::string& vertex_source, const std::string& fragment_source)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = ProgramCache_Hash(hash, programcache_driver);
+    hash = ProgramCache_Hash(hash, vertex_source);
+    hash = ProgramCache_Hash(hash, fragment_source);
+    return hash;
+}
+
+static std::string ProgramCache_Filename(uint64_t key)
+{
+    char buffer[32];
+    snprintf(buffer, 32, "%016llx.bin", (unsigned long long)key);
+    return programcache_directory + "/" + buffer;
+}
+
+void ProgramCache_Init(const char* directory)
+{
+    programcache_enabled = false;
+
+    if ( GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1) || glHasExtension("GL_ARB_get_program_binary") )
+    {
+        programcache_glGetProgramBinary  = (ProgramCache_GetProgramBinaryProc) glfwGetProcAddress("glGetProgramBinary");
+        programcache_glProgramBinary     = (ProgramCache_ProgramBinaryProc) glfwGetProcAddress("glProgramBinary");
+        programcache_glProgramParameteri = (ProgramCache_ProgramParameteriProc) glfwGetProcAddress("glProgramParameteri");
+    }
+
+    if ( programcache_glGetProgramBinary == NULL || programcache_glProgramBinary == NULL || programcache_glProgramParameteri == NULL )
+    {
+        printf("Cache de programas de GPU desabilitado: driver sem suporte a program binaries.\n");
+        return;
+    }
+
+    // Alguns drivers suportam a extensão, mas nenhum formato de binário.
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    if ( num_formats <= 0 )
+    {
+        printf("Cache de programas de GPU desabilitado: driver sem formatos de program binary.\n");
+        return;
+    }
+
+    programcache_directory = directory;
+    programcache_driver  = (const char*)glGetString(GL_VENDOR);
+    programcache_driver += "|";
+    programcache_driver += (const char*)glGetString(GL_RENDERER);
+    programcache_driver += "|";
+    programcache_driver += (const char*)glGetString(GL_VERSION);
+
+    // Criamos o diretório do cache (caso ainda não exista).
+    #ifdef _WIN32
+    _mkdir(directory);
+    #else
+    mkdir(directory, 0755);
+    #endif
+
+    programcache_enabled = true;
+}
+
+bool ProgramCache_IsEnabled()
+{
+    return programcache_enabled;
+}
+
+GLuint ProgramCache_Load(const std::string& vertex_source, const std::string& fragment_source)
+{
+    if ( !programcache_enabled )
+        return 0;
+
+    uint64_t key = ProgramCache_Key(vertex_source, fragment_source);
+    std::string filename = ProgramCache_Filename(key);
+
+    FILE* file = fopen(filename.c_str(), "rb");
+    if ( file == NULL )
+        return 0;
+
+    ProgramCacheHeader header;
+    std::vector<char> binary;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1
+              && memcmp(header.magic, programcache_magic, sizeof(programcache_magic)) == 0
+              && header.key == key
+              && header.binary_length > 0;
+    if ( valid )
+    {
+        binary.resize(header.binary_length);
+        valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if ( !valid )
+    {
+        fprintf(stderr, "WARNING: Invalid program cache file \"%s\".\n", filename.c_str());
+        std::remove(filename.c_str());
+        return 0;
+    }
+
+    // Limpamos erros anteriores, para não confundí-los com uma rejeição do
+    // binário pelo driver.
+    while ( glGetError() != GL_NO_ERROR ) {}
+
+    GLuint program_id = GpuResources_Create(GPU_PROGRAM, "ProgramCache binary");
+    programcache_glProgramBinary(program_id, header.binary_format, binary.data(), (GLsizei)binary.size());
+
+    // O driver pode rejeitar o binário (ex.: após uma atualização que não
+    // alterou GL_VERSION). Neste caso, o programa deve ser compilado a partir
+    // do código-fonte, e o arquivo é descartado.
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if ( glGetError() != GL_NO_ERROR || linked_ok == GL_FALSE )
+    {
+        GpuResources_Release(GPU_PROGRAM, program_id);
+        std::remove(filename.c_str());
+        return 0;
+    }
+
+    return program_id;
+}
+
+void ProgramCache_PrepareForLink(GLuint program_id)
+{
+    if ( programcache_enabled )
+        programcache_glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache_Store(GLuint program_id, const std::string& vertex_source, const std::string& fragment_source)
+{
+    if ( !programcache_enabled )
+        return;
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if ( linked_ok == GL_FALSE )
+        return;
+
+    GLint binary_length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if ( binary_length <= 0 )
+        return;
+
+    std::vector<char> binary(binary_length);
+    GLenum binary_format = 0;
+    GLsizei length = 0;
+    programcache_glGetProgramBinary(program_id, binary_length, &length, &binary_format, binary.data());
+    if ( length <= 0 )
+        return;
+
+    ProgramCacheHeader header;
+    memcpy(header.magic, programcache_magic, sizeof(programcache_magic));
+    header.key = ProgramCache_Key(vertex_source, fragment_source);
+    header.binary_format = binary_format;
+    header.binary_length = (uint32_t)length;
+
+    // Escrevemos em um arquivo temporário e depois o renomeamos, de forma que
+    // uma execução interrompida nunca deixe um arquivo pela metade no cache.
+    std::string filename = ProgramCache_Filename(header.key);
+    std::string temporary = filename + ".tmp";
+
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "WARNING: Cannot write program cache file \"%s\".\n", temporary.c_str());
+        return;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(binary.data(), 1, length, file) == (size_t)length;
+    written = (fclose(file) == 0) && written;
+
+    std::remove(filename.c_str());
+    if ( !written || std::rename(temporary.c_str(), filename.c_str()) != 0 )
+    {
+        fprintf(stderr, "WARNING: Cannot write program cache file \"%s\".\n", filename.c_str());
+        std::remove(temporary.c_str());
+    }
+}
@@ -18,20 +18,48 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
-// Identificador que define qual objeto está sendo desenhado no momento
-#define SPHERE 0
-#define BUNNY  1
-#define PLANE  2
-uniform int object_id;
+// Posição da câmera em coordenadas globais, computada no código C++ uma única
+// vez por quadro.
+uniform vec4 camera_position_world;
 
 // Parâmetros da axis-aligned bounding box (AABB) do modelo
 uniform vec4 bbox_min;
 uniform vec4 bbox_max;
 
+// Parâmetros do material do objeto sendo desenhado. As funcionalidades do
+// material (MATERIAL_DIFFUSE_MAP, MATERIAL_SPHERICAL_UV, ...) são definidas
+// por #defines inseridos pelo código C++ ao compilar cada variante deste
+// shader. Veja GetGpuProgram() em "main.cpp".
+uniform vec3 material_Ka;
+uniform vec3 material_Kd;
+uniform vec3 material_Ks;
+uniform float material_q;
+
 // Variáveis para acesso das imagens de textura
-uniform sampler2D TextureImage0;
-uniform sampler2D TextureImage1;
-uniform sampler2D TextureImage2;
+#ifdef MATERIAL_DIFFUSE_MAP
+uniform sampler2D DiffuseTexture;
+#endif
+#ifdef MATERIAL_NIGHT_MAP
+uniform sampler2D NightTexture;
+#endif
+
+// Fonte de luz do tipo "spotlight" (veja tecla L em "main.cpp"): posição,
+// direção do cone e cosseno da sua abertura, em coordenadas globais.
+#ifdef MATERIAL_SPOTLIGHT
+uniform vec4  spotlight_position;
+uniform vec4  spotlight_direction;
+uniform float spotlight_cos_angle;
+#endif
+
+// Fontes de luz pontuais adicionais, utilizadas pela cena de estresse (veja
+// "stressscene.cpp"). MAX_POINT_LIGHTS é definido pelo programa junto com
+// MATERIAL_POINT_LIGHTS, igual a STRESS_MAX_LIGHTS (veja BuildShaderDefines()
+// em "main.cpp").
+#ifdef MATERIAL_POINT_LIGHTS
+uniform int  num_point_lights;
+uniform vec4 point_light_position[MAX_POINT_LIGHTS];
+uniform vec3 point_light_color[MAX_POINT_LIGHTS];
+#endif
 
 // O valor de saída ("out") de um Fragment Shader é a cor final do fragmento.
 out vec4 color;
@@ -40,12 +68,23 @@ out vec4 color;
 #define M_PI   3.14159265358979323846
 #define M_PI_2 1.57079632679489661923
 
+#ifdef DEPTH_ONLY
+// Variante da passada de profundidade (veja DrawDepthPrePass() em
+// "main.cpp"): somente a profundidade é escrita.
+void main()
+{
+}
+#else
 void main()
 {
+#ifdef LEGACY_PER_VERTEX_MATRICES
     // Obtemos a posição da câmera utilizando a inversa da matriz que define o
     // sistema de coordenadas da câmera.
     vec4 origin = vec4(0.0, 0.0, 0.0, 1.0);
     vec4 camera_position = inverse(view) * origin;
+#else
+    vec4 camera_position = camera_position_world;
+#endif
 
     // O fragmento atual é coberto por um ponto que percente à superfície de um
     // dos objetos virtuais da cena. Este ponto, p, possui uma posição no
@@ -58,65 +97,86 @@ void main()
     // normais de cada vértice.
     vec4 n = normalize(normal);
 
+#ifdef MATERIAL_SPOTLIGHT
+    // Vetor que define o sentido da fonte de luz em relação ao ponto atual.
+    vec4 l = normalize(spotlight_position - p);
+
+    // Pontos fora do cone do spotlight recebem somente luz ambiente.
+    float light_intensity = (dot(-l, normalize(spotlight_direction)) >= spotlight_cos_angle) ? 1.0 : 0.0;
+#else
     // Vetor que define o sentido da fonte de luz em relação ao ponto atual.
     vec4 l = normalize(vec4(1.0,1.0,0.0,0.0));
+    float light_intensity = 1.0;
+#endif
 
     // Vetor que define o sentido da câmera em relação ao ponto atual.
     vec4 v = normalize(camera_position - p);
 
     // Coordenadas de textura U e V
-    float U = 0.0;
-    float V = 0.0;
+#if defined(MATERIAL_SPHERICAL_UV)
+    // Projeção esférica
+    vec4 bbox_center = (bbox_min + bbox_max) / 2.0;
+
+    // Vetor projeção do ponto do objeto na esfera
+    vec4 position_model_proj = normalize(position_model - bbox_center);
+
+    // Conversão de coordenadas cartesianas para esféricas
+    float theta = atan(position_model_proj.x, position_model_proj.z);
+    float phi = asin(position_model_proj.y);
+
+    float U = (theta + M_PI) / (2.0 * M_PI);
+    float V = (phi + M_PI_2) / M_PI;
+#elif defined(MATERIAL_PLANAR_UV)
+    // Projeção planar pelo plano XY
+    float minx = bbox_min.x;
+    float maxx = bbox_max.x;
+
+    float miny = bbox_min.y;
+    float maxy = bbox_max.y;
+
+    float U = (position_model.x - minx) / (maxx - minx);
+    float V = (position_model.y - miny) / (maxy - miny);
+#else
+    // Coordenadas de textura obtidas do arquivo OBJ.
+    float U = texcoords.x;
+    float V = texcoords.y;
+#endif
+
+    // Obtemos a refletância difusa (para a parte diurna) a partir do material
+    // e, se existir, da leitura da imagem DiffuseTexture
+    vec3 Kd0 = material_Kd;
+#ifdef MATERIAL_DIFFUSE_MAP
+    Kd0 *= texture(DiffuseTexture, vec2(U,V)).rgb;
+#endif
 
-    if ( object_id == SPHERE )
-    {
-        // Projeção esférica
-        vec4 bbox_center = (bbox_min + bbox_max) / 2.0;
-
-        // Vetor projeção do ponto do objeto na esfera
-        vec4 position_model_proj = normalize(position_model - bbox_center);
-
-        // Conversão de coordenadas cartesianas para esféricas
-        float theta = atan(position_model_proj.x, position_model_proj.z);
-        float phi = asin(position_model_proj.y);
-
-        U = (theta + M_PI) / (2.0 * M_PI);
-        V = (phi + M_PI_2) / M_PI;
-    }
-    else if ( object_id == BUNNY )
-    {
-        // Projeção planar pelo plano XY
-        float minx = bbox_min.x;
-        float maxx = bbox_max.x;
-
-        float miny = bbox_min.y;
-        float maxy = bbox_max.y;
-
-        float minz = bbox_min.z;
-        float maxz = bbox_max.z;
+    // Equação de Iluminação
+    float lambert = max(0,dot(n,l)) * light_intensity;
+    color.rgb = material_Ka + Kd0 * (lambert + 0.01);
 
-        U = (position_model.x - minx) / (maxx - minx);
-        V = (position_model.y - miny) / (maxy - miny);
-    }
-    else if ( object_id == PLANE )
+#ifdef MATERIAL_POINT_LIGHTS
+    // Termo difuso de cada fonte de luz pontual, com atenuação pelo
+    // quadrado da distância.
+    for (int i = 0; i < num_point_lights; ++i)
     {
-        // Coordenadas de textura do plano, obtidas do arquivo OBJ.
-        U = texcoords.x;
-        V = texcoords.y;
+        vec4 to_light = point_light_position[i] - p;
+        float distance2 = dot(to_light, to_light);
+        float point_lambert = max(0, dot(n, to_light * inversesqrt(distance2)));
+        color.rgb += Kd0 * point_light_color[i] * point_lambert / (1.0 + distance2);
     }
+#endif
 
-    // Obtemos a refletância difusa para a parte diurna a partir da leitura da imagem TextureImage0
-    vec3 Kd0 = texture(TextureImage0, vec2(U,V)).rgb;
-
-    // Obtemos a refletância difusa para a parte noturna a partir da leitura da imagem TextureImage1
-    vec3 Kd1 = texture(TextureImage1, vec2(U,V)).rgb;
-
-    // Equação de Iluminação
-    float lambert = max(0,dot(n,l));
+#ifdef MATERIAL_NIGHT_MAP
+    // Obtemos a refletância difusa para a parte noturna a partir da leitura da imagem NightTexture
+    vec3 Kd1 = texture(NightTexture, vec2(U,V)).rgb;
     float alpha = 15.0;
-    color.rgb = Kd0 * (lambert + 0.01);
-    if ( object_id == SPHERE)
-        color.rgb += Kd1 * pow(1.0 - lambert, alpha);
+    color.rgb += Kd1 * pow(1.0 - lambert, alpha);
+#endif
+
+#ifdef MATERIAL_PHONG
+    // Termo especular utilizando o modelo de iluminação de Phong
+    vec4 r = -l + 2*n*dot(n,l);
+    color.rgb += material_Ks * light_intensity * pow(max(0, dot(r,v)), material_q);
+#endif
 
     // NOTE: Se você quiser fazer o rendering de objetos transparentes, é
     // necessário:
@@ -135,4 +195,5 @@ void main()
     // Cor final com correção gamma, considerando monitor sRGB.
     // Veja https://en.wikipedia.org/w/index.php?title=Gamma_correction&oldid=751281772#Windows.2C_Mac.2C_sRGB_and_TV.2Fvideo_standard_gammas
     color.rgb = pow(color.rgb, vec3(1.0,1.0,1.0)/2.2);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
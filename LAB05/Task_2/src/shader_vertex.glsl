@@ -11,6 +11,12 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Matrizes pré-computadas no código C++ uma única vez por objeto (veja a
+// função SetModelMatrix() em "main.cpp"), evitando que os produtos e a
+// inversão abaixo sejam refeitos para cada vértice.
+uniform mat4 model_view_projection; // projection * view * model
+uniform mat4 normal_matrix;         // inverse(transpose(model))
+
 // Atributos de vértice que serão gerados como saída ("out") pelo Vertex Shader.
 // ** Estes serão interpolados pelo rasterizador! ** gerando, assim, valores
 // para cada fragmento, os quais serão recebidos como entrada pelo Fragment
@@ -20,6 +26,11 @@ out vec4 position_model;
 out vec4 normal;
 out vec2 texcoords;
 
+// A posição é calculada da mesma forma na variante DEPTH_ONLY (passada de
+// profundidade, veja DrawDepthPrePass() em "main.cpp") e nas demais, e deve
+// resultar exatamente na mesma profundidade para o teste GL_EQUAL.
+invariant gl_Position;
+
 void main()
 {
     // A variável gl_Position define a posição final de cada vértice
@@ -34,7 +45,13 @@ void main()
     // deste Vertex Shader, a placa de vídeo (GPU) fará a divisão por W. Veja
     // slides 41-67 e 69-86 do documento Aula_09_Projecoes.pdf.
 
+#ifdef LEGACY_PER_VERTEX_MATRICES
+    // Caminho antigo, mantido somente para comparação no modo de benchmark
+    // (tecla V em "main.cpp"): as matrizes são compostas em cada vértice.
     gl_Position = projection * view * model * model_coefficients;
+#else
+    gl_Position = model_view_projection * model_coefficients;
+#endif
 
     // Como as variáveis acima  (tipo vec4) são vetores com 4 coeficientes,
     // também é possível acessar e modificar cada coeficiente de maneira
@@ -47,6 +64,7 @@ void main()
     //     gl_Position.w = model_coefficients.w;
     //
 
+#ifndef DEPTH_ONLY
     // Agora definimos outros atributos dos vértices que serão interpolados pelo
     // rasterizador para gerar atributos únicos para cada fragmento gerado.
 
@@ -58,10 +76,15 @@ void main()
 
     // Normal do vértice atual no sistema de coordenadas global (World).
     // Veja slides 123-151 do documento Aula_07_Transformacoes_Geometricas_3D.pdf.
+#ifdef LEGACY_PER_VERTEX_MATRICES
     normal = inverse(transpose(model)) * normal_coefficients;
+#else
+    normal = normal_matrix * normal_coefficients;
+#endif
     normal.w = 0.0;
 
     // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
     texcoords = texture_coefficients;
+#endif
 }
 
@@ -0,0 +1,271 @@
+// Reflexão de programas de GPU e cópia dos valores "uniform" na CPU.
+//
+// Cada variável ativa ocupa size * value_size bytes em ShaderProgram::values.
+// Uma escrita com glUniform*v() sempre começa no elemento 0, então basta
+// guardar quantos elementos iniciais ("known_count") têm valor conhecido:
+// uma nova escrita de até known_count elementos iguais aos guardados não é
+// repassada ao driver. Nenhum valor começa conhecido, de forma que a
+// primeira escrita de cada variável sempre chega ao driver.
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "shaderprogram.h"
+
+static ShaderUniformStats shaderprogram_frame = { 0, 0 };      // Quadro atual
+static ShaderUniformStats shaderprogram_last_frame = { 0, 0 }; // Último quadro completo
+
+static bool ShaderProgram_IsSampler(GLenum type)
+{
+    switch ( type )
+    {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE: case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bytes de um elemento de uma variável do tipo "type", como escrito por
+// glUniform*().
+static size_t ShaderProgram_ElementSize(GLenum type)
+{
+    switch ( type )
+    {
+        case GL_FLOAT:             return 1 * sizeof(GLfloat);
+        case GL_FLOAT_VEC2:        return 2 * sizeof(GLfloat);
+        case GL_FLOAT_VEC3:        return 3 * sizeof(GLfloat);
+        case GL_FLOAT_VEC4:        return 4 * sizeof(GLfloat);
+        case GL_FLOAT_MAT2:        return 4 * sizeof(GLfloat);
+        case GL_FLOAT_MAT3:        return 9 * sizeof(GLfloat);
+        case GL_FLOAT_MAT4:        return 16 * sizeof(GLfloat);
+        case GL_INT:               return 1 * sizeof(GLint);
+        case GL_INT_VEC2:          return 2 * sizeof(GLint);
+        case GL_INT_VEC3:          return 3 * sizeof(GLint);
+        case GL_INT_VEC4:          return 4 * sizeof(GLint);
+        case GL_UNSIGNED_INT:      return 1 * sizeof(GLuint);
+        case GL_UNSIGNED_INT_VEC2: return 2 * sizeof(GLuint);
+        case GL_UNSIGNED_INT_VEC3: return 3 * sizeof(GLuint);
+        case GL_UNSIGNED_INT_VEC4: return 4 * sizeof(GLuint);
+        case GL_BOOL:              return 1 * sizeof(GLint);
+        case GL_BOOL_VEC2:         return 2 * sizeof(GLint);
+        case GL_BOOL_VEC3:         return 3 * sizeof(GLint);
+        case GL_BOOL_VEC4:         return 4 * sizeof(GLint);
+        default:
+            // Samplers e tipos não listados acima (ex.: matrizes não
+            // quadradas) são escritos como um único inteiro ou não são
+            // utilizados aqui.
+            return ShaderProgram_IsSampler(type) ? sizeof(GLint) : 0;
+    }
+}
+
+// Testa se uma variável do tipo "type" pode ser escrita pela função
+// glUniform*() correspondente a "written" (GL_INT para glUniform1i()).
+static bool ShaderProgram_Compatible(GLenum type, GLenum written)
+{
+    if ( type == written )
+        return true;
+    return written == GL_INT && (type == GL_BOOL || ShaderProgram_IsSampler(type));
+}
+
+void ShaderProgram_Reflect(ShaderProgram& program, GLuint program_id, const char* label)
+{
+    program.program_id = program_id;
+    program.label = label;
+    program.uniforms.clear();
+    program.attributes.clear();
+    program.values.clear();
+
+    GLint num_uniforms = 0;
+    GLint max_length = 0;
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORMS, &num_uniforms);
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::vector<GLchar> name(std::max(max_length, 1));
+    size_t values_size = 0;
+    for (GLint i = 0; i < num_uniforms; ++i)
+    {
+        GLsizei length = 0;
+        ShaderUniform uniform;
+        glGetActiveUniform(program_id, (GLuint)i, (GLsizei)name.size(), &length, &uniform.size, &uniform.type, name.data());
+        uniform.name.assign(name.data(), length);
+
+        // Variáveis dentro de blocos "uniform" não possuem localização, e
+        // são escritas através do buffer do bloco.
+        uniform.location = glGetUniformLocation(program_id, uniform.name.c_str());
+        if ( uniform.location == -1 )
+            continue;
+
+        // Arrays são listados como "nome[0]".
+        const size_t suffix = uniform.name.rfind("[0]");
+        if ( suffix != std::string::npos && suffix + 3 == uniform.name.size() )
+            uniform.name.erase(suffix);
+
+        uniform.value_offset = values_size;
+        uniform.value_size = ShaderProgram_ElementSize(uniform.type);
+        uniform.known_count = 0;
+        uniform.required = true;
+        uniform.warned = false;
+        values_size += uniform.size * uniform.value_size;
+        program.uniforms.push_back(uniform);
+    }
+    program.values.resize(values_size);
+
+    GLint num_attributes = 0;
+    glGetProgramiv(program_id, GL_ACTIVE_ATTRIBUTES, &num_attributes);
+    glGetProgramiv(program_id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+
+    name.resize(std::max(max_length, 1));
+    for (GLint i = 0; i < num_attributes; ++i)
+    {
+        GLsizei length = 0;
+        ShaderAttribute attribute;
+        glGetActiveAttrib(program_id, (GLuint)i, (GLsizei)name.size(), &length, &attribute.size, &attribute.type, name.data());
+        attribute.name.assign(name.data(), length);
+
+        // Atributos pré-definidos (ex.: gl_VertexID) não possuem localização.
+        attribute.location = glGetAttribLocation(program_id, attribute.name.c_str());
+        if ( attribute.location != -1 )
+            program.attributes.push_back(attribute);
+    }
+}
+
+int ShaderProgram_Uniform(ShaderProgram& program, const char* name, bool required)
+{
+    for (size_t i = 0; i < program.uniforms.size(); ++i)
+    {
+        ShaderUniform& uniform = program.uniforms[i];
+        if ( uniform.name == name )
+        {
+            if ( uniform.location == -1 )
+                uniform.required = uniform.required || required;
+            return (int)i;
+        }
+    }
+
+    // Variável inativa: guardamos uma entrada sem localização, para que o
+    // aviso possa citar o nome.
+    ShaderUniform uniform;
+    uniform.name = name;
+    uniform.location = -1;
+    uniform.type = GL_NONE;
+    uniform.size = 0;
+    uniform.value_offset = 0;
+    uniform.value_size = 0;
+    uniform.known_count = 0;
+    uniform.required = required;
+    uniform.warned = false;
+    program.uniforms.push_back(uniform);
+    return (int)program.uniforms.size() - 1;
+}
+
+GLint ShaderProgram_AttributeLocation(const ShaderProgram& program, const char* name)
+{
+    for (size_t i = 0; i < program.attributes.size(); ++i)
+        if ( program.attributes[i].name == name )
+            return program.attributes[i].location;
+    return -1;
+}
+
+// Compara "count" elementos de "value" com a cópia da variável "handle",
+// atualizando a cópia. Retorna a localização da variável se a escrita deve
+// ser repassada ao driver, ou -1 caso contrário. "count" é limitado ao
+// tamanho da variável.
+static GLint ShaderProgram_Change(ShaderProgram& program, int handle, GLenum type, GLsizei& count, const void* value)
+{
+    if ( handle < 0 || (size_t)handle >= program.uniforms.size() )
+        return -1;
+
+    ShaderUniform& uniform = program.uniforms[handle];
+    if ( uniform.location == -1 )
+    {
+        if ( uniform.required && !uniform.warned )
+        {
+            fprintf(stderr, "WARNING: Uniform \"%s\" is not active in program \"%s\" (unused by the shader and optimized out?); writes to it are ignored.\n",
+                uniform.name.c_str(), program.label.c_str());
+            uniform.warned = true;
+        }
+        return -1;
+    }
+
+    if ( !ShaderProgram_Compatible(uniform.type, type) )
+    {
+        if ( !uniform.warned )
+        {
+            fprintf(stderr, "WARNING: Uniform \"%s\" in program \"%s\" has type 0x%04x but was written as 0x%04x; writes to it are ignored.\n",
+                uniform.name.c_str(), program.label.c_str(), uniform.type, type);
+            uniform.warned = true;
+        }
+        return -1;
+    }
+
+    count = std::min(count, (GLsizei)uniform.size);
+    const size_t bytes = count * uniform.value_size;
+    unsigned char* shadow = &program.values[uniform.value_offset];
+    if ( (size_t)count <= uniform.known_count && memcmp(shadow, value, bytes) == 0 )
+    {
+        shaderprogram_frame.filtered += 1;
+        return -1;
+    }
+
+    memcpy(shadow, value, bytes);
+    uniform.known_count = std::max(uniform.known_count, (size_t)count);
+    shaderprogram_frame.issued += 1;
+    return uniform.location;
+}
+
+void ShaderProgram_Set1i(ShaderProgram& program, int uniform, GLint value)
+{
+    GLsizei count = 1;
+    const GLint location = ShaderProgram_Change(program, uniform, GL_INT, count, &value);
+    if ( location != -1 )
+        glUniform1i(location, value);
+}
+
+void ShaderProgram_Set1f(ShaderProgram& program, int uniform, GLfloat value)
+{
+    GLsizei count = 1;
+    const GLint location = ShaderProgram_Change(program, uniform, GL_FLOAT, count, &value);
+    if ( location != -1 )
+        glUniform1f(location, value);
+}
+
+void ShaderProgram_Set3fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value)
+{
+    const GLint location = ShaderProgram_Change(program, uniform, GL_FLOAT_VEC3, count, value);
+    if ( location != -1 )
+        glUniform3fv(location, count, value);
+}
+
+void ShaderProgram_Set4fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value)
+{
+    const GLint location = ShaderProgram_Change(program, uniform, GL_FLOAT_VEC4, count, value);
+    if ( location != -1 )
+        glUniform4fv(location, count, value);
+}
+
+void ShaderProgram_SetMatrix4fv(ShaderProgram& program, int uniform, GLsizei count, const GLfloat* value)
+{
+    const GLint location = ShaderProgram_Change(program, uniform, GL_FLOAT_MAT4, count, value);
+    if ( location != -1 )
+        glUniformMatrix4fv(location, count, GL_FALSE, value);
+}
+
+void ShaderProgram_EndFrame()
+{
+    shaderprogram_last_frame = shaderprogram_frame;
+    shaderprogram_frame.issued = 0;
+    shaderprogram_frame.filtered = 0;
+}
+
+ShaderUniformStats ShaderProgram_GetFrameStats()
+{
+    return shaderprogram_last_frame;
+}
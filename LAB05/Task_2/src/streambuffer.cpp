@@ -0,0 +1,250 @@
+// Alocador de geometria dinâmica em um buffer circular (anel).
+//
+// As alocações avançam "head" pelo anel; uma alocação que não cabe até o
+// fim do buffer recomeça do início (o final do buffer fica sem uso nesta
+// volta). No modo STREAM_BUFFER_MAP, cada quadro termina com um fence
+// cobrindo a região do anel utilizada pelo quadro. Antes de reescrever uma
+// região, esperamos os fences dos quadros que a utilizaram: com um anel
+// grande o bastante para alguns quadros, estes já foram sinalizados e não há
+// espera. As esperas que acontecem são contadas em StreamBufferStats, e
+// indicam que o anel é pequeno demais.
+//
+// Se um único quadro precisar de mais que o anel inteiro, não existe fence
+// a esperar (os comandos do quadro ainda nem foram enviados): neste caso o
+// buffer é "órfão", e as alocações anteriores do quadro continuam válidas
+// na memória antiga, que o driver libera quando a GPU terminar de lê-la.
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "streambuffer.h"
+#include "trace.h"
+#include "glstate.h"
+
+void StreamBuffer_Init(StreamBuffer& stream, GLenum target, size_t capacity, StreamBufferMode mode, const char* label)
+{
+    stream.target = target;
+    stream.mode = mode;
+    stream.capacity = capacity;
+    stream.head = 0;
+    stream.frame_begin = 0;
+    stream.frame_size = 0;
+    stream.frame_bytes = 0;
+    stream.frame_allocations = 0;
+    stream.pending_offset = 0;
+    stream.pending_size = 0;
+    memset(&stream.stats, 0, sizeof(stream.stats));
+
+    stream.buffer.Create(label);
+    GlState_BindBuffer(target, stream.buffer.id);
+    glBufferData(target, capacity, NULL, GL_STREAM_DRAW);
+    stream.buffer.SetSize(capacity);
+}
+
+static void StreamBuffer_DeleteFences(StreamBuffer& stream)
+{
+    for (size_t i = 0; i < stream.fences.size(); ++i)
+        glDeleteSync(stream.fences[i].fence);
+    stream.fences.clear();
+}
+
+// Troca a memória do buffer por uma nova, de "capacity" bytes. Os comandos
+// já enviados continuam lendo a memória antiga, então nenhuma região
+// precisa mais ser protegida.
+static void StreamBuffer_Orphan(StreamBuffer& stream, size_t capacity)
+{
+    GlState_BindBuffer(stream.target, stream.buffer.id);
+    glBufferData(stream.target, capacity, NULL, GL_STREAM_DRAW);
+    stream.buffer.SetSize(capacity);
+
+    StreamBuffer_DeleteFences(stream);
+    stream.capacity = capacity;
+    stream.head = 0;
+    stream.frame_begin = 0;
+    stream.frame_size = 0;
+    stream.stats.orphans += 1;
+}
+
+// Testa se a região de "size" bytes a partir de "begin", que pode dar a
+// volta no anel, intercepta [offset, offset+size).
+static bool StreamBuffer_Overlaps(const StreamBuffer& stream, size_t begin, size_t region_size, size_t offset, size_t size)
+{
+    if ( region_size == 0 )
+        return false;
+    if ( region_size >= stream.capacity )
+        return true;
+
+    const size_t end = begin + region_size;
+    if ( end <= stream.capacity )
+        return offset < end && begin < offset + size;
+    return offset < end - stream.capacity || offset + size > begin;
+}
+
+// Espera a GPU terminar os comandos do fence mais antigo, e o descarta.
+static void StreamBuffer_WaitOldest(StreamBuffer& stream)
+{
+    const StreamBufferFence& oldest = stream.fences.front();
+
+    GLenum result = glClientWaitSync(oldest.fence, 0, 0);
+    if ( result == GL_TIMEOUT_EXPIRED )
+    {
+        TraceScope trace("StreamBuffer_Stall");
+        const double begin = Trace_Now();
+        do
+        {
+            result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 segundo
+        } while ( result == GL_TIMEOUT_EXPIRED );
+
+        stream.stats.stalls += 1;
+        stream.stats.stall_seconds += Trace_Now() - begin;
+    }
+    if ( result == GL_WAIT_FAILED )
+        fprintf(stderr, "WARNING: glClientWaitSync() failed in StreamBuffer.\n");
+
+    glDeleteSync(oldest.fence);
+    stream.fences.pop_front();
+}
+
+void* StreamBuffer_Allocate(StreamBuffer& stream, size_t size, size_t alignment, size_t& offset)
+{
+    StreamBuffer_Commit(stream);
+
+    if ( size > stream.capacity )
+    {
+        size_t capacity = stream.capacity;
+        while ( capacity < 2 * size )
+            capacity *= 2;
+        fprintf(stderr, "WARNING: Stream buffer allocation of %lu bytes does not fit in %lu bytes; growing to %lu bytes.\n",
+            (unsigned long)size, (unsigned long)stream.capacity, (unsigned long)capacity);
+        StreamBuffer_Orphan(stream, capacity);
+    }
+
+    offset = (stream.head + alignment - 1) / alignment * alignment;
+    bool wrapped = false;
+    if ( offset + size > stream.capacity )
+    {
+        offset = 0;
+        wrapped = true;
+    }
+
+    // Bytes do anel que o quadro atual passa a ocupar.
+    size_t advance = wrapped ? (stream.capacity - stream.head) + size : (offset + size - stream.head);
+
+    if ( stream.frame_size + advance > stream.capacity || (stream.mode == STREAM_BUFFER_ORPHAN && wrapped) )
+    {
+        // O quadro atual encheu o anel (ou, sem fences, o anel deu a volta):
+        // recomeçamos em uma memória nova.
+        StreamBuffer_Orphan(stream, stream.capacity);
+        offset = 0;
+        advance = size;
+    }
+    else
+    {
+        // Ao dar a volta, o fence mais antigo pode cobrir só o fim do anel,
+        // que foi pulado, enquanto um mais novo cobre o início: procuramos o
+        // fence mais novo que sobrepõe a região. Como os fences terminam em
+        // ordem, esperamos por ele e por todos os anteriores.
+        size_t num_overlapping = 0;
+        for (size_t i = 0; i < stream.fences.size(); ++i)
+            if ( StreamBuffer_Overlaps(stream, stream.fences[i].begin, stream.fences[i].size, offset, size) )
+                num_overlapping = i + 1;
+
+        for (size_t i = 0; i < num_overlapping; ++i)
+            StreamBuffer_WaitOldest(stream);
+    }
+
+    stream.head = offset + size;
+    stream.frame_size += advance;
+    stream.frame_bytes += size;
+    stream.frame_allocations += 1;
+    stream.pending_offset = offset;
+    stream.pending_size = size;
+
+    if ( stream.mode == STREAM_BUFFER_MAP )
+    {
+        // A região não é lida por nenhum comando pendente, então não é
+        // necessário que o driver sincronize com a GPU.
+        GlState_BindBuffer(stream.target, stream.buffer.id);
+        void* pointer = glMapBufferRange(stream.target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if ( pointer != NULL )
+            return pointer;
+
+        // Sem mapeamento, utilizamos o modo de buffers órfãos daqui em diante.
+        fprintf(stderr, "WARNING: glMapBufferRange() failed; stream buffer falling back to orphaning.\n");
+        stream.mode = STREAM_BUFFER_ORPHAN;
+        StreamBuffer_DeleteFences(stream);
+    }
+
+    if ( stream.staging.size() < size )
+        stream.staging.resize(size);
+    return stream.staging.data();
+}
+
+void StreamBuffer_Commit(StreamBuffer& stream)
+{
+    if ( stream.pending_size == 0 )
+        return;
+
+    GlState_BindBuffer(stream.target, stream.buffer.id);
+    if ( stream.mode == STREAM_BUFFER_MAP )
+    {
+        if ( glUnmapBuffer(stream.target) == GL_FALSE )
+            fprintf(stderr, "WARNING: Stream buffer contents were lost while mapped.\n");
+    }
+    else
+    {
+        glBufferSubData(stream.target, stream.pending_offset, stream.pending_size, stream.staging.data());
+    }
+
+    stream.pending_size = 0;
+}
+
+void StreamBuffer_EndFrame(StreamBuffer& stream)
+{
+    StreamBuffer_Commit(stream);
+
+    if ( stream.mode == STREAM_BUFFER_MAP && stream.frame_size > 0 )
+    {
+        StreamBufferFence fence;
+        fence.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        fence.begin = stream.frame_begin;
+        fence.size = stream.frame_size;
+        stream.fences.push_back(fence);
+    }
+
+    // Descartamos os fences já sinalizados, sem esperar.
+    while ( !stream.fences.empty() && glClientWaitSync(stream.fences.front().fence, 0, 0) != GL_TIMEOUT_EXPIRED )
+    {
+        glDeleteSync(stream.fences.front().fence);
+        stream.fences.pop_front();
+    }
+
+    stream.stats.frame_bytes = stream.frame_bytes;
+    stream.stats.frame_allocations = stream.frame_allocations;
+    stream.frame_begin = stream.head;
+    stream.frame_size = 0;
+    stream.frame_bytes = 0;
+    stream.frame_allocations = 0;
+}
+
+void StreamBuffer_Destroy(StreamBuffer& stream)
+{
+    if ( stream.pending_size > 0 && stream.mode == STREAM_BUFFER_MAP )
+    {
+        GlState_BindBuffer(stream.target, stream.buffer.id);
+        glUnmapBuffer(stream.target);
+    }
+    stream.pending_size = 0;
+
+    StreamBuffer_DeleteFences(stream);
+    stream.buffer.Reset();
+    stream.staging.clear();
+}
+
+void StreamBuffer_PrintStats(const StreamBuffer& stream, const char* name)
+{
+    printf("Stream buffer \"%s\" (%s, %lu KB): %lu bytes em %lu alocações no último quadro, %lu esperas pela GPU (%.2f ms), %lu buffers órfãos.\n",
+        name, (stream.mode == STREAM_BUFFER_MAP) ? "map" : "orphan", (unsigned long)(stream.capacity / 1024),
+        (unsigned long)stream.stats.frame_bytes, (unsigned long)stream.stats.frame_allocations,
+        (unsigned long)stream.stats.stalls, stream.stats.stall_seconds * 1000.0, (unsigned long)stream.stats.orphans);
+}
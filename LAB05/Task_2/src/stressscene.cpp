@@ -0,0 +1,179 @@
+// Gerador de cenas de estresse.
+//
+// A cena padrão possui somente três objetos, o que não diz nada sobre como o
+// renderizador se comporta com cenas maiores. Aqui geramos de 1 a milhões de
+// instâncias dos modelos, e variamos independentemente os fatores que mais
+// influenciam o custo de cada quadro: o número de comandos de desenho (tempo
+// de CPU), o número de trocas de VAO (malhas distintas) e de material
+// (texturas distintas), a sobreposição em tela (distribuição espacial) e o
+// custo de cada fragmento (fontes de luz).
+//
+// As posições vêm de um std::mt19937, cuja sequência é definida pelo padrão
+// C++, convertida para float manualmente (as distribuições da biblioteca
+// padrão variam entre implementações): a mesma semente gera a mesma cena em
+// qualquer plataforma.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+#include <glm/common.hpp>
+
+#include "stressscene.h"
+
+StressSceneParams StressScene_DefaultParams()
+{
+    StressSceneParams params;
+    params.num_instances = 0;
+    params.layout = STRESS_LAYOUT_GRID;
+    params.num_meshes = 3;
+    params.num_textures = 2;
+    params.num_lights = 0;
+    params.seed = 1;
+    params.extent = 2.0f;
+    return params;
+}
+
+// Lê o valor inteiro de uma opção "--nome=valor", encerrando o programa se
+// ele for inválido ou menor que "min_value".
+static int StressScene_ParseInt(const char* arg, const char* value, int min_value)
+{
+    char* end = NULL;
+    long result = strtol(value, &end, 10);
+    if ( end == value || *end != '\0' || result < min_value )
+    {
+        fprintf(stderr, "ERROR: Invalid value in \"%s\".\n", arg);
+        std::exit(EXIT_FAILURE);
+    }
+    return (int)result;
+}
+
+bool StressScene_ParseOption(const char* arg, StressSceneParams& params)
+{
+    if ( strncmp(arg, "--stress=", 9) == 0 )
+        params.num_instances = StressScene_ParseInt(arg, arg + 9, 1);
+    else if ( strncmp(arg, "--stress-meshes=", 16) == 0 )
+        params.num_meshes = StressScene_ParseInt(arg, arg + 16, 1);
+    else if ( strncmp(arg, "--stress-textures=", 18) == 0 )
+        params.num_textures = StressScene_ParseInt(arg, arg + 18, 0);
+    else if ( strncmp(arg, "--stress-lights=", 16) == 0 )
+    {
+        params.num_lights = StressScene_ParseInt(arg, arg + 16, 0);
+        if ( params.num_lights > STRESS_MAX_LIGHTS )
+        {
+            fprintf(stderr, "WARNING: Only %d stress scene lights are supported (asked for %d).\n", STRESS_MAX_LIGHTS, params.num_lights);
+            params.num_lights = STRESS_MAX_LIGHTS;
+        }
+    }
+    else if ( strncmp(arg, "--stress-seed=", 14) == 0 )
+        params.seed = (unsigned int)StressScene_ParseInt(arg, arg + 14, 0);
+    else if ( strcmp(arg, "--stress-layout=grid") == 0 )
+        params.layout = STRESS_LAYOUT_GRID;
+    else if ( strcmp(arg, "--stress-layout=random") == 0 )
+        params.layout = STRESS_LAYOUT_RANDOM;
+    else if ( strcmp(arg, "--stress-layout=clusters") == 0 )
+        params.layout = STRESS_LAYOUT_CLUSTERS;
+    else if ( strncmp(arg, "--stress-layout=", 16) == 0 )
+    {
+        fprintf(stderr, "ERROR: Unknown layout in \"%s\" (use grid, random or clusters).\n", arg);
+        std::exit(EXIT_FAILURE);
+    }
+    else
+        return false;
+
+    return true;
+}
+
+// Número aleatório uniforme em [0, 1).
+static float StressScene_Random(std::mt19937& rng)
+{
+    return (float)(rng() / 4294967296.0);
+}
+
+// Número aleatório com distribuição normal padrão (transformação de
+// Box-Muller).
+static float StressScene_RandomNormal(std::mt19937& rng)
+{
+    float u1 = std::max(StressScene_Random(rng), 1e-7f);
+    float u2 = StressScene_Random(rng);
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * 3.14159265f * u2);
+}
+
+void StressScene_Generate(const StressSceneParams& params, std::vector<StressInstance>& instances, std::vector<StressLight>& lights)
+{
+    std::mt19937 rng(params.seed);
+
+    const int   n = params.num_instances;
+    const float extent = params.extent;
+
+    // Espaçamento médio entre instâncias, de forma que todas caibam no cubo
+    // da cena sem importar quantas sejam.
+    const int   side = std::max(1, (int)ceil(cbrt((double)n)));
+    const float spacing = 2.0f * extent / side;
+
+    // Centros dos aglomerados: aproximadamente um aglomerado para cada
+    // "side" instâncias.
+    std::vector<glm::vec3> clusters;
+    float cluster_radius = 0.0f;
+    if ( params.layout == STRESS_LAYOUT_CLUSTERS )
+    {
+        int num_clusters = std::max(1, n / side);
+        cluster_radius = 0.5f * extent / cbrtf((float)num_clusters);
+        for (int i = 0; i < num_clusters; ++i)
+        {
+            clusters.push_back(glm::vec3(
+                (2.0f * StressScene_Random(rng) - 1.0f) * (extent - cluster_radius),
+                (2.0f * StressScene_Random(rng) - 1.0f) * (extent - cluster_radius),
+                (2.0f * StressScene_Random(rng) - 1.0f) * (extent - cluster_radius)));
+        }
+    }
+
+    instances.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        StressInstance& instance = instances[i];
+
+        switch ( params.layout )
+        {
+        case STRESS_LAYOUT_GRID:
+            instance.position = glm::vec3(
+                -extent + spacing * (i % side + 0.5f),
+                -extent + spacing * ((i / side) % side + 0.5f),
+                -extent + spacing * (i / (side * side) + 0.5f));
+            break;
+        case STRESS_LAYOUT_RANDOM:
+            instance.position = glm::vec3(
+                (2.0f * StressScene_Random(rng) - 1.0f) * extent,
+                (2.0f * StressScene_Random(rng) - 1.0f) * extent,
+                (2.0f * StressScene_Random(rng) - 1.0f) * extent);
+            break;
+        case STRESS_LAYOUT_CLUSTERS:
+        {
+            const glm::vec3& center = clusters[rng() % clusters.size()];
+            glm::vec3 offset(StressScene_RandomNormal(rng), StressScene_RandomNormal(rng), StressScene_RandomNormal(rng));
+            instance.position = glm::clamp(center + offset * cluster_radius, glm::vec3(-extent), glm::vec3(extent));
+            break;
+        }
+        }
+
+        instance.mesh = (int)(rng() % (unsigned int)params.num_meshes);
+        instance.texture = (params.num_textures > 0) ? (int)(rng() % (unsigned int)params.num_textures) : 0;
+        instance.size = spacing * (0.6f + 0.3f * StressScene_Random(rng));
+        instance.rotation_y = 2.0f * 3.14159265f * StressScene_Random(rng);
+    }
+
+    // Fontes de luz igualmente espaçadas em um anel em volta da cena, com
+    // cores percorrendo o círculo de matizes. A intensidade total é dividida
+    // entre as fontes, para que a imagem não sature com muitas delas.
+    lights.resize(std::min(params.num_lights, STRESS_MAX_LIGHTS));
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        float angle = 2.0f * 3.14159265f * i / lights.size();
+        lights[i].position = glm::vec4(1.2f * extent * cosf(angle), 0.5f * extent, 1.2f * extent * sinf(angle), 1.0f);
+
+        glm::vec3 hue(cosf(angle), cosf(angle - 2.0944f), cosf(angle + 2.0944f));
+        lights[i].color = (0.5f + 0.5f * hue) * (4.0f / lights.size());
+    }
+}
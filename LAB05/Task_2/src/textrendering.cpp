@@ -1,6 +1,9 @@
 // Based on http://hamelot.io/visualization/opengl-text-without-any-external-libraries/
 //   and on https://github.com/rougier/freetype-gl
 #include <string>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,6 +13,11 @@
 
 #include "utils.h"
 #include "dejavufont.h"
+#include "programcache.h"
+#include "trace.h"
+#include "streambuffer.h"
+#include "glstate.h"
+#include "gpuresources.h"
 
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
 
@@ -35,6 +43,27 @@ const GLchar* const textfragmentshader_source = ""
 "}\n"
 "\0";
 
+// Shaders utilizados para desenhar os gráficos de linha do HUD (veja
+// TextRendering_PrintGraph()), com coordenadas já em NDC e cor constante.
+const GLchar* const graphvertexshader_source = ""
+"#version 330\n"
+"layout (location = 0) in vec2 position;\n"
+"void main()\n"
+"{\n"
+    "gl_Position = vec4(position, 0, 1);\n"
+"}\n"
+"\0";
+
+const GLchar* const graphfragmentshader_source = ""
+"#version 330\n"
+"uniform vec4 color;\n"
+"out vec4 fragColor;\n"
+"void main()\n"
+"{\n"
+    "fragColor = color;\n"
+"}\n"
+"\0";
+
 void TextRendering_LoadShader(const GLchar* const shader_string, GLuint shader_id)
 {
     // Define o código do shader, contido na string "shader_string"
@@ -82,76 +111,155 @@ void TextRendering_LoadShader(const GLchar* const shader_string, GLuint shader_i
     delete [] log;
 }
 
-GLuint textVAO;
-GLuint textVBO;
-GLuint textprogram_id;
-GLuint texttexture_id;
-
-void TextRendering_Init()
+// Objetos OpenGL do texto e dos gráficos. São liberados por
+// TextRendering_Shutdown(), antes de GpuResources_Shutdown().
+GpuVertexArray textVAO;
+GLuint         textprogram_id;
+GpuTexture     texttexture;
+GpuSampler     textsampler;
+
+GpuVertexArray graphVAO;
+GLuint         graphprogram_id;
+GLint          graphcolor_uniform;
+
+// Os vértices do texto e dos gráficos são reescritos a cada quadro, em
+// sub-alocações de um único buffer circular (veja "streambuffer.h"), ao
+// qual os dois VAOs apontam. 256 KB comportam os vértices de vários
+// quadros, de forma que a GPU já terminou de ler uma região quando o anel
+// volta a ela.
+#define TEXT_STREAM_BUFFER_SIZE (256 * 1024)
+StreamBuffer textstream;
+
+void TextRendering_Init(StreamBufferMode stream_mode)
 {
-    GLuint sampler;
-
-    glGenBuffers(1, &textVBO);
-    glGenVertexArrays(1, &textVAO);
-    glGenTextures(1, &texttexture_id);
-    glGenSamplers(1, &sampler);
-    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    TraceScope trace("TextRendering_Init");
+
+    StreamBuffer_Init(textstream, GL_ARRAY_BUFFER, TEXT_STREAM_BUFFER_SIZE, stream_mode, "TextRendering stream");
+    textVAO.Create("TextRendering text VAO");
+    texttexture.Create("TextRendering font texture");
+    textsampler.Create("TextRendering font sampler");
+    glSamplerParameteri(textsampler.id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(textsampler.id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(textsampler.id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(textsampler.id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glCheckError();
 
-    GLuint textvertexshader_id = glCreateShader(GL_VERTEX_SHADER);
-    TextRendering_LoadShader(textvertexshader_source, textvertexshader_id);
-    glCheckError();
+    // Buscamos o programa de renderização de texto no cache em disco de
+    // programas de GPU (veja "programcache.cpp"), e somente o compilamos caso
+    // ele não esteja lá.
+    textprogram_id = ProgramCache_Load(textvertexshader_source, textfragmentshader_source);
+    if ( textprogram_id == 0 )
+    {
+        GLuint textvertexshader_id = glCreateShader(GL_VERTEX_SHADER);
+        TextRendering_LoadShader(textvertexshader_source, textvertexshader_id);
+        glCheckError();
 
-    GLuint textfragmentshader_id = glCreateShader(GL_FRAGMENT_SHADER);
-    TextRendering_LoadShader(textfragmentshader_source, textfragmentshader_id);
-    glCheckError();
+        GLuint textfragmentshader_id = glCreateShader(GL_FRAGMENT_SHADER);
+        TextRendering_LoadShader(textfragmentshader_source, textfragmentshader_id);
+        glCheckError();
 
-    textprogram_id = CreateGpuProgram(textvertexshader_id, textfragmentshader_id);
-    glLinkProgram(textprogram_id);
-    glCheckError();
+        textprogram_id = CreateGpuProgram(textvertexshader_id, textfragmentshader_id);
+        glLinkProgram(textprogram_id);
+        glCheckError();
+
+        ProgramCache_Store(textprogram_id, textvertexshader_source, textfragmentshader_source);
+    }
 
     GLuint texttex_uniform;
     texttex_uniform = glGetUniformLocation(textprogram_id, "tex");
     glCheckError();
 
     GLuint textureunit = 31;
-    glActiveTexture(GL_TEXTURE0 + textureunit);
-    glBindTexture(GL_TEXTURE_2D, texttexture_id);
+    GlState_BindTexture(textureunit, GL_TEXTURE_2D, texttexture.id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, dejavufont.tex_width, dejavufont.tex_height, 0, GL_RED, GL_UNSIGNED_BYTE, dejavufont.tex_data);
-    glBindSampler(textureunit, sampler);
+    texttexture.SetSize((size_t)dejavufont.tex_width * dejavufont.tex_height);
+    GlState_BindSampler(textureunit, textsampler.id);
     glCheckError();
 
-    glBindVertexArray(textVAO);
+    GlState_BindVertexArray(textVAO.id);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    GlState_BindBuffer(GL_ARRAY_BUFFER, textstream.buffer.id);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(0);
     glCheckError();
 
-    glUseProgram(textprogram_id);
+    GlState_UseProgram(textprogram_id);
     glUniform1i(texttex_uniform, textureunit);
-    glUseProgram(0);
     glCheckError();
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Programa, VAO e VBO dos gráficos de linha.
+    graphprogram_id = ProgramCache_Load(graphvertexshader_source, graphfragmentshader_source);
+    if ( graphprogram_id == 0 )
+    {
+        GLuint graphvertexshader_id = glCreateShader(GL_VERTEX_SHADER);
+        TextRendering_LoadShader(graphvertexshader_source, graphvertexshader_id);
+
+        GLuint graphfragmentshader_id = glCreateShader(GL_FRAGMENT_SHADER);
+        TextRendering_LoadShader(graphfragmentshader_source, graphfragmentshader_id);
+
+        graphprogram_id = CreateGpuProgram(graphvertexshader_id, graphfragmentshader_id);
+        glCheckError();
+
+        ProgramCache_Store(graphprogram_id, graphvertexshader_source, graphfragmentshader_source);
+    }
+    graphcolor_uniform = glGetUniformLocation(graphprogram_id, "color");
+
+    graphVAO.Create("TextRendering graph VAO");
+    GlState_BindVertexArray(graphVAO.id);
+    GlState_BindBuffer(GL_ARRAY_BUFFER, textstream.buffer.id);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
     glCheckError();
 }
 
+void TextRendering_EndFrame()
+{
+    StreamBuffer_EndFrame(textstream);
+}
+
+const StreamBufferStats& TextRendering_GetStreamStats()
+{
+    return textstream.stats;
+}
+
+void TextRendering_Shutdown()
+{
+    StreamBuffer_PrintStats(textstream, "TextRendering");
+    StreamBuffer_Destroy(textstream);
+
+    // Os programas vêm de CreateGpuProgram() ou de ProgramCache_Load(), que
+    // os criam através do registro de objetos OpenGL.
+    GpuResources_Release(GPU_PROGRAM, textprogram_id);
+    GpuResources_Release(GPU_PROGRAM, graphprogram_id);
+    textprogram_id = 0;
+    graphprogram_id = 0;
+
+    textVAO.Reset();
+    graphVAO.Reset();
+    textsampler.Reset();
+    texttexture.Reset();
+}
+
 float textscale = 1.5f;
 
 void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f)
 {
+    if ( str.empty() )
+        return;
+
     scale *= textscale;
     int width, height;
     glfwGetWindowSize(window, &width, &height);
     float sx = scale / width;
     float sy = scale / height;
 
+    // Os dois triângulos de cada caractere são escritos diretamente no
+    // buffer circular, e a string inteira é desenhada com uma única chamada.
+    struct TextVertex {float x, y, s, t;};
+    size_t offset;
+    TextVertex* data = (TextVertex*)StreamBuffer_Allocate(textstream, 6 * str.size() * sizeof(TextVertex), sizeof(TextVertex), offset);
+    GLsizei num_vertices = 0;
+
     for (size_t i = 0; i < str.size(); i++)
     {
         // Find the glyph for the character we are looking for
@@ -178,7 +286,7 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
         float s1 = glyph->s1 - 0.5f/dejavufont.tex_width;
         float t1 = glyph->t1 - 0.5f/dejavufont.tex_height;
 
-        struct {float x, y, s, t;} data[6] = {
+        TextVertex quad[6] = {
             { x0, y0, s0, t0 },
             { x0, y1, s0, t1 },
             { x1, y1, s1, t1 },
@@ -186,29 +294,82 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
             { x1, y1, s1, t1 },
             { x1, y0, s1, t0 }
         };
+        memcpy(data + num_vertices, quad, sizeof(quad));
+        num_vertices += 6;
+
+        x += (glyph->advance_x * sx);
+    }
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StreamBuffer_Commit(textstream);
 
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDepthFunc(GL_ALWAYS);
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if ( num_vertices == 0 )
+        return;
 
-        glUseProgram(textprogram_id);
-        glBindVertexArray(textVAO);
+    // O estado não é restaurado ao final: em uma sequência de textos, as
+    // chamadas abaixo só chegam ao driver no primeiro (veja "glstate.h").
+    GlState_SetEnabled(GL_BLEND, true);
+    GlState_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+    GlState_PolygonMode(GL_FILL);
+    GlState_DepthFunc(GL_ALWAYS);
 
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glDepthFunc(GL_LESS);
+    GlState_UseProgram(textprogram_id);
+    GlState_BindVertexArray(textVAO.id);
 
-        glDisable(GL_BLEND);
+    glDrawArrays(GL_TRIANGLES, (GLint)(offset / sizeof(TextVertex)), num_vertices);
+}
 
-        x += (glyph->advance_x * sx);
+// Desenha um gráfico de linha com os "count" valores de "values", dentro do
+// retângulo com canto inferior esquerdo (x, y) e dimensões (width, height),
+// em coordenadas NDC. O valor "max_value" corresponde ao topo do retângulo
+// (valores maiores são cortados). Se "reference_value" for positivo, uma
+// linha horizontal de referência é desenhada nesta altura.
+void TextRendering_PrintGraph(GLFWwindow* window, const float* values, int count, float max_value, float reference_value, float x, float y, float width, float height)
+{
+    if ( count < 2 || max_value <= 0.0f )
+        return;
+
+    // Os vértices são: o contorno do retângulo (4), a linha de referência
+    // (2) e os pontos do gráfico (count).
+    std::vector<float> data;
+    data.reserve(2 * (6 + count));
+
+    float rectangle[] = { x, y,  x + width, y,  x + width, y + height,  x, y + height };
+    data.insert(data.end(), rectangle, rectangle + 8);
+
+    float reference_y = y + height * std::min(reference_value / max_value, 1.0f);
+    data.push_back(x);         data.push_back(reference_y);
+    data.push_back(x + width); data.push_back(reference_y);
+
+    for (int i = 0; i < count; ++i)
+    {
+        data.push_back(x + width * i / (count - 1));
+        data.push_back(y + height * std::min(values[i] / max_value, 1.0f));
+    }
+
+    // Cada vértice ocupa 2 floats; "first" é o índice do primeiro vértice
+    // da alocação dentro do buffer circular.
+    const size_t vertex_size = 2 * sizeof(float);
+    size_t offset;
+    void* vertices = StreamBuffer_Allocate(textstream, data.size() * sizeof(float), vertex_size, offset);
+    memcpy(vertices, data.data(), data.size() * sizeof(float));
+    StreamBuffer_Commit(textstream);
+    const GLint first = (GLint)(offset / vertex_size);
+
+    GlState_SetEnabled(GL_BLEND, false);
+    GlState_DepthFunc(GL_ALWAYS);
+    GlState_UseProgram(graphprogram_id);
+    GlState_BindVertexArray(graphVAO.id);
+
+    glUniform4f(graphcolor_uniform, 0.5f, 0.5f, 0.5f, 1.0f);
+    glDrawArrays(GL_LINE_LOOP, first, 4);
+    if ( reference_value > 0.0f )
+    {
+        glUniform4f(graphcolor_uniform, 0.0f, 0.6f, 0.0f, 1.0f);
+        glDrawArrays(GL_LINES, first + 4, 2);
     }
+    glUniform4f(graphcolor_uniform, 0.8f, 0.0f, 0.0f, 1.0f);
+    glDrawArrays(GL_LINE_STRIP, first + 6, count);
 }
 
 float TextRendering_LineHeight(GLFWwindow* window)
@@ -0,0 +1,258 @@
+// Gravação de eventos no formato de "trace events" do Chrome.
+//
+// Cada thread grava seus eventos em um buffer circular próprio, criado no
+// seu primeiro evento. Assim, registrar um evento não utiliza nenhum lock:
+// a thread escreve o evento na próxima posição do seu buffer e publica o
+// novo total com uma operação atômica. Quando o buffer enche, os eventos
+// mais antigos são sobrescritos; o arquivo sempre contém os
+// TRACE_BUFFER_SIZE eventos mais recentes de cada thread.
+//
+// Para escrever o arquivo, Trace_Write() pausa a gravação: desabilita
+// trace_enabled e espera as threads terminarem o evento que estão gravando
+// (indicado por TraceThreadBuffer::writing), copia os buffers e volta a
+// habilitar a gravação antes de formatar o JSON. Eventos registrados durante
+// a cópia são descartados.
+//
+// Formato do arquivo: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "trace.h"
+
+// Número de eventos guardados por thread (potência de dois).
+#define TRACE_BUFFER_SIZE 32768
+
+struct TraceEvent
+{
+    const char* name;
+    const char* detail;
+    double      begin;
+    double      end;
+};
+
+struct TraceThreadBuffer
+{
+    int                  thread_id;
+    const char*          thread_name;
+    std::atomic<size_t>  count;   // Total de eventos já gravados
+    std::atomic<bool>    writing; // A thread está gravando um evento
+    TraceEvent           events[TRACE_BUFFER_SIZE];
+};
+
+static std::atomic<bool> trace_enabled(false);
+static std::string       trace_filename;
+static double            trace_start = 0.0;
+
+// Lista de buffers de todas as threads e strings permanentes. Protegidas
+// por trace_mutex, que só é utilizado ao criar o buffer de uma thread, em
+// Trace_Intern() e enquanto Trace_Write() copia os buffers.
+static std::mutex                      trace_mutex;
+static std::vector<TraceThreadBuffer*> trace_buffers;
+static std::set<std::string>           trace_strings;
+
+static thread_local TraceThreadBuffer* trace_thread_buffer = NULL;
+static thread_local const char*        trace_thread_name = NULL;
+
+static TraceThreadBuffer* Trace_GetThreadBuffer()
+{
+    if ( trace_thread_buffer == NULL )
+    {
+        // Os buffers nunca são liberados, pois seus eventos devem aparecer
+        // no arquivo mesmo depois que a thread terminar.
+        TraceThreadBuffer* buffer = new TraceThreadBuffer;
+        buffer->thread_name = trace_thread_name;
+        buffer->count = 0;
+        buffer->writing = false;
+
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        buffer->thread_id = (int)trace_buffers.size() + 1;
+        trace_buffers.push_back(buffer);
+        trace_thread_buffer = buffer;
+    }
+    return trace_thread_buffer;
+}
+
+double Trace_Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace_Init(const char* filename)
+{
+    trace_filename = (filename != NULL) ? filename : "";
+    trace_start = Trace_Now();
+    trace_enabled = true;
+}
+
+bool Trace_IsEnabled()
+{
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+void Trace_SetThreadName(const char* name)
+{
+    // O buffer da thread só é criado no seu primeiro evento, para não
+    // alocar memória enquanto a gravação estiver desabilitada.
+    trace_thread_name = name;
+    if ( trace_thread_buffer != NULL )
+        trace_thread_buffer->thread_name = name;
+}
+
+void Trace_Event(const char* name, const char* detail, double begin, double end)
+{
+    if ( !Trace_IsEnabled() )
+        return;
+
+    TraceThreadBuffer* buffer = Trace_GetThreadBuffer();
+
+    // Marcamos o buffer como em uso antes de confirmar que a gravação
+    // continua habilitada: Trace_Write() faz o inverso (desabilita e então
+    // verifica "writing"), de forma que uma das duas threads sempre vê a
+    // operação da outra. Veja o início do arquivo.
+    buffer->writing.store(true);
+    if ( !trace_enabled.load() )
+    {
+        buffer->writing.store(false, std::memory_order_release);
+        return;
+    }
+
+    size_t count = buffer->count.load(std::memory_order_relaxed);
+
+    TraceEvent& event = buffer->events[count & (TRACE_BUFFER_SIZE - 1)];
+    event.name = name;
+    event.detail = detail;
+    event.begin = begin;
+    event.end = end;
+
+    buffer->count.store(count + 1, std::memory_order_release);
+    buffer->writing.store(false, std::memory_order_release);
+}
+
+const char* Trace_Intern(const std::string& str)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    return trace_strings.insert(str).first->c_str();
+}
+
+// Escreve "str" como uma string JSON.
+static void Trace_WriteString(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (const char* c = str; *c != '\0'; ++c)
+    {
+        if ( *c == '"' || *c == '\\' )
+            fprintf(file, "\\%c", *c);
+        else if ( (unsigned char)*c < 0x20 )
+            fprintf(file, "\\u%04x", (unsigned char)*c);
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool Trace_Write(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if ( file == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot write trace file \"%s\".\n", filename);
+        return false;
+    }
+
+    // Cópia dos buffers, feita com a gravação pausada. A formatação do JSON
+    // (a parte lenta) acontece depois que as threads já voltaram a gravar.
+    struct TraceThreadCopy
+    {
+        int                     thread_id;
+        const char*             thread_name;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<TraceThreadCopy> copies;
+
+    // trace_mutex só é mantido durante a cópia: a formatação e a escrita do
+    // arquivo não bloqueiam Trace_Intern() nem a criação do buffer de novas
+    // threads. Os nomes copiados continuam válidos, pois as strings de
+    // Trace_Intern() nunca são liberadas.
+    {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+
+        const bool was_enabled = trace_enabled.exchange(false);
+        for (size_t i = 0; i < trace_buffers.size(); ++i)
+        {
+            const TraceThreadBuffer* buffer = trace_buffers[i];
+            while ( buffer->writing.load() )
+                std::this_thread::yield();
+
+            TraceThreadCopy copy;
+            copy.thread_id = buffer->thread_id;
+            copy.thread_name = buffer->thread_name;
+
+            const size_t count = buffer->count.load(std::memory_order_acquire);
+            const size_t begin = (count > TRACE_BUFFER_SIZE) ? count - TRACE_BUFFER_SIZE : 0;
+            copy.events.reserve(count - begin);
+            for (size_t j = begin; j < count; ++j)
+                copy.events.push_back(buffer->events[j & (TRACE_BUFFER_SIZE - 1)]);
+
+            copies.push_back(copy);
+        }
+        trace_enabled = was_enabled;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    size_t num_events = 0;
+    for (size_t i = 0; i < copies.size(); ++i)
+    {
+        const TraceThreadCopy& copy = copies[i];
+
+        // Evento de metadados com o nome da thread.
+        if ( copy.thread_name != NULL )
+        {
+            fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", copy.thread_id);
+            Trace_WriteString(file, copy.thread_name);
+            fprintf(file, "}}");
+            first = false;
+        }
+
+        for (size_t j = 0; j < copy.events.size(); ++j)
+        {
+            const TraceEvent& event = copy.events[j];
+
+            // Eventos completos ("X"), com instante inicial e duração em
+            // microssegundos.
+            fprintf(file, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                first ? "" : ",\n", copy.thread_id,
+                (event.begin - trace_start) * 1.0e6, (event.end - event.begin) * 1.0e6);
+            Trace_WriteString(file, event.name);
+            if ( event.detail != NULL )
+            {
+                fprintf(file, ",\"args\":{\"detail\":");
+                Trace_WriteString(file, event.detail);
+                fprintf(file, "}");
+            }
+            fprintf(file, "}");
+            first = false;
+            num_events += 1;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Trace com %lu eventos escrito em \"%s\".\n", (unsigned long)num_events, filename);
+    return true;
+}
+
+void Trace_Shutdown()
+{
+    if ( Trace_IsEnabled() && !trace_filename.empty() )
+        Trace_Write(trace_filename.c_str());
+}